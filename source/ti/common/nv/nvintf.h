@@ -216,6 +216,12 @@ typedef uint8_t (*NVINTF_eraseNV)(void);
 //! Function pointer definition for the NVINTF_getFreeNV() function
 typedef uint32_t (*NVINTF_getFreeNV)(void);
 
+//! Function pointer definition for the NVINTF_beginTxn() function
+typedef uint8_t (*NVINTF_beginTxn)(void);
+
+//! Function pointer definition for the NVINTF_commitTxn() function
+typedef uint8_t (*NVINTF_commitTxn)(void);
+
 //! Structure of NV API function pointers
 typedef struct nvintf_nvfuncts_t
 {
@@ -249,6 +255,10 @@ typedef struct nvintf_nvfuncts_t
     NVINTF_eraseNV eraseNV;
     //! Get Free NV function
     NVINTF_getFreeNV getFreeNV;
+    //! Begin write transaction function
+    NVINTF_beginTxn beginTxn;
+    //! Commit write transaction function
+    NVINTF_commitTxn commitTxn;
 } NVINTF_nvFuncts_t;
 
 //*****************************************************************************
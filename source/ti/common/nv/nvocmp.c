@@ -230,6 +230,28 @@ Requires API's in a crc.h to implement CRC functionality.
 // in RAM before write, instead of header/data written separately
 #define NVOCMP_SMALLITEM    12
 
+// Maximum number of items staged by an open write transaction
+#ifndef NVOCMP_TXNMAXITEMS
+#define NVOCMP_TXNMAXITEMS  8
+#endif // NVOCMP_TXNMAXITEMS
+
+// Size in bytes of the staging buffer of a write transaction, items
+// plus headers. Larger items bypass staging and are written directly.
+#ifndef NVOCMP_TXNBUFSIZE
+#define NVOCMP_TXNBUFSIZE   256
+#endif // NVOCMP_TXNBUFSIZE
+
+// Number of entries in the RAM index of item locations (8 bytes each), 0 to
+// disable. The index should have room for all items with some to spare; if
+// it fills up, lookups of items it does not hold fall back to a page scan.
+#ifndef NVOCMP_RAMIDXSIZE
+#define NVOCMP_RAMIDXSIZE   0
+#endif // NVOCMP_RAMIDXSIZE
+
+// RAM index entry markers, valid compressed IDs have bit31 clear
+#define NVOCMP_RIDXEMPTY    0xFFFFFFFF
+#define NVOCMP_RIDXDELETED  0xFFFFFFFE
+
 #if defined (NVOCMP_STATS)
 // NV item ID for driver diagnostics
 static const NVINTF_itemID_t diagId = NVOCMP_NVID_DIAG;
@@ -564,6 +586,20 @@ typedef struct
   uint16_t ofs;
 } NVOCMP_hotId_t;
 
+typedef struct
+{
+  NVOCMP_itemHdr_t hdr;   // Item header, hpage/hofs locate the copy replaced
+  uint16_t bOfs;          // Offset of the item data in NVOCMP_txnBuf
+  bool     superseded;    // Item was staged again with a different length
+} NVOCMP_txnItem_t;
+
+typedef struct
+{
+  uint32_t cid;           // Compressed item ID or NVOCMP_RIDXEMPTY/DELETED
+  uint16_t hofs;          // Offset of the item header
+  uint8_t  pg;            // Page of the item
+} NVOCMP_ridxEntry_t;
+
 //*****************************************************************************
 // Local variables
 //*****************************************************************************
@@ -605,6 +641,24 @@ static GateMutexPri_Handle NVOCMP_gMutexPri;
 // Small NV Item Buffer, for item construction
 static uint8_t NVOCMP_itemBuffer[NVOCMP_SMALLITEM];
 
+// Write transaction state. Staged item data is kept in Flash layout, each
+// item followed by room for its header, so a commit is a single write.
+static uint8_t NVOCMP_txnDepth = 0;
+static uint8_t NVOCMP_txnCount = 0;
+static uint16_t NVOCMP_txnUsed = 0;
+static NVOCMP_txnItem_t NVOCMP_txnItems[NVOCMP_TXNMAXITEMS];
+static uint8_t NVOCMP_txnBuf[NVOCMP_TXNBUFSIZE];
+
+#if NVOCMP_RAMIDXSIZE
+// RAM index of active item header locations, open addressing on the
+// compressed ID. It is rebuilt from Flash when marked stale (after init and
+// compaction). When complete, an ID missing from the index is not in NV.
+static NVOCMP_ridxEntry_t NVOCMP_ridx[NVOCMP_RAMIDXSIZE];
+static bool NVOCMP_ridxStale = true;
+static bool NVOCMP_ridxComplete = false;
+#endif // NVOCMP_RAMIDXSIZE
+static NVOCMP_ramIdxStats_t NVOCMP_ridxStats;
+
 // Function Pointer to an optional user provided voltage check function
 static bool (*NVOCMP_voltCheckFptr)(void);
 // Diagnostic counter for bad CRCs
@@ -645,6 +699,8 @@ static void       NVOCMP_unlockNvApi(int32_t);
 static bool       NVOCMP_expectCompApi(uint16_t len);
 static uint8_t    NVOCMP_eraseNvApi(void);
 static uint32_t   NVOCMP_getFreeNvApi(void);
+static uint8_t    NVOCMP_beginTxnApi(void);
+static uint8_t    NVOCMP_commitTxnApi(void);
 
 //*****************************************************************************
 // NV Local Function Prototypes
@@ -659,6 +715,13 @@ static uint8_t    NVOCMP_addItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t
                                  uint8_t *pBuf, NVOCMP_writeMode_t wm);
 static void       NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
                                    uint8_t dstPg, uint16_t dstOff, uint8_t *pBuf);
+static void       NVOCMP_encodeHeader(NVOCMP_itemHdr_t *pHdr, uint8_t *pBuf, uint8_t *cHdr);
+static bool       NVOCMP_itemUnchanged(NVOCMP_itemHdr_t *iHdr, uint8_t *pBuf);
+static int8_t     NVOCMP_txnFind(uint32_t cmpid);
+static uint8_t    NVOCMP_txnStage(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iHdr,
+                                  uint8_t *pBuf, NVOCMP_writeMode_t wm);
+static uint16_t   NVOCMP_txnPack(void);
+static uint8_t    NVOCMP_txnFlush(NVOCMP_nvHandle_t *pNvHandle);
 static uint8_t    NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg);
 static int16_t    NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes);
 static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle);
@@ -703,6 +766,19 @@ static void       NVOCMP_migratePage(NVOCMP_nvHandle_t *pNvHandle, uint8_t page)
 static NVOCMP_hotId_t* NVOCMP_hotItem(uint32_t cid);
 static void       NVOCMP_hotItemUpdate(uint8_t pg, uint16_t ofs, uint32_t cid);
 
+#if NVOCMP_RAMIDXSIZE
+static NVOCMP_ridxEntry_t* NVOCMP_ridxSlot(uint32_t cid, bool add);
+static void       NVOCMP_ridxUpdate(uint8_t pg, uint16_t ofs, uint32_t cid);
+static void       NVOCMP_ridxBuild(NVOCMP_nvHandle_t *pNvHandle);
+static bool       NVOCMP_ridxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                                  uint32_t cid, int8_t *pStatus);
+#define NVOCMP_RIDXSTALE()  NVOCMP_ridxStale = true;
+#define NVOCMP_RIDXUPDATE(pg, ofs, cid) NVOCMP_ridxUpdate(pg, ofs, cid);
+#else
+#define NVOCMP_RIDXSTALE()
+#define NVOCMP_RIDXUPDATE(pg, ofs, cid)
+#endif // NVOCMP_RAMIDXSIZE
+
 //*****************************************************************************
 // Load Pointer Functions (These are declared in nvoctp.h)
 //*****************************************************************************
@@ -735,6 +811,8 @@ void NVOCMP_loadApiPtrs(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+    pfn->beginTxn     = &NVOCMP_beginTxnApi;
+    pfn->commitTxn    = &NVOCMP_commitTxnApi;
 }
 
 /**
@@ -767,6 +845,8 @@ void NVOCMP_loadApiPtrsMin(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+    pfn->beginTxn     = NULL;
+    pfn->commitTxn    = NULL;
 }
 
 /**
@@ -798,6 +878,8 @@ void NVOCMP_loadApiPtrsExt(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+    pfn->beginTxn     = &NVOCMP_beginTxnApi;
+    pfn->commitTxn    = &NVOCMP_commitTxnApi;
 }
 
 /**
@@ -824,6 +906,28 @@ extern void NVOCMP_setCheckVoltage(void *funcPtr)
 #endif
 }
 
+/**
+ * @fn      NVOCMP_getRamIdxStats
+ *
+ * @brief   Global function to read and optionally clear the RAM index
+ *          counters. All counters stay zero when the index is disabled.
+ *
+ * @param   pStats - pointer to caller's counter structure
+ * @param   clear - true to reset the counters after reading them
+ *
+ * @return  none
+ */
+void NVOCMP_getRamIdxStats(NVOCMP_ramIdxStats_t *pStats, bool clear)
+{
+    *pStats = NVOCMP_ridxStats;
+    if(clear)
+    {
+        uint16_t used = NVOCMP_ridxStats.used;
+        memset(&NVOCMP_ridxStats, 0, sizeof(NVOCMP_ridxStats));
+        NVOCMP_ridxStats.used = used;
+    }
+}
+
 #ifdef NVOCMP_MIN_VDD_FLASH_MV
 /**
  * @fn      NVOCMP_setLowVoltageCb
@@ -982,6 +1086,11 @@ static uint8_t NVOCMP_initNvApi(void *param)
 
         NVOCMP_initNv(&NVOCMP_nvHandle);
 
+#if NVOCMP_RAMIDXSIZE
+        // Index the items found in NV
+        NVOCMP_ridxBuild(&NVOCMP_nvHandle);
+#endif
+
 #if defined (NVOCMP_STATS)
         {
             uint8_t err;
@@ -1031,6 +1140,11 @@ static uint8_t NVOCMP_eraseNvApi(void)
 
   NVOCMP_LOCK();
 
+  // Anything staged or indexed is lost with the rest of NV
+  NVOCMP_txnCount = 0;
+  NVOCMP_txnUsed = 0;
+  NVOCMP_RIDXSTALE()
+
   // Erase All pages before start
   for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
   {
@@ -1116,6 +1230,7 @@ static uint8_t NVOCMP_compactNvApi(uint16_t minAvail)
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
     NVOCMP_ALERT(false, "API Compaction Request.")
+    (void)NVOCMP_txnFlush(&NVOCMP_nvHandle);
     err = NVOCMP_failF;
     // Check for a fatal error
     if(err == NVINTF_SUCCESS)
@@ -1193,6 +1308,9 @@ static uint8_t NVOCMP_createItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    // Staged items must be in NV before the check for an existing item
+    (void)NVOCMP_txnFlush(&NVOCMP_nvHandle);
+
     err = NVOCMP_findItem(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_nvHandle.actOffset, &iHdr,
                           NVOCMP_FINDSTRICT, NULL);
 
@@ -1265,6 +1383,13 @@ static uint8_t NVOCMP_updateItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    if(NVOCMP_txnDepth > 0)
+    {
+      // Stage the update, it is written when the transaction commits
+      err = NVOCMP_txnStage(&NVOCMP_nvHandle, &iHdr, pBuf, NVOCMP_UPDATE);
+      NVOCMP_UNLOCK(err);
+    }
+
     err = NVOCMP_findItem(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_nvHandle.actOffset, &iHdr,
                           NVOCMP_FINDSTRICT, NULL);
 
@@ -1340,6 +1465,9 @@ static uint8_t NVOCMP_deleteItemApi(NVINTF_itemID_t id)
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    // A staged copy would bring the item back on commit
+    (void)NVOCMP_txnFlush(&NVOCMP_nvHandle);
+
     err = NVOCMP_findItem(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_nvHandle.actOffset, &iHdr,
                           NVOCMP_FINDSTRICT, NULL);
 
@@ -1391,6 +1519,17 @@ static uint32_t NVOCMP_getItemLenApi(NVINTF_itemID_t id)
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    if(NVOCMP_txnCount > 0)
+    {
+      int8_t i = NVOCMP_txnFind(iHdr.cmpid);
+      if(i >= 0)
+      {
+        // Staged copy is the current one
+        len = NVOCMP_txnItems[i].hdr.len;
+        NVOCMP_UNLOCK(len);
+      }
+    }
+
     // If there was any error, report zero length
     len = (NVOCMP_findItem(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_nvHandle.actOffset, &iHdr,
                            NVOCMP_FINDSTRICT, NULL) != NVINTF_SUCCESS) ? 0 : iHdr.len;
@@ -1438,6 +1577,9 @@ static uint8_t NVOCMP_readContItemApi(NVINTF_itemID_t id, uint16_t ofs,
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    // Content search only covers items in NV
+    (void)NVOCMP_txnFlush(&NVOCMP_nvHandle);
+
     itemInfo.cBuf = cBuf;
     itemInfo.clength = clen;
     itemInfo.coff = coff;
@@ -1487,6 +1629,26 @@ static uint8_t NVOCMP_readItemApi(NVINTF_itemID_t id, uint16_t ofs, uint16_t len
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    if(NVOCMP_txnCount > 0)
+    {
+      int8_t i = NVOCMP_txnFind(iHdr.cmpid);
+      if(i >= 0)
+      {
+        // Read the staged copy
+        NVOCMP_txnItem_t *pItem = &NVOCMP_txnItems[i];
+        if((ofs + len) <= pItem->hdr.len)
+        {
+          memcpy(pBuf, NVOCMP_txnBuf + pItem->bOfs + ofs, len);
+          err = NVINTF_SUCCESS;
+        }
+        else
+        {
+          err = (len > pItem->hdr.len) ? NVINTF_BADLENGTH : NVINTF_BADOFFSET;
+        }
+        NVOCMP_UNLOCK(err);
+      }
+    }
+
     err = NVOCMP_findItem(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_nvHandle.actOffset, &iHdr,
                           NVOCMP_FINDSTRICT, NULL);
 
@@ -1542,6 +1704,13 @@ static uint8_t NVOCMP_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
     // Prevent RTOS thread contention
     NVOCMP_LOCK();
 
+    if(NVOCMP_txnDepth > 0)
+    {
+      // Stage the write, it is written when the transaction commits
+      err = NVOCMP_txnStage(&NVOCMP_nvHandle, &iHdr, pBuf, NVOCMP_WRITE);
+      NVOCMP_UNLOCK(err);
+    }
+
     // Create a new item
     err = NVOCMP_addItem(&NVOCMP_nvHandle, &iHdr, pBuf, NVOCMP_WRITE);
     if((err == NVINTF_SUCCESS) && (iHdr.hofs > 0))
@@ -1562,6 +1731,87 @@ static uint8_t NVOCMP_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
     NVOCMP_UNLOCK(err);
 }
 
+/******************************************************************************
+ * @fn      NVOCMP_beginTxnApi
+ *
+ * @brief   API function to open a write transaction. Until the matching
+ *          commit, writeItem and updateItem calls are staged in RAM and
+ *          reads return the staged data. Transactions may be nested, the
+ *          staged items are written when the outermost one commits.
+ *
+ * @param   none
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_beginTxnApi(void)
+{
+    uint8_t err = NVINTF_SUCCESS;
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnDepth == 0xFF)
+    {
+        err = NVINTF_FAILURE;
+    }
+    else
+    {
+        NVOCMP_txnDepth++;
+    }
+
+    NVOCMP_UNLOCK(err);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_commitTxnApi
+ *
+ * @brief   API function to close a write transaction. Closing the outermost
+ *          transaction writes all staged items to Flash together, then
+ *          marks the copies they replace as inactive. On low voltage the
+ *          transaction is still closed and its staged items are dropped.
+ *
+ * @param   none
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_commitTxnApi(void)
+{
+    uint8_t err = NVINTF_SUCCESS;
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnDepth == 0)
+    {
+        err = NVINTF_FAILURE;
+    }
+    else if(--NVOCMP_txnDepth == 0)
+    {
+        // Check voltage if possible, the transaction is closed either way
+        NVOCMP_FLASHACCESS(err)
+        if(err)
+        {
+            // Drop the staged items as a direct write would fail, writes
+            // after this one must not be overtaken by them later
+            NVOCMP_txnCount = 0;
+            NVOCMP_txnUsed = 0;
+            NVOCMP_UNLOCK(err);
+        }
+
+        err = NVOCMP_txnFlush(&NVOCMP_nvHandle);
+        NVOCMP_ALERT(err == NVINTF_SUCCESS, "Transaction commit failed.")
+
+#ifdef NV_LINUX
+        if(err == NVINTF_SUCCESS)
+        {
+            NV_LINUX_save();
+        }
+#endif
+    }
+
+    NVOCMP_UNLOCK(err);
+}
+
 //*****************************************************************************
 // Extended API Functions
 //*****************************************************************************
@@ -1671,6 +1921,9 @@ static uint8_t NVOCMP_doNextApi(NVINTF_nvProxy_t * prx)
     // Locks NV
     NVOCMP_LOCK();
 
+    // Batch operations only see items in NV
+    (void)NVOCMP_txnFlush(&NVOCMP_nvHandle);
+
     // New search if start flag set
     if (prx->flag & NVINTF_DOSTART)
     {
@@ -2817,7 +3070,37 @@ static uint8_t NVOCMP_addItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iH
     }
 
 #if NVOCMP_NWSAMEITEM
-    bool changed = false;
+    if(!NVOCMP_itemUnchanged(iHdr, pBuf))
+    {
+    // Create the new NV item
+      NVOCMP_writeItem(pNvHandle, iHdr, pNvHandle->actPage, pNvHandle->actOffset, pBuf);
+    }
+    else
+    {
+      iHdr->hofs = 0;
+    }
+#else
+    // Create the new NV item
+    NVOCMP_writeItem(pNvHandle, iHdr, pNvHandle->actPage, pNvHandle->actOffset, pBuf);
+#endif
+
+    // Status of writing/erasing Flash
+    return(NVOCMP_failW);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_itemUnchanged
+ *
+ * @brief   Local function to compare new item data against the copy in NV
+ *
+ * @param   iHdr - pointer to header of the copy in NV (hofs 0 if none)
+ * @param   pBuf - pointer to new item data
+ *
+ * @return  true if the copy in NV holds the same data
+ */
+static bool NVOCMP_itemUnchanged(NVOCMP_itemHdr_t *iHdr, uint8_t *pBuf)
+{
+#if NVOCMP_NWSAMEITEM
     if((iHdr->hofs) && (iHdr->len))
     {
       #define NVOCMP_COMPARE_SIZE   32
@@ -2835,33 +3118,306 @@ static uint8_t NVOCMP_addItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iH
         NVOCMP_read(iHdr->hpage, iOfs + dOfs, readBuf, len2cmp);
         if(memcmp(readBuf, pBuf + dOfs, len2cmp))
         {
-          changed = true;
-          break;
+          return(false);
         }
         dOfs += len2cmp;
       } while(dOfs < iHdr->len);
+
+      return(true);
     }
-    else
+#else
+    (void)iHdr;
+    (void)pBuf;
+#endif
+    return(false);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnFind
+ *
+ * @brief   Local function to find the live staged copy of an item
+ *
+ * @param   cmpid - compressed item ID
+ *
+ * @return  index into NVOCMP_txnItems or -1 if the item is not staged
+ */
+static int8_t NVOCMP_txnFind(uint32_t cmpid)
+{
+    int8_t i;
+
+    for(i = (int8_t)NVOCMP_txnCount - 1; i >= 0; i--)
     {
-      changed = true;
+        if((NVOCMP_txnItems[i].hdr.cmpid == cmpid) && !NVOCMP_txnItems[i].superseded)
+        {
+            return(i);
+        }
     }
+    return(-1);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnStage
+ *
+ * @brief   Local function to stage an item write of an open transaction.
+ *          Staged data is laid out as it will be in Flash, with room left
+ *          after each item for its header. The staged items are committed
+ *          first if the new item does not fit in the staging buffer.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   iHdr - pointer to header buffer
+ * @param   pBuf - pointer to item data
+ * @param   wm - NVOCMP_WRITE or NVOCMP_UPDATE
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_txnStage(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iHdr,
+                               uint8_t *pBuf, NVOCMP_writeMode_t wm)
+{
+    uint8_t err = NVINTF_SUCCESS;
+    uint16_t iLen = NVOCMP_ITEMHDRLEN + iHdr->len;
+    int8_t i;
+
+    i = NVOCMP_txnFind(iHdr->cmpid);
 
-    if(changed)
+    if((wm == NVOCMP_UPDATE) && (i < 0))
     {
-    // Create the new NV item
-      NVOCMP_writeItem(pNvHandle, iHdr, pNvHandle->actPage, pNvHandle->actOffset, pBuf);
+        // Updates need the item to exist, as when not staging
+        NVOCMP_itemHdr_t hdr = *iHdr;
+        err = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset, &hdr,
+                              NVOCMP_FINDSTRICT, NULL);
+        if(err != NVINTF_SUCCESS)
+        {
+            return((err == NVINTF_NOTFOUND) ? NVINTF_NOTFOUND : NVINTF_FAILURE);
+        }
+    }
+
+    if((i >= 0) && (NVOCMP_txnItems[i].hdr.len == iHdr->len))
+    {
+        // Rewrite of a staged item, replace its data in place
+        memcpy(NVOCMP_txnBuf + NVOCMP_txnItems[i].bOfs, pBuf, iHdr->len);
+        return(NVINTF_SUCCESS);
+    }
+
+    if(iLen > NVOCMP_TXNBUFSIZE)
+    {
+        // Too large to stage, commit what is staged and write it directly
+        err = NVOCMP_txnFlush(pNvHandle);
+        if(err == NVINTF_SUCCESS)
+        {
+            err = NVOCMP_addItem(pNvHandle, iHdr, pBuf, NVOCMP_WRITE);
+            if((err == NVINTF_SUCCESS) && (iHdr->hofs > 0))
+            {
+                NVOCMP_setItemInactive(pNvHandle, iHdr->hpage, iHdr->hofs);
+                err = NVOCMP_failW;
+            }
+        }
+        return(err);
+    }
+
+    if((NVOCMP_txnCount == NVOCMP_TXNMAXITEMS) ||
+       ((NVOCMP_txnUsed + iLen) > NVOCMP_TXNBUFSIZE))
+    {
+        // Staging area full, commit it and start over
+        err = NVOCMP_txnFlush(pNvHandle);
+        if(err != NVINTF_SUCCESS)
+        {
+            return(err);
+        }
+        i = -1;
+    }
+
+    if(i >= 0)
+    {
+        // Length changed, the new copy replaces the staged one
+        NVOCMP_txnItems[i].superseded = true;
+    }
+
+    NVOCMP_txnItems[NVOCMP_txnCount].hdr = *iHdr;
+    NVOCMP_txnItems[NVOCMP_txnCount].bOfs = NVOCMP_txnUsed;
+    NVOCMP_txnItems[NVOCMP_txnCount].superseded = false;
+    memcpy(NVOCMP_txnBuf + NVOCMP_txnUsed, pBuf, iHdr->len);
+    NVOCMP_txnUsed += iLen;
+    NVOCMP_txnCount++;
+
+    return(NVINTF_SUCCESS);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnPack
+ *
+ * @brief   Local function to drop superseded staged items so that the
+ *          staged data is contiguous
+ *
+ * @param   none
+ *
+ * @return  Length of the staged Flash image
+ */
+static uint16_t NVOCMP_txnPack(void)
+{
+    uint8_t i, n;
+    uint16_t total = 0;
+    NVOCMP_txnItem_t *pItem;
+
+    for(i = n = 0; i < NVOCMP_txnCount; i++)
+    {
+        pItem = &NVOCMP_txnItems[i];
+        if(!pItem->superseded)
+        {
+            if(pItem->bOfs != total)
+            {
+                memmove(NVOCMP_txnBuf + total, NVOCMP_txnBuf + pItem->bOfs, pItem->hdr.len);
+                pItem->bOfs = total;
+            }
+            NVOCMP_txnItems[n++] = *pItem;
+            total += NVOCMP_ITEMHDRLEN + pItem->hdr.len;
+        }
+    }
+    NVOCMP_txnCount = n;
+    NVOCMP_txnUsed = total;
+
+    return(total);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnFlush
+ *
+ * @brief   Local function to commit the staged items. All staged items are
+ *          appended to the active page with a single Flash write, then the
+ *          copies they replace are marked inactive in one pass. If the
+ *          items cannot be placed together they are written one by one.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_txnFlush(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t err = NVINTF_SUCCESS;
+    uint8_t i;
+    uint8_t dstPg;
+    uint16_t total;
+    uint16_t dstOff;
+    NVOCMP_txnItem_t *pItem;
+    NVOCMP_pageHdr_t pageHdr;
+
+    total = NVOCMP_txnPack();
+    if(total == 0)
+    {
+        return(NVINTF_SUCCESS);
+    }
+
+    dstPg = NVOCMP_getDstPage(pNvHandle, total);
+    if(dstPg == NVOCMP_NULLPAGE)
+    {
+        // Won't fit on the active page, compact and check again
+        if(NVOCMP_compactPage(pNvHandle, total) >= total)
+        {
+            dstPg = pNvHandle->actPage;
+        }
+    }
+
+    if(dstPg != NVOCMP_NULLPAGE)
+    {
+        NVOCMP_read(dstPg, NVOCMP_PGHDROFS, (uint8_t *)&pageHdr, NVOCMP_PGHDRLEN);
+        if(pageHdr.state == NVOCMP_PGRDY)
+        {
+            NVOCMP_changePageState(pNvHandle, dstPg, NVOCMP_PGACT);
+            pageHdr.state = NVOCMP_PGACT;
+        }
+        if(pageHdr.state != NVOCMP_PGACT)
+        {
+            dstPg = NVOCMP_NULLPAGE;
+        }
+    }
+
+    if((dstPg == NVOCMP_NULLPAGE) || (NVOCMP_failW != NVINTF_SUCCESS))
+    {
+        // Fall back to writing the items one at a time
+        for(i = 0; i < NVOCMP_txnCount; i++)
+        {
+            pItem = &NVOCMP_txnItems[i];
+            if(NVOCMP_addItem(pNvHandle, &pItem->hdr, NVOCMP_txnBuf + pItem->bOfs,
+                              NVOCMP_WRITE) != NVINTF_SUCCESS)
+            {
+                err = NVINTF_FAILURE;
+            }
+            else if(pItem->hdr.hofs > 0)
+            {
+                // Mark old item as inactive
+                NVOCMP_setItemInactive(pNvHandle, pItem->hdr.hpage, pItem->hdr.hofs);
+            }
+        }
     }
     else
     {
-      iHdr->hofs = 0;
+        // Find the copies the staged items replace
+        for(i = 0; i < NVOCMP_txnCount; i++)
+        {
+            NVOCMP_itemHdr_t hdr;
+
+            pItem = &NVOCMP_txnItems[i];
+            hdr = pItem->hdr;
+            hdr.hofs = 0;
+            (void)NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset, &hdr,
+                                  NVOCMP_FINDSTRICT, NULL);
+            pItem->hdr.hpage = hdr.hpage;
+            pItem->hdr.hofs = hdr.hofs;
+            // Nothing to write if NV already holds this data
+            pItem->superseded = (hdr.len == pItem->hdr.len) &&
+                                NVOCMP_itemUnchanged(&pItem->hdr, NVOCMP_txnBuf + pItem->bOfs);
+        }
+        total = NVOCMP_txnPack();
+
+        dstOff = pNvHandle->actOffset;
+        if(total > 0)
+        {
+            // Complete the Flash image with the item headers
+            for(i = 0; i < NVOCMP_txnCount; i++)
+            {
+                uint8_t *pData;
+
+                pItem = &NVOCMP_txnItems[i];
+                pData = NVOCMP_txnBuf + pItem->bOfs;
+                NVOCMP_encodeHeader(&pItem->hdr, pData, pData + pItem->hdr.len);
+            }
+
+            // One Flash write for the whole group
+            NVOCMP_failW = NVOCMP_write(dstPg, dstOff, NVOCMP_txnBuf, total);
+            NVOCMP_ALERT(!NVOCMP_failW, "Driver write failure. Items deleted.")
+
+            // Space is used even on failure, it may be partly programmed
+            pNvHandle->actOffset += total;
+            pNvHandle->pageInfo[dstPg].offset = dstOff + total;
+        }
+
+        for(i = 0; i < NVOCMP_txnCount; i++)
+        {
+            pItem = &NVOCMP_txnItems[i];
+            if(NVOCMP_failW)
+            {
+                // Drop the new copy, the old one stays active
+                NVOCMP_setItemInactive(pNvHandle, dstPg,
+                                       dstOff + pItem->bOfs + pItem->hdr.len);
+            }
+            else
+            {
+                NVOCMP_hotItemUpdate(dstPg, dstOff + pItem->bOfs, pItem->hdr.cmpid);
+                NVOCMP_RIDXUPDATE(dstPg, dstOff + pItem->bOfs + pItem->hdr.len,
+                                  pItem->hdr.cmpid)
+                if(pItem->hdr.hofs > 0)
+                {
+                    // Mark old item as inactive
+                    NVOCMP_setItemInactive(pNvHandle, pItem->hdr.hpage, pItem->hdr.hofs);
+                }
+            }
+        }
+        err = NVOCMP_failW;
     }
-#else
-    // Create the new NV item
-    NVOCMP_writeItem(pNvHandle, iHdr, pNvHandle->actPage, pNvHandle->actOffset, pBuf);
-#endif
 
-    // Status of writing/erasing Flash
-    return(NVOCMP_failW);
+    NVOCMP_txnCount = 0;
+    NVOCMP_txnUsed = 0;
+
+    return(err);
 }
 
 /******************************************************************************
@@ -2987,6 +3543,60 @@ static uint8_t NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg)
     return(err);
 }
 
+/******************************************************************************
+ * @fn      NVOCMP_encodeHeader
+ *
+ * @brief   Build the compressed header of an item, including the CRC over
+ *          the item data and header, with the item marked active.
+ *
+ * @param   pHdr  - Pointer to caller's item header buffer
+ * @param   pBuf  - Points to the item data
+ * @param   cHdr  - Compressed header output
+ *
+ * @return  none
+ */
+static void NVOCMP_encodeHeader(NVOCMP_itemHdr_t *pHdr, uint8_t *pBuf, uint8_t *cHdr)
+{
+    uint8_t newCRC;
+
+    // Compressed item header information <-- Lower Addr    Higher Addr-->
+    // Byte: [0]      [1]      [2]      [3]      [4]      [5]      [6]
+    // Item: SSSSSSII IIIIIIII SSSSSSSS SSLLLLLL LLLLLLCC CCCCCCAV SSSSSSSS
+    // LSB of field:         ^           ^            ^        ^          ^
+#if NVOCMP_HDRLE
+    cHdr[0] = (pHdr->sysid & 0x3F) | ((pHdr->itemid & 0x3) << 6);
+    cHdr[1] = (pHdr->itemid >> 2) & 0xFF;
+    cHdr[2] = pHdr->subid & 0xFF;
+    cHdr[3] = ((pHdr->subid >> 8) & 0x3) | ((pHdr->len & 0x3F) << 2);
+    cHdr[4] = (pHdr->len >> 6) & 0x3F;
+#else
+    cHdr[0] = ((pHdr->sysid << 2) | ((pHdr->itemid >> 8) & 0x3));
+    cHdr[1] = (pHdr->itemid & 0xFF);
+    cHdr[2] = ((pHdr->subid >> 2) & 0xFF);
+    cHdr[3] = ((pHdr->subid & 0x3) << 6) | ((pHdr->len >> 6) & 0x3F);
+    cHdr[4] = ((pHdr->len & 0x3F) << 2);
+#endif
+
+    // Calculate CRC on data portion
+    newCRC = NVOCMP_doRAMCRC(pBuf, pHdr->len, 0);
+    // Finish CRC using header portion
+    newCRC = NVOCMP_doRAMCRC(cHdr, NVOCMP_HDRCRCINC, newCRC);
+
+    // Complete Header with CRC, bits, and sig
+#if NVOCMP_HDRLE
+    // Insert CRC and last bytes
+    cHdr[4] |= ((newCRC & 0x3) << 6);
+    // Note NVOCMP_VALIDIDBIT set implicitly zero
+    cHdr[5] = ((newCRC >> 2) & 0x3F) | (NVOCMP_ACTIVEIDBIT << 6);
+#else
+    // Insert CRC and last bytes
+    cHdr[4] |= ((newCRC >> 6) & 0x3);
+    // Note NVOCMP_VALIDIDBIT set implicitly zero
+    cHdr[5] = ((newCRC & 0x3F) << 2) | NVOCMP_ACTIVEIDBIT;
+#endif
+    cHdr[6] = NVOCMP_SIGNATURE;
+}
+
 /******************************************************************************
  * @fn      NVOCMP_writeItem
  *
@@ -3030,25 +3640,10 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
     {
         cmpIH_t cHdr;
         uint16_t hOfs, dLen;
-        uint8_t newCRC;
 
-        // Compressed item header information <-- Lower Addr    Higher Addr-->
-        // Byte: [0]      [1]      [2]      [3]      [4]      [5]      [6]
-        // Item: SSSSSSII IIIIIIII SSSSSSSS SSLLLLLL LLLLLLCC CCCCCCAV SSSSSSSS
-        // LSB of field:         ^           ^            ^        ^          ^
-#if NVOCMP_HDRLE
-        cHdr[0] = (pHdr->sysid & 0x3F) | ((pHdr->itemid & 0x3) << 6);
-        cHdr[1] = (pHdr->itemid >> 2) & 0xFF;
-        cHdr[2] = pHdr->subid & 0xFF;
-        cHdr[3] = ((pHdr->subid >> 8) & 0x3) | ((pHdr->len & 0x3F) << 2);
-        cHdr[4] = (pHdr->len >> 6) & 0x3F;
-#else
-        cHdr[0] = ((pHdr->sysid << 2) | ((pHdr->itemid >> 8) & 0x3));
-        cHdr[1] = (pHdr->itemid & 0xFF);
-        cHdr[2] = ((pHdr->subid >> 2) & 0xFF);
-        cHdr[3] = ((pHdr->subid & 0x3) << 6) | ((pHdr->len >> 6) & 0x3F);
-        cHdr[4] = ((pHdr->len & 0x3F) << 2);
-#endif
+        // Build the compressed header, including the CRC
+        NVOCMP_encodeHeader(pHdr, pBuf, cHdr);
+
         // Header is located after the item data
         dLen = pHdr->len;
         hOfs = dstOff + dLen;
@@ -3061,24 +3656,7 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
             // Construct item in one buffer
             // Put data into buffer
             memcpy(NVOCMP_itemBuffer, (const void *)pBuf, dLen);
-            // Put most of header into buffer
-            memcpy(NVOCMP_itemBuffer + dLen, (const void *)cHdr,
-                   NVOCMP_HDRCRCINC);
-            // Calculate CRC
-            newCRC = NVOCMP_doRAMCRC(NVOCMP_itemBuffer, dLen +
-                                     NVOCMP_HDRCRCINC, 0);
-#if NVOCMP_HDRLE
-            // Insert CRC and last bytes
-            cHdr[4] |= ((newCRC & 0x3) << 6);
-            // Note NVOCMP_VALIDIDBIT set implicitly zero
-            cHdr[5] = ((newCRC >> 2) & 0x3F) | (NVOCMP_ACTIVEIDBIT << 6);
-#else
-            // Insert CRC and last bytes
-            cHdr[4] |= ((newCRC >> 6) & 0x3);
-            // Note NVOCMP_VALIDIDBIT set implicitly zero
-            cHdr[5] = ((newCRC & 0x3F) << 2) | NVOCMP_ACTIVEIDBIT;
-#endif
-            cHdr[6] = NVOCMP_SIGNATURE;
+            // Put header into buffer
             memcpy(NVOCMP_itemBuffer + dLen, (const void *)cHdr,
                    NVOCMP_ITEMHDRLEN);
             // NVS_write
@@ -3092,23 +3670,6 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
         else
         {
             // Write header/item separately
-            // Calculate CRC on data portion
-            newCRC = NVOCMP_doRAMCRC(pBuf, dLen, 0);
-            // Finish CRC using header portion
-            newCRC = NVOCMP_doRAMCRC(cHdr, NVOCMP_HDRCRCINC, newCRC);
-            // Complete Header with CRC, bits, and sig
-#if NVOCMP_HDRLE
-            // Insert CRC and last bytes
-            cHdr[4] |= ((newCRC & 0x3) << 6);
-            // Note NVOCMP_VALIDIDBIT set implicitly zero
-            cHdr[5] = ((newCRC >> 2) & 0x3F) | (NVOCMP_ACTIVEIDBIT << 6);
-#else
-            // Insert CRC and last bytes
-            cHdr[4] |= ((newCRC >> 6) & 0x3);
-            // Note NVOCMP_VALIDIDBIT set implicitly zero
-            cHdr[5] = ((newCRC & 0x3F) << 2) | NVOCMP_ACTIVEIDBIT;
-#endif
-            cHdr[6] = NVOCMP_SIGNATURE;
             // Write data
             NVOCMP_failW = NVOCMP_write(dstPg, dstOff, pBuf, dLen);
             // Write header
@@ -3132,6 +3693,10 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
         {
             NVOCMP_setItemInactive(pNvHandle, dstPg, hOfs);
         }
+        else
+        {
+            NVOCMP_RIDXUPDATE(dstPg, hOfs, pHdr->cmpid)
+        }
     }
     else
     {
@@ -3533,6 +4098,19 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
 #endif
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#if NVOCMP_RAMIDXSIZE
+    // Latest copy lookups from the head of NV can use the RAM index
+    if(((flag & NVOCMP_FINDLMASK) == NVOCMP_FINDSTRICT) && (pInfo == NULL) &&
+       (pg == pNvHandle->actPage) && (ofs == pNvHandle->actOffset))
+    {
+      int8_t status;
+      if(NVOCMP_ridxFind(pNvHandle, pHdr, cid, &status))
+      {
+        return(status);
+      }
+    }
+#endif
+
 #ifdef NVOCMP_GPRAM
     NVOCMP_disableCache(&vm);
 #endif
@@ -3591,6 +4169,7 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
                   {
                       found = true;
                       NVOCMP_hotItemUpdate(p, ofs, cid);
+                      NVOCMP_RIDXUPDATE(p, ofs, cid)
                   }
                   break;
               case NVOCMP_FINDSYSID:
@@ -3701,6 +4280,19 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
     uint16_t items = 0;
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#if NVOCMP_RAMIDXSIZE
+    // Latest copy lookups from the head of NV can use the RAM index
+    if(((flag & NVOCMP_FINDLMASK) == NVOCMP_FINDSTRICT) && (pInfo == NULL) &&
+       (pg == pNvHandle->actPage) && (ofs == pNvHandle->actOffset))
+    {
+      int8_t status;
+      if(NVOCMP_ridxFind(pNvHandle, pHdr, cid, &status))
+      {
+        return(status);
+      }
+    }
+#endif
+
     // find hot id first, luoyiming 2020-05-21
     NVOCMP_hotId_t* pHotId = NVOCMP_hotItem(cid);
     if( pHotId )
@@ -3750,6 +4342,7 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
                   if (cid == iHdr.cmpid)
                   {
                       found = true;
+                      NVOCMP_RIDXUPDATE(p, ofs, cid)
                   }
                   break;
               case NVOCMP_FINDSYSID:
@@ -4035,6 +4628,7 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     pNvHandle->compactInfo.xSrcSOffset = pNvHandle->pageInfo[srcPg].offset;
     pNvHandle->compactInfo.xSrcEPage = NVOCMP_NULLPAGE;
     pNvHandle->compactInfo.xSrcEOffset = 0;
+    NVOCMP_RIDXSTALE()
     status = NVOCMP_compact(pNvHandle);
 
     if(status == NVOCMP_COMPACT_FAILURE)
@@ -4113,6 +4707,8 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
   pNvHandle->actPage = pg;
   pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
   NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+  // Items have moved, re-index on next lookup
+  NVOCMP_RIDXSTALE()
   return(FLASH_PAGE_SIZE - pNvHandle->compactInfo.xDstOffset);
 }
 #else
@@ -4188,6 +4784,7 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 #endif
 
   pNvHandle->compactInfo.xSrcSOffset = pNvHandle->pageInfo[srcPg].offset;
+  NVOCMP_RIDXSTALE()
   status = NVOCMP_compact(pNvHandle);
 
   if(status == NVOCMP_COMPACT_FAILURE)
@@ -4224,6 +4821,8 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 #if(NVOCMP_NVPAGES > NVOCMP_NVONEP)
   NVOCMP_changePageState(pNvHandle, srcPg ,NVOCMP_PGXDST);
 #endif
+  // Items have moved, re-index on next lookup
+  NVOCMP_RIDXSTALE()
   return(FLASH_PAGE_SIZE - pNvHandle->actOffset);
 }
 #endif
@@ -4919,4 +5518,192 @@ static void NVOCMP_hotItemUpdate(uint8_t pg, uint16_t ofs, uint32_t cid)
   }
 }
 
+#if NVOCMP_RAMIDXSIZE
+/*********************************************************************
+ * @fn      NVOCMP_ridxSlot
+ *
+ * @brief   Find the RAM index entry of an item, or the entry to use for it.
+ *
+ * @param   cid - compressed item ID
+ * @param   add - true to return a free entry when the item is not indexed
+ *
+ * @return  Pointer to the index entry, NULL if not found (or index full)
+ */
+static NVOCMP_ridxEntry_t* NVOCMP_ridxSlot(uint32_t cid, bool add)
+{
+  NVOCMP_ridxEntry_t *pFree = NULL;
+  uint16_t i = (uint16_t)((cid * 0x9E3779B1) % NVOCMP_RAMIDXSIZE);
+  uint16_t n;
+
+  for ( n = 0; n < NVOCMP_RAMIDXSIZE; n++ )
+  {
+    NVOCMP_ridxEntry_t *pEnt = &NVOCMP_ridx[i];
+    if ( pEnt->cid == cid )
+    {
+      return pEnt;
+    }
+    if ( (pEnt->cid == NVOCMP_RIDXDELETED) && (pFree == NULL) )
+    {
+      pFree = pEnt;
+    }
+    else if ( pEnt->cid == NVOCMP_RIDXEMPTY )
+    {
+      // End of the probe chain
+      return ( add ? ((pFree != NULL) ? pFree : pEnt) : NULL );
+    }
+    i = (i + 1 == NVOCMP_RAMIDXSIZE) ? 0 : (i + 1);
+  }
+  return ( add ? pFree : NULL );
+}
+
+/*********************************************************************
+ * @fn      NVOCMP_ridxUpdate
+ *
+ * @brief   Record the header location of an item in the RAM index.
+ *
+ * @param   pg - NV page of the item
+ * @param   ofs - Offset of the item header
+ * @param   cid - compressed item ID
+ *
+ * @return  none
+ */
+static void NVOCMP_ridxUpdate(uint8_t pg, uint16_t ofs, uint32_t cid)
+{
+  NVOCMP_ridxEntry_t *pEnt;
+
+  if ( NVOCMP_ridxStale )
+  {
+    // Will be rebuilt from NV anyway
+    return;
+  }
+
+  pEnt = NVOCMP_ridxSlot(cid, true);
+  if ( pEnt )
+  {
+    pEnt->cid = cid;
+    pEnt->pg = pg;
+    pEnt->hofs = ofs;
+  }
+  else
+  {
+    // Out of entries, absent IDs now need a scan
+    NVOCMP_ridxComplete = false;
+  }
+}
+
+/*********************************************************************
+ * @fn      NVOCMP_ridxBuild
+ *
+ * @brief   Rebuild the RAM index from the active items in NV, newest
+ *          first, so that the latest copy of an item is the one indexed.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  none
+ */
+static void NVOCMP_ridxBuild(NVOCMP_nvHandle_t *pNvHandle)
+{
+  uint8_t p;
+  uint16_t ofs;
+  uint16_t nvSearched = 0;
+
+  memset(NVOCMP_ridx, 0xFF, sizeof(NVOCMP_ridx));
+  NVOCMP_ridxStale = false;
+  NVOCMP_ridxComplete = (pNvHandle->actPage != NVOCMP_NULLPAGE);
+  NVOCMP_ridxStats.rebuilds++;
+  NVOCMP_ridxStats.used = 0;
+
+  for ( p = pNvHandle->actPage; NVOCMP_ridxComplete && (nvSearched < NVOCMP_NVSIZE);
+        p = NVOCMP_DECPAGE(p) )
+  {
+    nvSearched++;
+#if (NVOCMP_NVPAGES != NVOCMP_NVONEP)
+    if ( p == pNvHandle->tailPage )
+    {
+      continue;
+    }
+#endif
+    ofs = (p == pNvHandle->actPage) ? pNvHandle->actOffset : pNvHandle->pageInfo[p].offset;
+
+    while ( ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN) )
+    {
+      NVOCMP_itemHdr_t iHdr;
+
+      ofs -= NVOCMP_ITEMHDRLEN;
+      NVOCMP_readHeader(p, ofs, &iHdr, false);
+
+      if ( (iHdr.stats & NVOCMP_ACTIVEIDBIT) && !(iHdr.stats & NVOCMP_VALIDIDBIT) &&
+           (NVOCMP_ridxSlot(iHdr.cmpid, false) == NULL) )
+      {
+        NVOCMP_ridxUpdate(p, ofs, iHdr.cmpid);
+        NVOCMP_ridxStats.used++;
+      }
+
+      if ( (iHdr.stats & NVOCMP_FOLLOWBIT) && (iHdr.len < ofs) )
+      {
+        ofs -= iHdr.len;
+      }
+      else
+      {
+        // Leave corruption to findItem, which compacts to fix it
+        NVOCMP_ridxComplete = false;
+        break;
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      NVOCMP_ridxFind
+ *
+ * @brief   Look up the latest copy of an item through the RAM index. The
+ *          header at the indexed location is checked before it is used.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   pHdr - pointer to item header, filled in if the item is found
+ * @param   cid - compressed item ID
+ * @param   pStatus - findItem status when the lookup was resolved
+ *
+ * @return  true if resolved, false if a page scan is needed
+ */
+static bool NVOCMP_ridxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                            uint32_t cid, int8_t *pStatus)
+{
+  NVOCMP_ridxEntry_t *pEnt;
+
+  if ( NVOCMP_ridxStale )
+  {
+    NVOCMP_ridxBuild(pNvHandle);
+  }
+  NVOCMP_ridxStats.lookups++;
+
+  pEnt = NVOCMP_ridxSlot(cid, false);
+  if ( pEnt )
+  {
+    NVOCMP_itemHdr_t iHdr;
+    NVOCMP_readHeader(pEnt->pg, pEnt->hofs, &iHdr, false);
+    if ( (iHdr.cmpid == cid) && (iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+         !(iHdr.stats & NVOCMP_VALIDIDBIT) )
+    {
+      memcpy(pHdr, &iHdr, sizeof(NVOCMP_itemHdr_t));
+      NVOCMP_ridxStats.hits++;
+      *pStatus = NVINTF_SUCCESS;
+      return true;
+    }
+    // Item was deleted or moved, the scan re-indexes it if still there
+    pEnt->cid = NVOCMP_RIDXDELETED;
+  }
+  else if ( NVOCMP_ridxComplete )
+  {
+    pHdr->hofs = 0;
+    NVOCMP_ridxStats.misses++;
+    *pStatus = NVINTF_NOTFOUND;
+    return true;
+  }
+
+  NVOCMP_ridxStats.scans++;
+  return false;
+}
+#endif // NVOCMP_RAMIDXSIZE
+
 //*****************************************************************************
@@ -80,6 +80,18 @@ typedef struct
 }
 NVOCMP_diag_t;
 
+// NV driver RAM index counters, see NVOCMP_RAMIDXSIZE
+typedef struct
+{
+    uint32_t lookups;   // Item lookups made through the index
+    uint32_t hits;      // Lookups that found the item through the index
+    uint32_t misses;    // Lookups that found the item absent without a scan
+    uint32_t scans;     // Lookups that fell back to a page scan
+    uint16_t rebuilds;  // Number of times the index was rebuilt from NV
+    uint16_t used;      // Entries in use after the last rebuild
+}
+NVOCMP_ramIdxStats_t;
+
 // Low Voltage Check Callback function, voltage is measured voltage value
 typedef void (*lowVoltCbFptr)(uint32_t voltage);
 //*****************************************************************************
@@ -154,6 +166,20 @@ extern void NVOCMP_setCheckVoltage(void *funcPtr);
  */
 extern void NVOCMP_setLowVoltageCb(lowVoltCbFptr funcPtr);
 
+/**
+ * @fn      NVOCMP_getRamIdxStats
+ *
+ * @brief   Global function to read and optionally clear the RAM index
+ *          counters. Comparing them with NVOCMP_RAMIDXSIZE set and unset
+ *          shows how many item lookups avoid a page scan.
+ *
+ * @param   pStats - pointer to caller's counter structure
+ * @param   clear - true to reset the counters after reading them
+ *
+ * @return  none
+ */
+extern void NVOCMP_getRamIdxStats(NVOCMP_ramIdxStats_t *pStats, bool clear);
+
 // Exception function can be defined to handle NV corruption issues
 // If none provided, NV module attempts to proceed ignoring problem
 #if !defined (NVOCMP_EXCEPTION)
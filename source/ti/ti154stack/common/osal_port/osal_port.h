@@ -124,6 +124,19 @@ typedef struct
 
 typedef void * OsalPort_MsgQ;
 
+/* Number of message pool size classes, see OsalPort_msgPoolGetMetrics() */
+#define OsalPort_MSG_POOL_CLASSES 4
+
+/** Message pool size class counters */
+typedef struct
+{
+  uint16_t blkSize;   /* block size, message header included */
+  uint8_t  blkCnt;    /* blocks in the pool */
+  uint8_t  blkUsed;   /* blocks currently allocated */
+  uint8_t  blkMax;    /* high-water mark of blkUsed */
+  uint16_t blkFail;   /* allocations that found the pool empty and used the heap */
+} OsalPort_MsgPoolMetrics;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -172,12 +185,9 @@ uint8_t OsalPort_getTaskId(void* taskHndl);
  *    into which the task will encode the particular message it wishes
  *    to send.  This common buffer scheme is used to strictly limit the
  *    creation of message buffers within the system due to RAM size
- *    limitations on the microprocessor.   Note that all message buffers
- *    are a fixed size (at least initially).  The parameter len is kept
- *    in case a message pool with varying fixed message sizes is later
- *    created (for example, a pool of message buffers of size LARGE,
- *    MEDIUM and SMALL could be maintained and allocated based on request
- *    from the tasks).
+ *    limitations on the microprocessor.   Messages are taken from the
+ *    smallest message pool size class that fits len, and from the heap
+ *    when the message is too large or that pool is exhausted.
  *
  *
  * @param   uint8_t len  - wanted buffer length
@@ -187,6 +197,39 @@ uint8_t OsalPort_getTaskId(void* taskHndl);
  */
 extern uint8_t * OsalPort_msgAllocate(uint16_t len );
 
+/*********************************************************************
+ * @fn      OsalPort_msgPoolGetMetrics
+ *
+ * @brief
+ *
+ *    Get the counters of the message pools, one entry per size class.
+ *
+ * @param   pMetrics - array of OsalPort_MSG_POOL_CLASSES entries
+ *
+ * @return  none
+ */
+extern void OsalPort_msgPoolGetMetrics( OsalPort_MsgPoolMetrics *pMetrics );
+
+#ifdef HEAPMGR_METRICS
+/*********************************************************************
+ * @fn      OsalPort_heapMgrGetMetrics
+ *
+ * @brief
+ *
+ *    Get the heap counters and, if pPoolMetrics is not NULL, the
+ *    message pool counters (OsalPort_MSG_POOL_CLASSES entries).
+ *
+ * @return  none
+ */
+extern void OsalPort_heapMgrGetMetrics(uint32_t *pBlkMax,
+                                       uint32_t *pBlkCnt,
+                                       uint32_t *pBlkFree,
+                                       uint32_t *pMemAlo,
+                                       uint32_t *pMemMax,
+                                       uint32_t *pMemUB,
+                                       OsalPort_MsgPoolMetrics *pPoolMetrics);
+#endif
+
 /*********************************************************************
  * @fn      OsalPort_msgDeallocate
  *
@@ -222,6 +265,37 @@ extern uint8_t OsalPort_msgDeallocate( uint8_t *pMsg );
  */
 extern uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg );
 
+/*********************************************************************
+ * @fn      OsalPort_msgExpectRsp
+ *
+ * @brief
+ *
+ *    This function is called by a task before sending a message that
+ *    will be sent back to it as a response. When the message comes back
+ *    it is put in the task's response slot instead of its queue, to be
+ *    retrieved with OsalPort_msgRspDequeue().
+ *
+ * @param   uint8_t taskId - ID of the task waiting for the response
+ * @param   void *pMsg - message to wait for, NULL to cancel
+ *
+ * @return  SUCCESS, INVALID_TASK
+ */
+extern uint8_t OsalPort_msgExpectRsp( uint8_t taskId, void *pMsg );
+
+/*********************************************************************
+ * @fn      OsalPort_msgRspDequeue
+ *
+ * @brief
+ *
+ *    This function takes the expected response out of a task's
+ *    response slot.
+ *
+ * @param   uint8_t taskId - ID of the task waiting for the response
+ *
+ * @return  pointer to the response or NULL if it has not arrived yet
+ */
+extern OsalPort_EventHdr* OsalPort_msgRspDequeue( uint8_t taskId );
+
 /*********************************************************************
  * @fn      OsalPort_msgReceive
  *
@@ -66,6 +66,44 @@
 /* Only 1 application can talk to the MAC */
 #define MAX_TASKS 15
 
+/* Message pool size classes: block size (message header included, multiple
+ * of 8) and number of blocks, smallest class first. Messages that do not
+ * fit a class, or find their class empty, are allocated from the heap. */
+#if !defined OsalPort_MSG_POOL_SIZE_0
+#define OsalPort_MSG_POOL_SIZE_0    48
+#endif
+#if !defined OsalPort_MSG_POOL_CNT_0
+#define OsalPort_MSG_POOL_CNT_0     8
+#endif
+#if !defined OsalPort_MSG_POOL_SIZE_1
+#define OsalPort_MSG_POOL_SIZE_1    80
+#endif
+#if !defined OsalPort_MSG_POOL_CNT_1
+#define OsalPort_MSG_POOL_CNT_1     8
+#endif
+#if !defined OsalPort_MSG_POOL_SIZE_2
+#define OsalPort_MSG_POOL_SIZE_2    144
+#endif
+#if !defined OsalPort_MSG_POOL_CNT_2
+#define OsalPort_MSG_POOL_CNT_2     4
+#endif
+#if !defined OsalPort_MSG_POOL_SIZE_3
+#define OsalPort_MSG_POOL_SIZE_3    272
+#endif
+#if !defined OsalPort_MSG_POOL_CNT_3
+#define OsalPort_MSG_POOL_CNT_3     2
+#endif
+
+#if ( (OsalPort_MSG_POOL_SIZE_0 % 8) != 0 ) || ( (OsalPort_MSG_POOL_SIZE_1 % 8) != 0 ) || \
+    ( (OsalPort_MSG_POOL_SIZE_2 % 8) != 0 ) || ( (OsalPort_MSG_POOL_SIZE_3 % 8) != 0 )
+#error "OsalPort_MSG_POOL_SIZE_n must be multiples of 8"
+#endif
+
+#define OsalPort_MSG_POOL_BYTES    ( OsalPort_MSG_POOL_SIZE_0 * OsalPort_MSG_POOL_CNT_0 + \
+                                     OsalPort_MSG_POOL_SIZE_1 * OsalPort_MSG_POOL_CNT_1 + \
+                                     OsalPort_MSG_POOL_SIZE_2 * OsalPort_MSG_POOL_CNT_2 + \
+                                     OsalPort_MSG_POOL_SIZE_3 * OsalPort_MSG_POOL_CNT_3 )
+
 /***** Variable declarations *****/
 
 
@@ -88,6 +126,9 @@ typedef struct
     uint8_t taskId;
     Task_Handle taskHndl;
     OsalPort_MsgQ qHandle;
+    void *qTail;          /* last message in qHandle, for constant time sends */
+    void *pRspExpected;   /* message the task is blocked waiting for */
+    void *pRspSlot;       /* expected message, once sent back to the task */
     Semaphore_Handle taskSem;
     bool conservePower;
     uint32_t* pEventFlag;
@@ -108,6 +149,34 @@ typedef struct
 /* instantiate variable referenced in ROM but not used */
 uint16_t *macTasksEvents = 0;
 
+/**
+ * @internal
+ * Message pool size class. Free blocks are chained through their first word.
+ */
+typedef struct
+{
+  uint8_t  *pStart;
+  uint8_t  *pEnd;
+  void     *pFree;
+  OsalPort_MsgPoolMetrics metrics;
+} OsalPort_MsgPool;
+
+static const uint16_t OsalPort_msgPoolSize[OsalPort_MSG_POOL_CLASSES] =
+{
+  OsalPort_MSG_POOL_SIZE_0, OsalPort_MSG_POOL_SIZE_1,
+  OsalPort_MSG_POOL_SIZE_2, OsalPort_MSG_POOL_SIZE_3
+};
+
+static const uint8_t OsalPort_msgPoolCnt[OsalPort_MSG_POOL_CLASSES] =
+{
+  OsalPort_MSG_POOL_CNT_0, OsalPort_MSG_POOL_CNT_1,
+  OsalPort_MSG_POOL_CNT_2, OsalPort_MSG_POOL_CNT_3
+};
+
+static OsalPort_MsgPool OsalPort_msgPools[OsalPort_MSG_POOL_CLASSES];
+static uint32_t OsalPort_msgPoolStore[OsalPort_MSG_POOL_BYTES / sizeof(uint32_t)];
+static bool OsalPort_msgPoolReady = false;
+
 /**
  * @internal
  * Wakeup schedule data structure definition
@@ -121,6 +190,12 @@ typedef struct _osalPort_schedule_t
 
 /***** Private function definitions *****/
 
+static TaskEntry *OsalPort_getTaskEntry(uint8_t taskId);
+static void OsalPort_taskEnqueue(TaskEntry *pTask, void *pMsg);
+static void OsalPort_msgPoolInit(void);
+static void *OsalPort_msgPoolAlloc(uint32_t size);
+static bool OsalPort_msgPoolFree(void *pBlk);
+
 // DMM currently uses ICall Heap
 #ifdef USE_DMM
 extern void *ICall_heapMalloc(uint32_t size);
@@ -146,15 +221,24 @@ static void OsalPort_heapFree(void *blk);
 #define HEAPMGR_GETSTATS        OsalPort_heapGetStats
 #define HEAPMGR_MALLOC_LIMITED  OsalPort_heapMallocLimited
 
-#ifdef HEAPMGR_METRICS
-void OsalPort_heapMgrGetMetrics(uint32_t *pBlkMax,
-                             uint32_t *pBlkCnt,
-                             uint32_t *pBlkFree,
-                             uint32_t *pMemAlo,
-                             uint32_t *pMemMax,
-                             uint32_t *pMemUB);
+/* heapmem and heaptrack are selected by HEAPMGR_CONFIG, the osal heap
+ * otherwise */
+#if !( defined(HEAPMGR_CONFIG) && ( (HEAPMGR_CONFIG == 1) || (HEAPMGR_CONFIG == 0x81) || \
+                                    (HEAPMGR_CONFIG == 2) || (HEAPMGR_CONFIG == 0x82) ) )
+#define OsalPort_HEAP_OSAL
+#endif
 
-#define HEAPMGR_GETMETRICS      OsalPort_heapMgrGetMetrics
+#if defined(HEAPMGR_METRICS) && defined(OsalPort_HEAP_OSAL)
+/* Heap counters, reported with the message pool counters by
+ * OsalPort_heapMgrGetMetrics() */
+static void OsalPort_heapGetMetrics(uint32_t *pBlkMax,
+                                    uint32_t *pBlkCnt,
+                                    uint32_t *pBlkFree,
+                                    uint32_t *pMemAlo,
+                                    uint32_t *pMemMax,
+                                    uint32_t *pMemUB);
+
+#define HEAPMGR_GETMETRICS      OsalPort_heapGetMetrics
 #endif
 
 #define HEAPMGR_LOCK()                                       \
@@ -168,14 +252,12 @@ void OsalPort_heapMgrGetMetrics(uint32_t *pBlkMax,
  * lock call. */
 static uint32_t OsalPort_heapCSState;
 
-#if defined(HEAPMGR_CONFIG) && ((HEAPMGR_CONFIG == 0) || (HEAPMGR_CONFIG == 0x80))
+#if defined(OsalPort_HEAP_OSAL)
 #include <rtos_heaposal.h>
-#elif defined(HEAPMGR_CONFIG) && ( (HEAPMGR_CONFIG == 1) || (HEAPMGR_CONFIG == 0x81))
+#elif ( (HEAPMGR_CONFIG == 1) || (HEAPMGR_CONFIG == 0x81) )
 #include <rtos_heapmem.h>
-#elif defined(HEAPMGR_CONFIG) && ( (HEAPMGR_CONFIG == 2) || (HEAPMGR_CONFIG == 0x82))
-#include <rtos_heaptrack.h>
 #else
-#include <rtos_heaposal.h>
+#include <rtos_heaptrack.h>
 #endif
 #endif // USE_DMM
 
@@ -203,6 +285,9 @@ uint8_t OsalPort_registerTask(void* taskHndl, void* taskSem, uint32_t* pEvent)
         taskTbl[taskCnt].taskHndl = taskHndl;
         taskTbl[taskCnt].taskSem = taskSem;
         taskTbl[taskCnt].qHandle = NULL;
+        taskTbl[taskCnt].qTail = NULL;
+        taskTbl[taskCnt].pRspExpected = NULL;
+        taskTbl[taskCnt].pRspSlot = NULL;
         taskTbl[taskCnt].conservePower = false;
         taskTbl[taskCnt].pEventFlag = pEvent;
     }
@@ -214,6 +299,58 @@ uint8_t OsalPort_registerTask(void* taskHndl, void* taskSem, uint32_t* pEvent)
     return taskCnt-1;
 }
 
+/*********************************************************************
+ * @fn      OsalPort_getTaskEntry
+ *
+ * @brief
+ *
+ *    This function maps a task ID to its task table entry. Task IDs are
+ *    handed out as table indexes by OsalPort_registerTask(), so no
+ *    search is needed.
+ *
+ *
+ * @param   uint8_t taskId - task ID
+ *
+ * @return  task table entry or NULL if the task ID is not registered
+ */
+static TaskEntry *OsalPort_getTaskEntry(uint8_t taskId)
+{
+    if((taskId < taskCnt) && (taskId < MAX_TASKS))
+    {
+        return &taskTbl[taskId];
+    }
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_taskEnqueue
+ *
+ * @brief
+ *
+ *    This function appends a message to a task's queue using the
+ *    queue's tail pointer. Must be called in a critical section.
+ *
+ *
+ * @param   TaskEntry *pTask - task table entry
+ * @param   void *pMsg  - OSAL message
+ *
+ * @return  none
+ */
+static void OsalPort_taskEnqueue(TaskEntry *pTask, void *pMsg)
+{
+    OsalPort_MSG_NEXT( pMsg ) = NULL;
+
+    if ( pTask->qHandle == NULL )
+    {
+        pTask->qHandle = pMsg;
+    }
+    else
+    {
+        OsalPort_MSG_NEXT( pTask->qTail ) = pMsg;
+    }
+    pTask->qTail = pMsg;
+}
+
 /*********************************************************************
  * @fn      OsalPort_getTaskId
  *
@@ -239,6 +376,222 @@ uint8_t OsalPort_getTaskId(void* taskHndl)
     return 0xFF;
 }
 
+/*********************************************************************
+ * @fn      OsalPort_msgPoolInit
+ *
+ * @brief
+ *
+ *   Carves the message pool store into the size classes and chains the
+ *   free blocks of each class. Called with interrupts disabled.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void OsalPort_msgPoolInit(void)
+{
+    uint8_t *pBlk = (uint8_t *)OsalPort_msgPoolStore;
+    uint8_t i;
+    uint8_t j;
+
+    for ( i = 0; i < OsalPort_MSG_POOL_CLASSES; i++ )
+    {
+        OsalPort_MsgPool *pPool = &OsalPort_msgPools[i];
+
+        pPool->metrics.blkSize = OsalPort_msgPoolSize[i];
+        pPool->metrics.blkCnt = OsalPort_msgPoolCnt[i];
+        pPool->pStart = pBlk;
+
+        for ( j = 0; j < OsalPort_msgPoolCnt[i]; j++ )
+        {
+            *(void **)pBlk = pPool->pFree;
+            pPool->pFree = pBlk;
+            pBlk += OsalPort_msgPoolSize[i];
+        }
+
+        pPool->pEnd = pBlk;
+    }
+
+    OsalPort_msgPoolReady = true;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgPoolAlloc
+ *
+ * @brief
+ *
+ *   Takes a block from the smallest size class that fits.
+ *
+ * @param   size - size of allocation, message header included
+ *
+ * @return  pointer to the block, or NULL if no class fits or the class
+ *          is exhausted
+ */
+static void *OsalPort_msgPoolAlloc(uint32_t size)
+{
+    OsalPort_MsgPool *pPool;
+    void *pBlk = NULL;
+    uint32_t key;
+    uint8_t i;
+
+    key = OsalPort_enterCS();
+
+    if ( !OsalPort_msgPoolReady )
+    {
+        OsalPort_msgPoolInit();
+    }
+
+    for ( i = 0; i < OsalPort_MSG_POOL_CLASSES; i++ )
+    {
+        pPool = &OsalPort_msgPools[i];
+
+        if ( size <= pPool->metrics.blkSize )
+        {
+            pBlk = pPool->pFree;
+
+            if ( pBlk != NULL )
+            {
+                pPool->pFree = *(void **)pBlk;
+
+                if ( ++pPool->metrics.blkUsed > pPool->metrics.blkMax )
+                {
+                    pPool->metrics.blkMax = pPool->metrics.blkUsed;
+                }
+            }
+            else
+            {
+                pPool->metrics.blkFail++;
+            }
+            break;
+        }
+    }
+
+    OsalPort_leaveCS(key);
+
+    return pBlk;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgPoolFree
+ *
+ * @brief
+ *
+ *   Returns a block to its size class.
+ *
+ * @param   pBlk - block to free
+ *
+ * @return  true if the block belongs to a message pool, false if it
+ *          came from the heap
+ */
+static bool OsalPort_msgPoolFree(void *pBlk)
+{
+    OsalPort_MsgPool *pPool;
+    uint32_t key;
+    uint8_t i;
+
+    if ( ( (uint8_t *)pBlk < (uint8_t *)OsalPort_msgPoolStore ) ||
+         ( (uint8_t *)pBlk >= (uint8_t *)OsalPort_msgPoolStore + sizeof( OsalPort_msgPoolStore ) ) )
+    {
+        return false;
+    }
+
+    key = OsalPort_enterCS();
+
+    for ( i = 0; i < OsalPort_MSG_POOL_CLASSES; i++ )
+    {
+        pPool = &OsalPort_msgPools[i];
+
+        if ( (uint8_t *)pBlk < pPool->pEnd )
+        {
+            *(void **)pBlk = pPool->pFree;
+            pPool->pFree = pBlk;
+            pPool->metrics.blkUsed--;
+            break;
+        }
+    }
+
+    OsalPort_leaveCS(key);
+
+    return true;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgPoolGetMetrics
+ *
+ * @brief
+ *
+ *   Get the counters of the message pools, one entry per size class.
+ *
+ * @param   pMetrics - array of OsalPort_MSG_POOL_CLASSES entries
+ *
+ * @return  none
+ */
+void OsalPort_msgPoolGetMetrics( OsalPort_MsgPoolMetrics *pMetrics )
+{
+    uint32_t key;
+    uint8_t i;
+
+    key = OsalPort_enterCS();
+
+    if ( !OsalPort_msgPoolReady )
+    {
+        OsalPort_msgPoolInit();
+    }
+
+    for ( i = 0; i < OsalPort_MSG_POOL_CLASSES; i++ )
+    {
+        pMetrics[i] = OsalPort_msgPools[i].metrics;
+    }
+
+    OsalPort_leaveCS(key);
+}
+
+#ifdef HEAPMGR_METRICS
+/*********************************************************************
+ * @fn      OsalPort_heapMgrGetMetrics
+ *
+ * @brief
+ *
+ *   Get the heap counters and, if pPoolMetrics is not NULL, the message
+ *   pool counters. Heaps other than the osal heap keep no counters, they
+ *   are reported as 0.
+ *
+ * @param   pBlkMax   - max cnt of all blocks ever seen at once
+ * @param   pBlkCnt   - current cnt of all blocks
+ * @param   pBlkFree  - current cnt of free blocks
+ * @param   pMemAlo   - current total memory allocated
+ * @param   pMemMax   - max total memory ever allocated at once
+ * @param   pMemUB    - upper bound of memory usage
+ * @param   pPoolMetrics - array of OsalPort_MSG_POOL_CLASSES entries, or NULL
+ *
+ * @return  none
+ */
+void OsalPort_heapMgrGetMetrics(uint32_t *pBlkMax,
+                                uint32_t *pBlkCnt,
+                                uint32_t *pBlkFree,
+                                uint32_t *pMemAlo,
+                                uint32_t *pMemMax,
+                                uint32_t *pMemUB,
+                                OsalPort_MsgPoolMetrics *pPoolMetrics)
+{
+#if defined(OsalPort_HEAP_OSAL)
+    OsalPort_heapGetMetrics(pBlkMax, pBlkCnt, pBlkFree, pMemAlo, pMemMax, pMemUB);
+#else
+    *pBlkMax = 0;
+    *pBlkCnt = 0;
+    *pBlkFree = 0;
+    *pMemAlo = 0;
+    *pMemMax = 0;
+    *pMemUB = 0;
+#endif
+
+    if ( pPoolMetrics != NULL )
+    {
+        OsalPort_msgPoolGetMetrics( pPoolMetrics );
+    }
+}
+#endif
+
 /*********************************************************************
  * @fn      OsalPort_msgAllocate
  *
@@ -248,12 +601,9 @@ uint8_t OsalPort_getTaskId(void* taskHndl)
  *    into which the task will encode the particular message it wishes
  *    to send.  This common buffer scheme is used to strictly limit the
  *    creation of message buffers within the system due to RAM size
- *    limitations on the microprocessor.   Note that all message buffers
- *    are a fixed size (at least initially).  The parameter len is kept
- *    in case a message pool with varying fixed message sizes is later
- *    created (for example, a pool of message buffers of size LARGE,
- *    MEDIUM and SMALL could be maintained and allocated based on request
- *    from the tasks).
+ *    limitations on the microprocessor.   Messages are taken from the
+ *    smallest message pool size class that fits len, and from the heap
+ *    when the message is too large or that pool is exhausted.
  *
  *
  * @param   uint8_t len  - wanted buffer length
@@ -269,7 +619,12 @@ uint8_t * OsalPort_msgAllocate(uint16_t len )
     if ( len == 0 )
         return ( NULL );
 
-    pHdr = (OsalPort_MsgHdr*) OsalPort_malloc( len + sizeof( OsalPort_MsgHdr ) );
+    pHdr = (OsalPort_MsgHdr*) OsalPort_msgPoolAlloc( len + sizeof( OsalPort_MsgHdr ) );
+
+    if ( pHdr == NULL )
+    {
+        pHdr = (OsalPort_MsgHdr*) OsalPort_malloc( len + sizeof( OsalPort_MsgHdr ) );
+    }
 
     if ( pHdr )
     {
@@ -310,7 +665,10 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
 
     x = (uint8_t *)((uint8_t *)pMsg - sizeof( OsalPort_MsgHdr ));
 
-    OsalPort_free( (void *)x );
+    if ( !OsalPort_msgPoolFree( (void *)x ) )
+    {
+        OsalPort_free( (void *)x );
+    }
 
     return ( OsalPort_SUCCESS );
 }
@@ -334,7 +692,7 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
  */
 uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
 
     if(pMsg == NULL)
@@ -343,22 +701,97 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
     }
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_getTaskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
+        return OsalPort_INVALID_TASK;
+    }
 
-            OsalPort_msgEnqueue(&taskTbl[taskIdx].qHandle, pMsg );
-            OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    key = OsalPort_enterCS();
 
-            OsalPort_leaveCS(key);
+    if(pMsg == pTask->pRspExpected)
+    {
+        // Hand the response straight to the blocked task
+        pTask->pRspExpected = NULL;
+        pTask->pRspSlot = pMsg;
 
-            return OsalPort_SUCCESS;
+        if(pTask->taskSem)
+        {
+            Semaphore_post(pTask->taskSem);
         }
     }
+    else
+    {
+        OsalPort_taskEnqueue(pTask, pMsg);
+        OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    }
+
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgExpectRsp
+ *
+ * @brief
+ *
+ *    This function is called by a task before sending a message that
+ *    will be sent back to it as a response. When the message comes back
+ *    it is put in the task's response slot instead of its queue, to be
+ *    retrieved with OsalPort_msgRspDequeue().
+ *
+ *
+ * @param   uint8_t taskId - ID of the task waiting for the response
+ * @param   void *pMsg - message to wait for, NULL to cancel
+ *
+ * @return  OsalPort_SUCCESS, OsalPort_INVALID_TASK
+ */
+uint8_t OsalPort_msgExpectRsp( uint8_t taskId, void *pMsg )
+{
+    TaskEntry *pTask = OsalPort_getTaskEntry(taskId);
+    uint32_t key;
+
+    if(pTask == NULL)
+    {
+        return OsalPort_INVALID_TASK;
+    }
+
+    key = OsalPort_enterCS();
+    pTask->pRspExpected = pMsg;
+    OsalPort_leaveCS(key);
 
-    return OsalPort_INVALID_TASK;
+    return OsalPort_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgRspDequeue
+ *
+ * @brief
+ *
+ *    This function takes the expected response out of a task's
+ *    response slot.
+ *
+ *
+ * @param   uint8_t taskId - ID of the task waiting for the response
+ *
+ * @return  pointer to the response or NULL if it has not arrived yet
+ */
+OsalPort_EventHdr* OsalPort_msgRspDequeue( uint8_t taskId )
+{
+    TaskEntry *pTask = OsalPort_getTaskEntry(taskId);
+    OsalPort_EventHdr *pRsp = NULL;
+    uint32_t key;
+
+    if(pTask != NULL)
+    {
+        key = OsalPort_enterCS();
+        pRsp = (OsalPort_EventHdr *)pTask->pRspSlot;
+        pTask->pRspSlot = NULL;
+        OsalPort_leaveCS(key);
+    }
+
+    return pRsp;
 }
 
 /**************************************************************************************************
@@ -381,31 +814,30 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
  */
 OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
 
-    key = OsalPort_enterCS();
-
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_getTaskEntry(taskId);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+        return NULL;
+    }
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
-            {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-                break;
-              }
+    key = OsalPort_enterCS();
 
-              pHdr = OsalPort_MSG_NEXT(pHdr);
-            }
-            break;
-        }
+    pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
+
+    // Look through the tasks queue for a message that matches the task_id and event parameters.
+    while (pHdr != NULL)
+    {
+      if (((OsalPort_EventHdr *)pHdr)->event == event)
+      {
+        break;
+      }
+
+      pHdr = OsalPort_MSG_NEXT(pHdr);
     }
 
     OsalPort_leaveCS(key);
@@ -428,30 +860,36 @@ OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
  */
 uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint8_t* pMsg = NULL;
+    uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_getTaskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            pMsg = OsalPort_msgDequeue( &taskTbl[taskIdx].qHandle );
+        return NULL;
+    }
 
-            // Are there any more messages?
-            if ( OsalPort_MSG_Q_EMPTY(&taskTbl[taskIdx].qHandle) )
-            {
-                // Clear message event
-                OsalPort_clearEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
-            else
-            {
-                // Signal the task that another message is waiting
-                OsalPort_setEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
+    key = OsalPort_enterCS();
 
-        }
+    pMsg = OsalPort_msgDequeue( &pTask->qHandle );
+
+    // Are there any more messages?
+    if ( OsalPort_MSG_Q_EMPTY(&pTask->qHandle) )
+    {
+        pTask->qTail = NULL;
+
+        // Clear message event
+        OsalPort_clearEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    }
+    else
+    {
+        // Signal the task that another message is waiting
+        OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
     }
 
+    OsalPort_leaveCS(key);
+
     return pMsg;
 }
 
@@ -470,30 +908,27 @@ uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
  */
 uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
 {
-    uint8_t taskIdx;
-    uint8_t status = OsalPort_INVALID_TASK;
+    TaskEntry *pTask;
     uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_getTaskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
-
-            *taskTbl[taskIdx].pEventFlag |= (uint32_t)eventFlag;
+        return OsalPort_INVALID_TASK;
+    }
 
-            if(taskTbl[taskIdx].taskSem)
-            {
-                Semaphore_post(taskTbl[taskIdx].taskSem);
-            }
+    key = OsalPort_enterCS();
 
-            status = OsalPort_SUCCESS;
+    *pTask->pEventFlag |= (uint32_t)eventFlag;
 
-            OsalPort_leaveCS(key);
-        }
+    if(pTask->taskSem)
+    {
+        Semaphore_post(pTask->taskSem);
     }
 
-    return status;
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
 }
 
 /*********************************************************************
@@ -509,15 +944,12 @@ uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
  */
 uint32_t OsalPort_waitEvent(uint8_t taskId)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask = OsalPort_getTaskEntry(taskId);
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            Semaphore_pend(taskTbl[taskIdx].taskSem, BIOS_WAIT_FOREVER);
-            return *taskTbl[taskIdx].pEventFlag;
-        }
+        Semaphore_pend(pTask->taskSem, BIOS_WAIT_FOREVER);
+        return *pTask->pEventFlag;
     }
 
     return 0;
@@ -713,45 +1145,57 @@ void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
  */
 OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
     OsalPort_MsgHdr *pPrev = NULL;
 
+    /*find dest task */
+    pTask = OsalPort_getTaskEntry(taskId);
+    if(pTask == NULL)
+    {
+        return NULL;
+    }
+
     // Hold off interrupts
     key = OsalPort_enterCS();
 
-    /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    // A response in the task's response slot needs no queue search
+    pHdr = (OsalPort_MsgHdr*) pTask->pRspSlot;
+    if ((pHdr != NULL) && (((OsalPort_EventHdr *)pHdr)->event == event))
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+        pTask->pRspSlot = NULL;
+        OsalPort_leaveCS(key);
+        return (OsalPort_EventHdr *)pHdr;
+    }
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
-            {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
+    pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
 
-                if(pPrev == NULL)
-                {
-                  OsalPort_MSG_Q_HEAD(&taskTbl[taskIdx].qHandle) = OsalPort_MSG_NEXT(pHdr);
-                }
-                else
-                {
-                  OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
-                }
-                OsalPort_MSG_NEXT( pHdr ) = NULL;
-                OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
-                break;
-              }
+    // Look through the tasks queue for a message that matches the task_id and event parameters.
+    while (pHdr != NULL)
+    {
+      if (((OsalPort_EventHdr *)pHdr)->event == event)
+      {
 
-              pPrev = pHdr;
-              pHdr = OsalPort_MSG_NEXT(pHdr);
-            }
-            break;
+        if(pPrev == NULL)
+        {
+          OsalPort_MSG_Q_HEAD(&pTask->qHandle) = OsalPort_MSG_NEXT(pHdr);
+        }
+        else
+        {
+          OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
         }
+        if(pTask->qTail == pHdr)
+        {
+          pTask->qTail = pPrev;
+        }
+        OsalPort_MSG_NEXT( pHdr ) = NULL;
+        OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
+        break;
+      }
+
+      pPrev = pHdr;
+      pHdr = OsalPort_MSG_NEXT(pHdr);
     }
 
     OsalPort_leaveCS(key);
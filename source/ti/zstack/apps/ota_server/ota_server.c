@@ -126,24 +126,125 @@
  */
 #define APP_TITLE "OTA Server"
 
+// Hash bucket of a client short address
+#define OTA_SERVER_CLIENT_BUCKET(a) ( ( (a) ^ ( (a) >> 8 ) ) & ( OTA_SERVER_CLIENT_BUCKETS - 1 ) )
+
 /*********************************************************************
  * CONSTANTS
  */
 // Set this value to enable rate limiting for OTA Client devices
 #define OTA_CLIENT_MIN_BLOCK_PERIOD 0
 
-// Defines the max number of OTA clients performing an upgrade simultaneously
-#define SEQ_NUM_ENTRY_MAX 3
+// Defines the max number of OTA clients performing an upgrade simultaneously.
+// Must be below OTA_SERVER_CLIENT_NONE.
+#if !defined OTA_SERVER_CLIENT_MAX
+#define OTA_SERVER_CLIENT_MAX 16
+#endif
+
+// Hash buckets of the client session table, must be a power of two
+#define OTA_SERVER_CLIENT_BUCKETS 16
+
+// Time in ms without a request after which a client session is dropped
+#if !defined OTA_SERVER_CLIENT_TIMEOUT
+#define OTA_SERVER_CLIENT_TIMEOUT 60000
+#endif
+
+// End of a client hash chain
+#define OTA_SERVER_CLIENT_NONE 0xFF
+
+// RAM budget, in bytes, for image blocks cached on the server. Must hold at
+// least one otaBlockCacheEntry_t.
+#if !defined OTA_SERVER_BLOCK_CACHE_SIZE
+#define OTA_SERVER_BLOCK_CACHE_SIZE 1024
+#endif
+
+// Number of blocks read from the host ahead of each client request
+#if !defined OTA_SERVER_BLOCK_READ_AHEAD
+#define OTA_SERVER_BLOCK_READ_AHEAD 4
+#endif
+
+// Time in ms after which an unanswered host file read is given up
+#define OTA_SERVER_BLOCK_READ_TIMEOUT 2000
+
+// Host file reads tracked at once, shared fairly by the active clients
+#if !defined OTA_SERVER_BLOCK_READS_MAX
+#define OTA_SERVER_BLOCK_READS_MAX 16
+#endif
+
+// Time in ms a page transfer may wait for its next block before it is
+// dropped. The client then times out and resumes with a new request.
+#define OTA_SERVER_PAGE_TIMEOUT 3000
+
+// Period in ms at which a page transfer retries while its block is read
+#define OTA_SERVER_PAGE_RETRY 50
 
 /*********************************************************************
  * TYPEDEFS
  */
 
+// OTA client known to the server
 typedef struct
 {
-  uint8_t transSeqNum;
-  uint16_t      shortAddr;
-} otaSeqNumEntry_t;
+  zclOTA_FileID_t fileId;
+  uint32_t        offset;               // Last file offset requested
+  uint32_t        lastActivity;         // Time of the last request
+  uint32_t        rateStart;
+  uint16_t        rateCount;
+  uint16_t        blocksPerSec;         // Blocks served over the last measured second
+  uint16_t        shortAddr;
+  uint8_t         transSeqNum;          // Sequence number for the pending host response
+  uint8_t         seqPending;
+  uint8_t         next;                 // Next session in the hash chain
+  uint8_t         inUse;
+} otaClientSession_t;
+
+// Image block held in the server block cache
+typedef struct
+{
+  zclOTA_FileID_t fileId;
+  uint32_t        offset;
+  uint32_t        lastUsed;             // LRU stamp
+  uint8_t         dataSize;             // 0 when the entry is free
+  uint8_t         data[OTA_MAX_MTU];
+} otaBlockCacheEntry_t;
+
+#define OTA_SERVER_BLOCK_CACHE_ENTRIES (OTA_SERVER_BLOCK_CACHE_SIZE / sizeof(otaBlockCacheEntry_t))
+
+// File read sent to the host and not answered yet
+typedef struct
+{
+  zclOTA_FileID_t fileId;
+  uint32_t        offset;
+  uint32_t        reqTime;
+  uint16_t        owner;                // Client the read was made for
+  uint8_t         inUse;
+} otaBlockRead_t;
+
+// Client waiting for a block that is already being read from the host
+typedef struct
+{
+  afAddrType_t    addr;
+  zclOTA_FileID_t fileId;
+  uint32_t        offset;
+  uint32_t        reqTime;
+  uint8_t         len;
+  uint8_t         transSeqNum;
+  uint8_t         inUse;
+} otaBlockWaiter_t;
+
+// Image Page Request being streamed to a client
+typedef struct
+{
+  afAddrType_t    addr;
+  zclOTA_FileID_t fileId;
+  uint32_t        nextOffset;           // Offset of the next block to send
+  uint32_t        endOffset;            // End of the requested page
+  uint32_t        lastTxTime;
+  uint16_t        responseSpacing;      // ms between Image Block Responses
+  uint8_t         maxDataSize;
+  uint8_t         transSeqNum;
+  uint8_t         inUse;
+} otaPageSession_t;
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -170,6 +271,8 @@ static Clock_Struct EndDeviceRejoinClkStruct;
 #endif
 static Clock_Handle OtaServerNotifyClkHandle;
 static Clock_Struct OtaServerNotifyClkStruct;
+static Clock_Handle OtaServerPageTxClkHandle;
+static Clock_Struct OtaServerPageTxClkStruct;
 
 // Passed in function pointers to the NV driver
 static NVINTF_nvFuncts_t *pfnZdlNV = NULL;
@@ -182,8 +285,25 @@ static Button_Handle gLeftButtonHandle;
 
 static uint8_t otaServer_MinBlockReqDelay = OTA_CLIENT_MIN_BLOCK_PERIOD;
 
-// Table used to match transaction sequence numbers in ota responses
-static otaSeqNumEntry_t SeqNumEntryTable[SEQ_NUM_ENTRY_MAX];
+// Client sessions, hashed by short address. Also used to match transaction
+// sequence numbers in ota responses.
+static otaClientSession_t otaServer_Clients[OTA_SERVER_CLIENT_MAX];
+static uint8_t otaServer_ClientBuckets[OTA_SERVER_CLIENT_BUCKETS];
+static uint8_t otaServer_ClientCount;
+
+// Image block cache, host reads in flight and clients waiting on them
+static otaBlockCacheEntry_t otaServer_BlockCache[OTA_SERVER_BLOCK_CACHE_ENTRIES];
+static uint32_t otaServer_BlockCacheClock;
+static otaBlockRead_t otaServer_BlockReads[OTA_SERVER_BLOCK_READS_MAX];
+static otaBlockWaiter_t otaServer_BlockWaiters[OTA_SERVER_CLIENT_MAX];
+
+// Image Page Requests being served, one per client
+static otaPageSession_t otaServer_PageSessions[OTA_SERVER_CLIENT_MAX];
+static uint8_t otaServer_PageTxStart;
+
+static otaServerBlockStats_t otaServer_BlockStats;
+static uint32_t otaServer_BlockRateStart;
+static uint32_t otaServer_BlockRateCount;
 
 static zclOTA_QueryImageRspParams_t queryResponse;             // Global variable for sent query response
 
@@ -207,6 +327,7 @@ static void otaServer_initializeClocks(void);
 static void otaServer_processEndDeviceRejoinTimeoutCallback(UArg a0);
 #endif
 static void otaServer_sendNotifylTimeoutCallback(UArg a0);
+static void otaServer_pageTxTimeoutCallback(UArg a0);
 static void otaServer_changeKeyCallback(Button_Handle _btn, Button_EventMask _buttonEvents);
 static void otaServer_processKey(Button_Handle keysPressed);
 static void otaServer_Init( void );
@@ -260,8 +381,33 @@ static ZStatus_t otaServer_ProcessQueryNextImageReq ( zclIncoming_t *pInMsg );
 static ZStatus_t otaServer_ProcessImagePageReq ( zclIncoming_t *pInMsg );
 static ZStatus_t otaServer_ProcessUpgradeEndReq ( zclIncoming_t *pInMsg );
 
-static void otaServer_AddSeqNumEntry(uint8_t transSeqNum, uint16_t shortAddr);
+static uint8_t otaServer_AddSeqNumEntry(uint8_t transSeqNum, uint16_t shortAddr);
 static uint16_t otaServer_FindSeqNumEntry(uint16_t shortAddr);
+
+static void otaServer_ClientInit( void );
+static otaClientSession_t *otaServer_ClientFind( uint16_t shortAddr );
+static otaClientSession_t *otaServer_ClientGet( uint16_t shortAddr );
+static void otaServer_ClientRemove( uint16_t shortAddr );
+static void otaServer_ClientServed( uint16_t shortAddr, uint32_t now );
+static void otaServer_ProcessSysApp_StatsReq(uint8_t *pData);
+
+static otaBlockCacheEntry_t *otaServer_BlockCacheFind( zclOTA_FileID_t *pFileId, uint32_t offset );
+static otaBlockCacheEntry_t *otaServer_BlockCacheStore( zclOTA_FileID_t *pFileId, uint32_t offset,
+                                                        uint8_t len, uint8_t *pData );
+static otaBlockRead_t *otaServer_BlockReadFind( zclOTA_FileID_t *pFileId, uint32_t offset );
+static uint8_t otaServer_BlockReadReq( afAddrType_t *pAddr, uint16_t owner, zclOTA_FileID_t *pFileId,
+                                       uint8_t len, uint32_t offset );
+static void otaServer_BlockReadAhead( uint16_t owner, zclOTA_FileID_t *pFileId,
+                                      uint32_t offset, uint8_t len );
+static uint8_t otaServer_AddBlockWaiter( afAddrType_t *pAddr, zclOTA_FileID_t *pFileId,
+                                         uint32_t offset, uint8_t len, uint8_t transSeqNum );
+static void otaServer_ServeBlockWaiters( otaBlockCacheEntry_t *pBlock );
+static void otaServer_SendCachedBlock( afAddrType_t *pAddr, otaBlockCacheEntry_t *pBlock,
+                                       uint8_t len, uint8_t transSeqNum );
+static void otaServer_BlockServed( uint16_t shortAddr );
+static void otaServer_PageAbort( afAddrType_t *pAddr );
+static uint8_t otaServer_PageTxNext( otaPageSession_t *pSession );
+static void otaServer_PageTxProcess( void );
 static void otaServer_ServerHandleFileSysCb ( uint8_t* pMSGpkt );
 
 /*********************************************************************
@@ -429,11 +575,8 @@ static void otaServer_Init( void )
                        ZCL_CLUSTER_ID_OTA,
                        otaServer_HdlIncoming );
 
-  // Initialize SeqNumEntryTable
-  for(uint8_t i = 0; i < SEQ_NUM_ENTRY_MAX; i++)
-  {
-    memset(&SeqNumEntryTable[i], 0xFF, sizeof (otaSeqNumEntry_t));
-  }
+  // Initialize the client session table
+  otaServer_ClientInit();
 
   //Write the bdb initialization parameters
   otaServer_initParameters();
@@ -509,6 +652,12 @@ static void otaServer_initializeClocks(void)
     otaServer_sendNotifylTimeoutCallback,
     OTA_SEND_NOTIFY_TIMEOUT,
     0, false, 0);
+
+    OtaServerPageTxClkHandle = UtilTimer_construct(
+    &OtaServerPageTxClkStruct,
+    otaServer_pageTxTimeoutCallback,
+    OTA_SERVER_PAGE_RETRY,
+    0, false, 0);
 }
 
 #if ZG_BUILD_ENDDEVICE_TYPE
@@ -551,6 +700,25 @@ static void otaServer_sendNotifylTimeoutCallback(UArg a0)
     Semaphore_post(appSemHandle);
 }
 
+/*******************************************************************************
+ * @fn      otaServer_pageTxTimeoutCallback
+ *
+ * @brief   Timeout handler function for the Image Page transmit scheduler
+ *
+ * @param   a0 - ignored
+ *
+ * @return  none
+ */
+static void otaServer_pageTxTimeoutCallback(UArg a0)
+{
+    (void)a0; // Parameter is not used
+
+    appServiceTaskEvents |= SAMPLEAPP_OTA_PAGE_TX_EVT;
+
+    // Wake up the application thread when it waits for clock event
+    Semaphore_post(appSemHandle);
+}
+
 /*******************************************************************************
  * @fn      otaServer_process_loop
  *
@@ -612,6 +780,12 @@ static void otaServer_process_loop(void)
               UtilTimer_start(&OtaServerNotifyClkStruct);
               appServiceTaskEvents &= ~SAMPLEAPP_OTA_SERVER_NOTIFY_EVT;
             }
+
+            if ( appServiceTaskEvents & SAMPLEAPP_OTA_PAGE_TX_EVT )
+            {
+              appServiceTaskEvents &= ~SAMPLEAPP_OTA_PAGE_TX_EVT;
+              otaServer_PageTxProcess();
+            }
         }
     }
 }
@@ -960,6 +1134,9 @@ void otaServer_ProcSysAppMsg(zstack_sysAppMsg_t *pMsg)
   case OTA_APP_JOIN_REQ:
     otaServer_ProcessSysApp_JoinReq(pMsg->pAppData);
     break;
+  case OTA_APP_STATS_REQ:
+    otaServer_ProcessSysApp_StatsReq(pMsg->pAppData);
+    break;
   case OTA_APP_LEAVE_REQ:
     // Simulate a leave by rebooting the dongle
     //SystemReset();
@@ -1115,6 +1292,69 @@ void otaServer_ProcessSysApp_JoinReq(uint8_t *pData)
   }
 }
 
+/*********************************************************************
+ * @fn      otaServer_ProcessSysApp_StatsReq
+ *
+ * @brief   Reports the block cache and client session counters to the
+ *          console, followed by the rate and progress of up to
+ *          OTA_APP_STATS_CLIENTS_MAX clients.
+ *
+ * @param   pData - The data from the server, clear flag.
+ *
+ * @return  none
+ */
+static void otaServer_ProcessSysApp_StatsReq(uint8_t *pData)
+{
+  uint8_t buffer[OTA_APP_STATS_IND_LEN + OTA_APP_STATS_CLIENT_LEN * OTA_APP_STATS_CLIENTS_MAX];
+  uint8_t *pBuf = buffer;
+  uint8_t *pCount;
+  otaServerBlockStats_t stats;
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint16_t rate;
+  uint8_t i;
+
+  otaServer_GetBlockStats(&stats, pData[0]);
+
+  *pBuf++ = OTA_SERVER_ENDPOINT;
+  *pBuf++ = OTA_APP_STATS_IND;
+
+  pBuf = OsalPort_bufferUint32(pBuf, stats.blockReqs);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.pageReqs);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.cacheHits);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.hostReads);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.readAheads);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.blocksServed);
+  *pBuf++ = LO_UINT16(stats.blocksPerSec);
+  *pBuf++ = HI_UINT16(stats.blocksPerSec);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.clientsRejected);
+  pBuf = OsalPort_bufferUint32(pBuf, stats.clientsExpired);
+  *pBuf++ = stats.activeClients;
+
+  pCount = pBuf++;
+  *pCount = 0;
+
+  for(i = 0; (i < OTA_SERVER_CLIENT_MAX) && (*pCount < OTA_APP_STATS_CLIENTS_MAX); i++)
+  {
+    otaClientSession_t *pClient = &otaServer_Clients[i];
+
+    if(pClient->inUse)
+    {
+      // No block served for over two seconds, the rate has dropped to 0
+      rate = ((now - pClient->rateStart) >= 2000) ? 0 : pClient->blocksPerSec;
+
+      *pBuf++ = LO_UINT16(pClient->shortAddr);
+      *pBuf++ = HI_UINT16(pClient->shortAddr);
+      pBuf = OsalPort_bufferUint32(pBuf, pClient->offset);
+      *pBuf++ = LO_UINT16(rate);
+      *pBuf++ = HI_UINT16(rate);
+      (*pCount)++;
+    }
+  }
+
+  // Send the indication
+  MT_BuildAndSendZToolResponse(MT_RPC_SYS_APP, MT_APP_MSG, (uint8_t)(pBuf - buffer), buffer);
+}
+
 /*********************************************************************
  * @fn      otaServer_Send_DeviceInd
  *
@@ -1618,213 +1858,820 @@ static void otaServer_processKey(Button_Handle keysPressed)
  /******************************************************************************
  * @fn      otaServer_AddSeqNumEntry
  *
- * @brief   Add an entry to SeqNumEntryTable
+ * @brief   Keep the sequence number of a request in the client session so
+ *          that the response to the host request carries it
  *
  * @param   transSeqNum
  * @param   shortAddr
  *
- * @return  none
+ * @return  ZSuccess, or ZFailure if the client session table is full
  */
-static void otaServer_AddSeqNumEntry(uint8_t transSeqNum, uint16_t shortAddr)
+static uint8_t otaServer_AddSeqNumEntry(uint8_t transSeqNum, uint16_t shortAddr)
 {
-  uint16_t i;
-  for(i = 0; i < SEQ_NUM_ENTRY_MAX; i++)
+  otaClientSession_t *pClient = otaServer_ClientGet( shortAddr );
+
+  if ( pClient == NULL )
   {
-    if((SeqNumEntryTable[i].shortAddr == 0xFFFF && SeqNumEntryTable[i].transSeqNum == 0xFF) ||
-      (SeqNumEntryTable[i].shortAddr == shortAddr))
-    {
-      SeqNumEntryTable[i].shortAddr = shortAddr;
-      SeqNumEntryTable[i].transSeqNum = transSeqNum;
-      break;
-    }
+    return ZFailure;
   }
+
+  pClient->transSeqNum = transSeqNum;
+  pClient->seqPending = TRUE;
+
+  return ZSuccess;
 }
 
 
  /******************************************************************************
  * @fn      otaServer_FindSeqNumEntry
  *
- * @brief   Find an entry to SeqNumEntryTable with matching shortAddr
+ * @brief   Take the pending sequence number of a client
  *
- * @param   transSeqNum - Transaction sequence number
  * @param   shortAddr - Short address
  *
  * @return  uint16_t
  */
 static uint16_t otaServer_FindSeqNumEntry(uint16_t shortAddr)
 {
-  uint16_t i;
-  uint8_t transSeqNum;
-  bool found = FALSE;
-  for(i = 0; i < SEQ_NUM_ENTRY_MAX; i++)
+  otaClientSession_t *pClient = otaServer_ClientFind( shortAddr );
+
+  if ( ( pClient != NULL ) && pClient->seqPending )
   {
-    if(SeqNumEntryTable[i].shortAddr == shortAddr)
-    {
-      transSeqNum = SeqNumEntryTable[i].transSeqNum;
-      SeqNumEntryTable[i].shortAddr = 0xFFFF;
-      SeqNumEntryTable[i].transSeqNum = 0xFF;
-      found = TRUE;
-      break;
-    }
+    pClient->seqPending = FALSE;
+    return pClient->transSeqNum;
   }
 
-  if(found){
-    return transSeqNum;
-  }
   // Return internal frame counter if no match is found
   return zclOTA_getSeqNo();
 }
 
-/******************************************************************************
- * @fn      otaServer_HdlIncoming
+ /******************************************************************************
+ * @fn      otaServer_ClientInit
  *
- * @brief   Callback from ZCL to process incoming Commands specific
- *          to this cluster library or Profile commands for attributes
- *          that aren't in the attribute list
+ * @brief   Empty the client session table
  *
- * @param   pInMsg - pointer to the incoming message
+ * @param   none
  *
- * @return  ZStatus_t
+ * @return  none
  */
-static ZStatus_t otaServer_HdlIncoming ( zclIncoming_t *pInMsg )
+static void otaServer_ClientInit( void )
 {
-  ZStatus_t stat = ZSuccess;
+  memset( otaServer_Clients, 0, sizeof ( otaServer_Clients ) );
+  memset( otaServer_ClientBuckets, OTA_SERVER_CLIENT_NONE, sizeof ( otaServer_ClientBuckets ) );
+  otaServer_ClientCount = 0;
+}
 
-  if ( zcl_ClusterCmd ( pInMsg->hdr.fc.type ) )
+ /******************************************************************************
+ * @fn      otaServer_ClientFind
+ *
+ * @brief   Look up the session of a client
+ *
+ * @param   shortAddr - Client short address
+ *
+ * @return  The session, or NULL if the client has none
+ */
+static otaClientSession_t *otaServer_ClientFind( uint16_t shortAddr )
+{
+  uint8_t idx;
+
+  idx = otaServer_ClientBuckets[OTA_SERVER_CLIENT_BUCKET( shortAddr )];
+
+  while ( idx != OTA_SERVER_CLIENT_NONE )
   {
-    // Is this a manufacturer specific command?
-    if ( pInMsg->hdr.fc.manuSpecific == 0 )
+    if ( otaServer_Clients[idx].shortAddr == shortAddr )
     {
-      // Is command for server?
-      if ( zcl_ServerCmd ( pInMsg->hdr.fc.direction ) )
+      return &otaServer_Clients[idx];
+    }
+
+    idx = otaServer_Clients[idx].next;
+  }
+
+  return NULL;
+}
+
+ /******************************************************************************
+ * @fn      otaServer_ClientGet
+ *
+ * @brief   Get the session of a client, opening one if needed, and mark
+ *          the client active. Sessions idle for OTA_SERVER_CLIENT_TIMEOUT
+ *          are dropped to make room.
+ *
+ * @param   shortAddr - Client short address
+ *
+ * @return  The session, or NULL if the table is full
+ */
+static otaClientSession_t *otaServer_ClientGet( uint16_t shortAddr )
+{
+  otaClientSession_t *pClient = otaServer_ClientFind( shortAddr );
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint8_t bucket;
+  uint8_t i;
+
+  if ( pClient == NULL )
+  {
+    for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+    {
+      if ( otaServer_Clients[i].inUse &&
+           ( ( now - otaServer_Clients[i].lastActivity ) >= OTA_SERVER_CLIENT_TIMEOUT ) )
       {
-        stat = otaServer_ServerHdlIncoming ( pInMsg );
+        otaServer_BlockStats.clientsExpired++;
+        otaServer_ClientRemove( otaServer_Clients[i].shortAddr );
       }
-      else // Else command is for client
+
+      if ( ( pClient == NULL ) && !otaServer_Clients[i].inUse )
       {
-        stat = ZCL_STATUS_UNSUP_CLUSTER_COMMAND;
+        pClient = &otaServer_Clients[i];
       }
     }
-    else
+
+    if ( pClient == NULL )
     {
-      // We don't support any manufacturer specific command.
-      stat = ZCL_STATUS_UNSUP_MANU_CLUSTER_COMMAND;
+      otaServer_BlockStats.clientsRejected++;
+      return NULL;
     }
-  }
-  else
-  {
-    // Handle all the normal (Read, Write...) commands -- should never get here
-    stat = ZFailure;
+
+    bucket = OTA_SERVER_CLIENT_BUCKET( shortAddr );
+
+    memset( pClient, 0, sizeof ( otaClientSession_t ) );
+    pClient->shortAddr = shortAddr;
+    pClient->rateStart = now;
+    pClient->next = otaServer_ClientBuckets[bucket];
+    pClient->inUse = TRUE;
+    otaServer_ClientBuckets[bucket] = (uint8_t)( pClient - otaServer_Clients );
+    otaServer_ClientCount++;
   }
 
-  return ( stat );
+  pClient->lastActivity = now;
+
+  return pClient;
 }
 
-/******************************************************************************
- * @fn      otaServer_ServerHdlIncoming
+ /******************************************************************************
+ * @fn      otaServer_ClientRemove
  *
- * @brief   Handle incoming server commands.
+ * @brief   Close the session of a client
  *
- * @param   pInMsg - pointer to the incoming message
+ * @param   shortAddr - Client short address
  *
- * @return  ZStatus_t
+ * @return  none
  */
-ZStatus_t otaServer_ServerHdlIncoming ( zclIncoming_t *pInMsg )
+static void otaServer_ClientRemove( uint16_t shortAddr )
 {
-  switch ( pInMsg->hdr.commandID )
+  uint8_t *pIdx;
+
+  pIdx = &otaServer_ClientBuckets[OTA_SERVER_CLIENT_BUCKET( shortAddr )];
+
+  while ( *pIdx != OTA_SERVER_CLIENT_NONE )
   {
-    case COMMAND_OTA_UPGRADE_QUERY_NEXT_IMAGE_REQUEST:
-      return otaServer_ProcessQueryNextImageReq ( pInMsg );
+    otaClientSession_t *pClient = &otaServer_Clients[*pIdx];
 
-    case COMMAND_OTA_UPGRADE_IMAGE_BLOCK_REQUEST:
-      return otaServer_ProcessImageBlockReq ( pInMsg );
+    if ( pClient->shortAddr == shortAddr )
+    {
+      *pIdx = pClient->next;
+      pClient->inUse = FALSE;
+      otaServer_ClientCount--;
+      break;
+    }
 
-    case COMMAND_OTA_UPGRADE_IMAGE_PAGE_REQUEST:
-      return otaServer_ProcessImagePageReq ( pInMsg );
+    pIdx = &pClient->next;
+  }
+}
 
-    case COMMAND_OTA_UPGRADE_UPGRADE_END_REQUEST:
-      return otaServer_ProcessUpgradeEndReq ( pInMsg );
+ /******************************************************************************
+ * @fn      otaServer_ClientServed
+ *
+ * @brief   Update the blocks per second rate of a client. A client being
+ *          served a page is active even without sending requests.
+ *
+ * @param   shortAddr - Client short address
+ * @param   now - Current time
+ *
+ * @return  none
+ */
+static void otaServer_ClientServed( uint16_t shortAddr, uint32_t now )
+{
+  otaClientSession_t *pClient = otaServer_ClientFind( shortAddr );
+  uint32_t elapsed;
 
-    case COMMAND_OTA_UPGRADE_QUERY_DEVICE_SPECIFIC_FILE_REQUEST:
-      return otaServer_ProcessQuerySpecificFileReq ( pInMsg );
+  if ( pClient != NULL )
+  {
+    elapsed = now - pClient->rateStart;
+    pClient->rateCount++;
+    pClient->lastActivity = now;
 
-    default:
-      return ZFailure;
+    if ( elapsed >= 1000 )
+    {
+      pClient->blocksPerSec = (uint16_t)( ( (uint32_t)pClient->rateCount * 1000 ) / elapsed );
+      pClient->rateStart = now;
+      pClient->rateCount = 0;
+    }
   }
 }
 
+ /******************************************************************************
+ * @fn      otaServer_BlockCacheFind
+ *
+ * @brief   Find a cached image block
+ *
+ * @param   pFileId - The ID of the OTA File
+ * @param   offset - File offset of the block
+ *
+ * @return  pointer to the cache entry, NULL if not cached
+ */
+static otaBlockCacheEntry_t *otaServer_BlockCacheFind( zclOTA_FileID_t *pFileId, uint32_t offset )
+{
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_BLOCK_CACHE_ENTRIES; i++ )
+  {
+    if ( ( otaServer_BlockCache[i].dataSize != 0 ) &&
+         ( otaServer_BlockCache[i].offset == offset ) &&
+         OsalPort_memcmp( &otaServer_BlockCache[i].fileId, pFileId, sizeof ( zclOTA_FileID_t ) ) )
+    {
+      return &otaServer_BlockCache[i];
+    }
+  }
 
-/******************************************************************************
- * @fn      otaServer_Srv_ImageBlockReq
+  return NULL;
+}
+
+ /******************************************************************************
+ * @fn      otaServer_BlockCacheStore
  *
- * @brief   Handle an Image Block Request.
+ * @brief   Store an image block read from the host, replacing the least
+ *          recently used entry when the cache is full
  *
- * @param   pSrcAddr - The source of the message
- *          pParam - message parameters
- *          transSeqNum - Transaction Sequence Number
+ * @param   pFileId - The ID of the OTA File
+ * @param   offset - File offset of the block
+ * @param   len - Length of the block
+ * @param   pData - Block data
  *
- * @return  ZStatus_t
+ * @return  pointer to the cache entry, NULL if the block was not stored
  */
-ZStatus_t otaServer_Srv_ImageBlockReq ( afAddrType_t *pSrcAddr, zclOTA_ImageBlockReqParams_t *pParam,
-    uint8_t transSeqNum )
+static otaBlockCacheEntry_t *otaServer_BlockCacheStore( zclOTA_FileID_t *pFileId, uint32_t offset,
+                                                        uint8_t len, uint8_t *pData )
 {
-  uint8_t status = ZFailure;
+  otaBlockCacheEntry_t *pBlock;
+  uint16_t i;
 
-  if ( ( pParam != NULL ) && (pParam->fileId.version != queryResponse.fileId.version) )
+  if ( ( len == 0 ) || ( len > OTA_MAX_MTU ) )
   {
-    status = ZCL_STATUS_NO_IMAGE_AVAILABLE;
+    return NULL;
   }
-  else
+
+  pBlock = otaServer_BlockCacheFind( pFileId, offset );
+
+  if ( pBlock == NULL )
   {
-    if ( zclOTA_Permit && ( pParam != NULL ) )
-    {
-      uint8_t len = pParam->maxDataSize;
+    pBlock = &otaServer_BlockCache[0];
 
-      if ( len > OTA_MAX_MTU )
+    for ( i = 0; i < OTA_SERVER_BLOCK_CACHE_ENTRIES; i++ )
+    {
+      if ( otaServer_BlockCache[i].dataSize == 0 )
       {
-        len = OTA_MAX_MTU;
+        pBlock = &otaServer_BlockCache[i];
+        break;
       }
 
-      // check if client supports rate limiting feature, and if client rate needs to be set
-      if ( ( ( pParam->fieldControl & OTA_BLOCK_FC_REQ_DELAY_PRESENT ) != 0 ) &&
-           ( pParam->blockReqDelay != otaServer_MinBlockReqDelay ) )
+      if ( otaServer_BlockCache[i].lastUsed < pBlock->lastUsed )
       {
-        zclOTA_ImageBlockRspParams_t blockRsp;
-
-        // Fill in the response parameters
-        blockRsp.status = ZOtaWaitForData;
-        OsalPort_memcpy ( &blockRsp.rsp.success.fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
-        blockRsp.rsp.wait.currentTime = 0;
-        blockRsp.rsp.wait.requestTime = 0;
-        blockRsp.rsp.wait.blockReqDelay = otaServer_MinBlockReqDelay;
-
-        // Send a wait response with updated rate limit timing
-        zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &blockRsp, transSeqNum );
+        pBlock = &otaServer_BlockCache[i];
       }
-      else
-      {
-        // Read the data from the OTA Console
-        status = MT_OtaFileReadReq ( pSrcAddr, &pParam->fileId, len, pParam->fileOffset );
+    }
+  }
 
-        // Send a wait response to the client
-        if ( status != ZSuccess )
-        {
-          zclOTA_ImageBlockRspParams_t blockRsp;
+  OsalPort_memcpy( &pBlock->fileId, pFileId, sizeof ( zclOTA_FileID_t ) );
+  pBlock->offset = offset;
+  pBlock->lastUsed = ++otaServer_BlockCacheClock;
+  pBlock->dataSize = len;
+  OsalPort_memcpy( pBlock->data, pData, len );
 
-          // Fill in the response parameters
-          blockRsp.status = ZOtaWaitForData;
-          OsalPort_memcpy ( &blockRsp.rsp.success.fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
-          blockRsp.rsp.wait.currentTime = 0;
-          blockRsp.rsp.wait.requestTime = OTA_SEND_BLOCK_WAIT;
-          blockRsp.rsp.wait.blockReqDelay = otaServer_MinBlockReqDelay;
+  return pBlock;
+}
 
-          // Send the block to the peer
-          zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &blockRsp, transSeqNum );
-        }
+ /******************************************************************************
+ * @fn      otaServer_BlockReadFind
+ *
+ * @brief   Find an unexpired host read of an image block
+ *
+ * @param   pFileId - The ID of the OTA File
+ * @param   offset - File offset of the block
+ *
+ * @return  pointer to the read entry, NULL if none
+ */
+static otaBlockRead_t *otaServer_BlockReadFind( zclOTA_FileID_t *pFileId, uint32_t offset )
+{
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_BLOCK_READS_MAX; i++ )
+  {
+    if ( otaServer_BlockReads[i].inUse &&
+         ( ( now - otaServer_BlockReads[i].reqTime ) < OTA_SERVER_BLOCK_READ_TIMEOUT ) &&
+         ( otaServer_BlockReads[i].offset == offset ) &&
+         OsalPort_memcmp( &otaServer_BlockReads[i].fileId, pFileId, sizeof ( zclOTA_FileID_t ) ) )
+    {
+      return &otaServer_BlockReads[i];
+    }
+  }
+
+  return NULL;
+}
+
+ /******************************************************************************
+ * @fn      otaServer_BlockReadReq
+ *
+ * @brief   Read an image block from the host and track the read so that
+ *          other requests for the same block wait for it. Read-ahead
+ *          requests (pAddr->addrMode == afAddrNotPresent) are only sent
+ *          when they can be tracked and the owner has not used up its
+ *          share of the tracked reads, so that one fast client cannot
+ *          starve the others.
+ *
+ * @param   pAddr - Client address echoed back by the host
+ * @param   owner - Short address of the client the read is made for
+ * @param   pFileId - The ID of the OTA File
+ * @param   len - Length to read
+ * @param   offset - File offset to read from
+ *
+ * @return  ZStatus_t
+ */
+static uint8_t otaServer_BlockReadReq( afAddrType_t *pAddr, uint16_t owner, zclOTA_FileID_t *pFileId,
+                                       uint8_t len, uint32_t offset )
+{
+  otaBlockRead_t *pRead = NULL;
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint16_t share;
+  uint16_t owned = 0;
+  uint8_t status;
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_BLOCK_READS_MAX; i++ )
+  {
+    if ( !otaServer_BlockReads[i].inUse ||
+         ( ( now - otaServer_BlockReads[i].reqTime ) >= OTA_SERVER_BLOCK_READ_TIMEOUT ) )
+    {
+      if ( pRead == NULL )
+      {
+        pRead = &otaServer_BlockReads[i];
+      }
+    }
+    else if ( otaServer_BlockReads[i].owner == owner )
+    {
+      owned++;
+    }
+  }
+
+  if ( pAddr->addrMode == afAddrNotPresent )
+  {
+    share = OTA_SERVER_BLOCK_READS_MAX;
+    if ( otaServer_ClientCount > 1 )
+    {
+      share /= otaServer_ClientCount;
+    }
+    if ( share == 0 )
+    {
+      share = 1;
+    }
+
+    if ( ( pRead == NULL ) || ( owned >= share ) )
+    {
+      return ZFailure;
+    }
+  }
+
+  status = MT_OtaFileReadReq ( pAddr, pFileId, len, offset );
+
+  if ( status == ZSuccess )
+  {
+    otaServer_BlockStats.hostReads++;
+
+    if ( pRead != NULL )
+    {
+      OsalPort_memcpy( &pRead->fileId, pFileId, sizeof ( zclOTA_FileID_t ) );
+      pRead->offset = offset;
+      pRead->reqTime = now;
+      pRead->owner = owner;
+      pRead->inUse = TRUE;
+    }
+  }
+
+  return status;
+}
+
+ /******************************************************************************
+ * @fn      otaServer_BlockReadAhead
+ *
+ * @brief   Read the next blocks of a client from the host so they are
+ *          cached by the time the client asks for them
+ *
+ * @param   owner - Short address of the client
+ * @param   pFileId - The ID of the OTA File
+ * @param   offset - File offset of the first block to read
+ * @param   len - Block length used by the client
+ *
+ * @return  none
+ */
+static void otaServer_BlockReadAhead( uint16_t owner, zclOTA_FileID_t *pFileId,
+                                      uint32_t offset, uint8_t len )
+{
+  afAddrType_t addr;
+  uint8_t i;
+
+  // Responses to this address are cached only, see otaServer_ProcessFileReadRsp
+  memset( &addr, 0, sizeof ( afAddrType_t ) );
+  addr.addrMode = afAddrNotPresent;
+  addr.endPoint = ZCL_OTA_ENDPOINT;
+
+  for ( i = 0; i < OTA_SERVER_BLOCK_READ_AHEAD; i++, offset += len )
+  {
+    if ( ( queryResponse.imageSize != 0 ) && ( offset >= queryResponse.imageSize ) )
+    {
+      break;
+    }
+
+    if ( ( otaServer_BlockCacheFind( pFileId, offset ) == NULL ) &&
+         ( otaServer_BlockReadFind( pFileId, offset ) == NULL ) )
+    {
+      if ( otaServer_BlockReadReq( &addr, owner, pFileId, len, offset ) != ZSuccess )
+      {
+        break;
+      }
+
+      otaServer_BlockStats.readAheads++;
+    }
+  }
+}
+
+ /******************************************************************************
+ * @fn      otaServer_AddBlockWaiter
+ *
+ * @brief   Queue a client for a block that is being read from the host
+ *
+ * @param   pAddr - Client address
+ * @param   pFileId - The ID of the OTA File
+ * @param   offset - File offset of the block
+ * @param   len - Maximum data size requested by the client
+ * @param   transSeqNum - Transaction sequence number of the request
+ *
+ * @return  ZSuccess, or ZFailure if no waiter slot is free
+ */
+static uint8_t otaServer_AddBlockWaiter( afAddrType_t *pAddr, zclOTA_FileID_t *pFileId,
+                                         uint32_t offset, uint8_t len, uint8_t transSeqNum )
+{
+  otaBlockWaiter_t *pWaiter = NULL;
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+  {
+    // A client only waits for one block at a time
+    if ( otaServer_BlockWaiters[i].inUse &&
+         ( otaServer_BlockWaiters[i].addr.addr.shortAddr == pAddr->addr.shortAddr ) )
+    {
+      pWaiter = &otaServer_BlockWaiters[i];
+      break;
+    }
+
+    if ( ( pWaiter == NULL ) &&
+         ( !otaServer_BlockWaiters[i].inUse ||
+           ( ( now - otaServer_BlockWaiters[i].reqTime ) >= OTA_SERVER_BLOCK_READ_TIMEOUT ) ) )
+    {
+      pWaiter = &otaServer_BlockWaiters[i];
+    }
+  }
+
+  if ( pWaiter == NULL )
+  {
+    return ZFailure;
+  }
+
+  pWaiter->addr = *pAddr;
+  OsalPort_memcpy( &pWaiter->fileId, pFileId, sizeof ( zclOTA_FileID_t ) );
+  pWaiter->offset = offset;
+  pWaiter->reqTime = now;
+  pWaiter->len = len;
+  pWaiter->transSeqNum = transSeqNum;
+  pWaiter->inUse = TRUE;
+
+  return ZSuccess;
+}
+
+ /******************************************************************************
+ * @fn      otaServer_ServeBlockWaiters
+ *
+ * @brief   Answer the clients waiting for a block just read from the host
+ *
+ * @param   pBlock - The cached block
+ *
+ * @return  none
+ */
+static void otaServer_ServeBlockWaiters( otaBlockCacheEntry_t *pBlock )
+{
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+  {
+    if ( otaServer_BlockWaiters[i].inUse &&
+         ( otaServer_BlockWaiters[i].offset == pBlock->offset ) &&
+         OsalPort_memcmp( &otaServer_BlockWaiters[i].fileId, &pBlock->fileId, sizeof ( zclOTA_FileID_t ) ) )
+    {
+      otaServer_BlockWaiters[i].inUse = FALSE;
+      otaServer_SendCachedBlock( &otaServer_BlockWaiters[i].addr, pBlock,
+                                 otaServer_BlockWaiters[i].len, otaServer_BlockWaiters[i].transSeqNum );
+    }
+  }
+}
+
+ /******************************************************************************
+ * @fn      otaServer_SendCachedBlock
+ *
+ * @brief   Send an Image Block Response from the block cache
+ *
+ * @param   pAddr - Client address
+ * @param   pBlock - The cached block
+ * @param   len - Maximum data size requested by the client
+ * @param   transSeqNum - Transaction sequence number of the request
+ *
+ * @return  none
+ */
+static void otaServer_SendCachedBlock( afAddrType_t *pAddr, otaBlockCacheEntry_t *pBlock,
+                                       uint8_t len, uint8_t transSeqNum )
+{
+  zclOTA_ImageBlockRspParams_t blockRsp;
+
+  blockRsp.status = ZSuccess;
+  OsalPort_memcpy ( &blockRsp.rsp.success.fileId, &pBlock->fileId, sizeof ( zclOTA_FileID_t ) );
+  blockRsp.rsp.success.fileOffset = pBlock->offset;
+  blockRsp.rsp.success.dataSize = ( len < pBlock->dataSize ) ? len : pBlock->dataSize;
+  blockRsp.rsp.success.pData = pBlock->data;
+
+  pBlock->lastUsed = ++otaServer_BlockCacheClock;
+
+  zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pAddr, &blockRsp, transSeqNum );
+
+  otaServer_BlockServed( pAddr->addr.shortAddr );
+}
+
+ /******************************************************************************
+ * @fn      otaServer_BlockServed
+ *
+ * @brief   Count an Image Block Response carrying data and update the
+ *          blocks per second rates once a second has elapsed
+ *
+ * @param   shortAddr - Client the block was sent to
+ *
+ * @return  none
+ */
+static void otaServer_BlockServed( uint16_t shortAddr )
+{
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint32_t elapsed = now - otaServer_BlockRateStart;
+
+  otaServer_ClientServed( shortAddr, now );
+
+  otaServer_BlockStats.blocksServed++;
+  otaServer_BlockRateCount++;
+
+  if ( elapsed >= 1000 )
+  {
+    otaServer_BlockStats.blocksPerSec = (uint16_t)( ( otaServer_BlockRateCount * 1000 ) / elapsed );
+    otaServer_BlockRateStart = now;
+    otaServer_BlockRateCount = 0;
+  }
+}
+
+ /******************************************************************************
+ * @fn      otaServer_GetBlockStats
+ *
+ * @brief   Get the image block cache and client session counters. The
+ *          cache hit rate is cacheHits / blockReqs.
+ *
+ * @param   pStats - [out] counters
+ * @param   clear - TRUE to reset the counters after reading them
+ *
+ * @return  none
+ */
+void otaServer_GetBlockStats( otaServerBlockStats_t *pStats, uint8_t clear )
+{
+  if ( pStats != NULL )
+  {
+    // No block served for over two seconds, the rate has dropped to 0
+    if ( ( MAP_osal_GetSystemClock() - otaServer_BlockRateStart ) >= 2000 )
+    {
+      otaServer_BlockStats.blocksPerSec = 0;
+    }
+
+    otaServer_BlockStats.activeClients = otaServer_ClientCount;
+
+    *pStats = otaServer_BlockStats;
+  }
+
+  if ( clear )
+  {
+    memset( &otaServer_BlockStats, 0, sizeof ( otaServerBlockStats_t ) );
+  }
+}
+
+/******************************************************************************
+ * @fn      otaServer_HdlIncoming
+ *
+ * @brief   Callback from ZCL to process incoming Commands specific
+ *          to this cluster library or Profile commands for attributes
+ *          that aren't in the attribute list
+ *
+ * @param   pInMsg - pointer to the incoming message
+ *
+ * @return  ZStatus_t
+ */
+static ZStatus_t otaServer_HdlIncoming ( zclIncoming_t *pInMsg )
+{
+  ZStatus_t stat = ZSuccess;
+
+  if ( zcl_ClusterCmd ( pInMsg->hdr.fc.type ) )
+  {
+    // Is this a manufacturer specific command?
+    if ( pInMsg->hdr.fc.manuSpecific == 0 )
+    {
+      // Is command for server?
+      if ( zcl_ServerCmd ( pInMsg->hdr.fc.direction ) )
+      {
+        stat = otaServer_ServerHdlIncoming ( pInMsg );
+      }
+      else // Else command is for client
+      {
+        stat = ZCL_STATUS_UNSUP_CLUSTER_COMMAND;
+      }
+    }
+    else
+    {
+      // We don't support any manufacturer specific command.
+      stat = ZCL_STATUS_UNSUP_MANU_CLUSTER_COMMAND;
+    }
+  }
+  else
+  {
+    // Handle all the normal (Read, Write...) commands -- should never get here
+    stat = ZFailure;
+  }
+
+  return ( stat );
+}
+
+/******************************************************************************
+ * @fn      otaServer_ServerHdlIncoming
+ *
+ * @brief   Handle incoming server commands.
+ *
+ * @param   pInMsg - pointer to the incoming message
+ *
+ * @return  ZStatus_t
+ */
+ZStatus_t otaServer_ServerHdlIncoming ( zclIncoming_t *pInMsg )
+{
+  switch ( pInMsg->hdr.commandID )
+  {
+    case COMMAND_OTA_UPGRADE_QUERY_NEXT_IMAGE_REQUEST:
+      return otaServer_ProcessQueryNextImageReq ( pInMsg );
+
+    case COMMAND_OTA_UPGRADE_IMAGE_BLOCK_REQUEST:
+      return otaServer_ProcessImageBlockReq ( pInMsg );
+
+    case COMMAND_OTA_UPGRADE_IMAGE_PAGE_REQUEST:
+      return otaServer_ProcessImagePageReq ( pInMsg );
+
+    case COMMAND_OTA_UPGRADE_UPGRADE_END_REQUEST:
+      return otaServer_ProcessUpgradeEndReq ( pInMsg );
+
+    case COMMAND_OTA_UPGRADE_QUERY_DEVICE_SPECIFIC_FILE_REQUEST:
+      return otaServer_ProcessQuerySpecificFileReq ( pInMsg );
+
+    default:
+      return ZFailure;
+  }
+}
+
+
+/******************************************************************************
+ * @fn      otaServer_Srv_ImageBlockReq
+ *
+ * @brief   Handle an Image Block Request.
+ *
+ * @param   pSrcAddr - The source of the message
+ *          pParam - message parameters
+ *          transSeqNum - Transaction Sequence Number
+ *
+ * @return  ZStatus_t
+ */
+ZStatus_t otaServer_Srv_ImageBlockReq ( afAddrType_t *pSrcAddr, zclOTA_ImageBlockReqParams_t *pParam,
+    uint8_t transSeqNum )
+{
+  uint8_t status = ZFailure;
+
+  if ( ( pParam != NULL ) && (pParam->fileId.version != queryResponse.fileId.version) )
+  {
+    status = ZCL_STATUS_NO_IMAGE_AVAILABLE;
+  }
+  else
+  {
+    if ( zclOTA_Permit && ( pParam != NULL ) )
+    {
+      uint8_t len = pParam->maxDataSize;
+
+      if ( len > OTA_MAX_MTU )
+      {
+        len = OTA_MAX_MTU;
+      }
+
+      // check if client supports rate limiting feature, and if client rate needs to be set
+      if ( ( ( pParam->fieldControl & OTA_BLOCK_FC_REQ_DELAY_PRESENT ) != 0 ) &&
+           ( pParam->blockReqDelay != otaServer_MinBlockReqDelay ) )
+      {
+        zclOTA_ImageBlockRspParams_t blockRsp;
+
+        // Fill in the response parameters
+        blockRsp.status = ZOtaWaitForData;
+        OsalPort_memcpy ( &blockRsp.rsp.success.fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
+        blockRsp.rsp.wait.currentTime = 0;
+        blockRsp.rsp.wait.requestTime = 0;
+        blockRsp.rsp.wait.blockReqDelay = otaServer_MinBlockReqDelay;
+
+        // Send a wait response with updated rate limit timing
+        zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &blockRsp, transSeqNum );
+      }
+      else
+      {
+        otaClientSession_t *pClient;
+        otaBlockCacheEntry_t *pBlock = NULL;
+
+        // A client asking for single blocks has given up on its page
+        otaServer_PageAbort( pSrcAddr );
+
+        otaServer_BlockStats.blockReqs++;
+
+        pClient = otaServer_ClientGet( pSrcAddr->addr.shortAddr );
+
+        if ( pClient != NULL )
+        {
+          OsalPort_memcpy( &pClient->fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
+          pClient->offset = pParam->fileOffset;
+
+          pBlock = otaServer_BlockCacheFind( &pParam->fileId, pParam->fileOffset );
+        }
+
+        if ( pClient == NULL )
+        {
+          // Too many clients upgrading, have this one ask again later
+          status = ZFailure;
+        }
+        else if ( pBlock != NULL )
+        {
+          // Answer locally from the block cache
+          otaServer_BlockStats.cacheHits++;
+          otaServer_SendCachedBlock( pSrcAddr, pBlock, len, transSeqNum );
+          status = ZSuccess;
+        }
+        else if ( ( otaServer_BlockReadFind( &pParam->fileId, pParam->fileOffset ) != NULL ) &&
+                  ( otaServer_AddBlockWaiter( pSrcAddr, &pParam->fileId, pParam->fileOffset,
+                                              len, transSeqNum ) == ZSuccess ) )
+        {
+          // The block is already being read from the host, answer when it arrives
+          status = ZSuccess;
+        }
         else
         {
-          // Add transSeqNum to SeqNumEntryTable for use in response
-          otaServer_AddSeqNumEntry( transSeqNum, pSrcAddr->addr.shortAddr );
+          // Read the data from the OTA Console
+          status = otaServer_BlockReadReq ( pSrcAddr, pSrcAddr->addr.shortAddr, &pParam->fileId,
+                                            len, pParam->fileOffset );
+
+          if ( status == ZSuccess )
+          {
+            // Keep transSeqNum in the client session for use in response
+            pClient->transSeqNum = transSeqNum;
+            pClient->seqPending = TRUE;
+          }
+        }
+
+        // Send a wait response to the client
+        if ( status != ZSuccess )
+        {
+          zclOTA_ImageBlockRspParams_t blockRsp;
+
+          // Fill in the response parameters
+          blockRsp.status = ZOtaWaitForData;
+          OsalPort_memcpy ( &blockRsp.rsp.success.fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
+          blockRsp.rsp.wait.currentTime = 0;
+          blockRsp.rsp.wait.requestTime = OTA_SEND_BLOCK_WAIT;
+          blockRsp.rsp.wait.blockReqDelay = otaServer_MinBlockReqDelay;
+
+          // Send the block to the peer
+          zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &blockRsp, transSeqNum );
+        }
+        else
+        {
+          // Fetch the next blocks of this client before it asks for them
+          otaServer_BlockReadAhead( pSrcAddr->addr.shortAddr, &pParam->fileId,
+                                    pParam->fileOffset + len, len );
         }
       }
 
@@ -2001,8 +2848,15 @@ ZStatus_t otaServer_Srv_QueryNextImageReq ( afAddrType_t *pSrcAddr, zclOTA_Query
       options |= MT_OTA_HW_VER_PRESENT_OPTION;
     }
 
-    // Request the next image for this device from the console via the MT File System
-    status = MT_OtaGetImage ( pSrcAddr, &pParam->fileId, pParam->hardwareVersion, NULL, options );
+    // Keep transSeqNum for use in response. A client that does not fit in
+    // the session table is told there is no image and queries again later.
+    status = otaServer_AddSeqNumEntry( transSeqNum, pSrcAddr->addr.shortAddr );
+
+    if ( status == ZSuccess )
+    {
+      // Request the next image for this device from the console via the MT File System
+      status = MT_OtaGetImage ( pSrcAddr, &pParam->fileId, pParam->hardwareVersion, NULL, options );
+    }
   }
   else
   {
@@ -2021,11 +2875,6 @@ ZStatus_t otaServer_Srv_QueryNextImageReq ( afAddrType_t *pSrcAddr, zclOTA_Query
     // Send a failure response to the client
     zclOTA_SendQueryNextImageRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &queryRsp, transSeqNum );
   }
-  else
-  {
-    // Add transSeqNum to SeqNumEntryTable for use in response
-    otaServer_AddSeqNumEntry( transSeqNum, pSrcAddr->addr.shortAddr );
-  }
 
   return ZCL_STATUS_CMD_HAS_RSP;
 }
@@ -2033,7 +2882,11 @@ ZStatus_t otaServer_Srv_QueryNextImageReq ( afAddrType_t *pSrcAddr, zclOTA_Query
 /******************************************************************************
  * @fn      otaServer_Srv_ImagePageReq
  *
- * @brief   Handle an Image Page Request.  Note: Not currently supported.
+ * @brief   Handle an Image Page Request. The page is streamed to the client
+ *          as Image Block Responses spaced by responseSpacing, see
+ *          otaServer_PageTxProcess. A new request from the same client
+ *          replaces its current page, which is how a client resumes after
+ *          a timeout.
  *
  * @param   pSrcAddr - The source of the message
  * @param   pParam - message parameters
@@ -2044,8 +2897,237 @@ ZStatus_t otaServer_Srv_QueryNextImageReq ( afAddrType_t *pSrcAddr, zclOTA_Query
 ZStatus_t otaServer_Srv_ImagePageReq ( afAddrType_t *pSrcAddr, zclOTA_ImagePageReqParams_t *pParam,
     uint8_t transSeqNum )
 {
-  // Send not supported resposne
-  return ZUnsupClusterCmd;
+  otaClientSession_t *pClient;
+  otaPageSession_t *pSession = NULL;
+  uint16_t i;
+
+  if ( ( pParam != NULL ) && (pParam->fileId.version != queryResponse.fileId.version) )
+  {
+    return ZCL_STATUS_NO_IMAGE_AVAILABLE;
+  }
+
+  if ( !zclOTA_Permit || ( pParam == NULL ) )
+  {
+    return ZFailure;
+  }
+
+  if ( ( pParam->maxDataSize == 0 ) || ( pParam->pageSize == 0 ) )
+  {
+    return ZCL_STATUS_INVALID_VALUE;
+  }
+
+  otaServer_PageAbort( pSrcAddr );
+
+  pClient = otaServer_ClientGet( pSrcAddr->addr.shortAddr );
+
+  if ( pClient != NULL )
+  {
+    OsalPort_memcpy( &pClient->fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
+    pClient->offset = pParam->fileOffset;
+
+    for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+    {
+      if ( !otaServer_PageSessions[i].inUse )
+      {
+        pSession = &otaServer_PageSessions[i];
+        break;
+      }
+    }
+  }
+
+  if ( pSession == NULL )
+  {
+    zclOTA_ImageBlockRspParams_t blockRsp;
+
+    // Too many clients upgrading, have this one ask again later
+    blockRsp.status = ZOtaWaitForData;
+    blockRsp.rsp.wait.currentTime = 0;
+    blockRsp.rsp.wait.requestTime = OTA_SEND_BLOCK_WAIT;
+    blockRsp.rsp.wait.blockReqDelay = otaServer_MinBlockReqDelay;
+
+    zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &blockRsp, transSeqNum );
+  }
+  else
+  {
+    otaServer_BlockStats.pageReqs++;
+
+    pSession->addr = *pSrcAddr;
+    OsalPort_memcpy( &pSession->fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
+    pSession->nextOffset = pParam->fileOffset;
+    pSession->endOffset = pParam->fileOffset + pParam->pageSize;
+    pSession->responseSpacing = pParam->responseSpacing;
+    pSession->maxDataSize = ( pParam->maxDataSize > OTA_MAX_MTU ) ? OTA_MAX_MTU : pParam->maxDataSize;
+    pSession->transSeqNum = transSeqNum;
+    pSession->inUse = TRUE;
+
+    if ( ( queryResponse.imageSize != 0 ) && ( pSession->endOffset > queryResponse.imageSize ) )
+    {
+      pSession->endOffset = queryResponse.imageSize;
+    }
+
+    // First block goes out right away
+    pSession->lastTxTime = MAP_osal_GetSystemClock() - pSession->responseSpacing;
+
+    // Start reading the page from the host
+    otaServer_BlockReadAhead( pSession->addr.addr.shortAddr, &pSession->fileId,
+                              pSession->nextOffset, pSession->maxDataSize );
+
+    otaServer_PageTxProcess();
+  }
+
+  return ZCL_STATUS_CMD_HAS_RSP;
+}
+
+/******************************************************************************
+ * @fn      otaServer_PageAbort
+ *
+ * @brief   Stop streaming the current page of a client
+ *
+ * @param   pAddr - Client address
+ *
+ * @return  none
+ */
+static void otaServer_PageAbort( afAddrType_t *pAddr )
+{
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+  {
+    if ( otaServer_PageSessions[i].inUse &&
+         ( otaServer_PageSessions[i].addr.addr.shortAddr == pAddr->addr.shortAddr ) )
+    {
+      otaServer_PageSessions[i].inUse = FALSE;
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn      otaServer_PageTxNext
+ *
+ * @brief   Send the next block of a page if it is in the block cache,
+ *          otherwise make sure it is being read from the host
+ *
+ * @param   pSession - The page transfer
+ *
+ * @return  TRUE if a block was sent
+ */
+static uint8_t otaServer_PageTxNext( otaPageSession_t *pSession )
+{
+  otaBlockCacheEntry_t *pBlock;
+  uint32_t remaining;
+  uint8_t len;
+
+  pBlock = otaServer_BlockCacheFind( &pSession->fileId, pSession->nextOffset );
+
+  if ( pBlock == NULL )
+  {
+    // The read response restarts the scheduler
+    otaServer_BlockReadAhead( pSession->addr.addr.shortAddr, &pSession->fileId,
+                              pSession->nextOffset, pSession->maxDataSize );
+
+    return FALSE;
+  }
+
+  // Do not run past the end of the page
+  len = pSession->maxDataSize;
+  remaining = pSession->endOffset - pSession->nextOffset;
+  if ( remaining < len )
+  {
+    len = (uint8_t)remaining;
+  }
+  if ( pBlock->dataSize < len )
+  {
+    len = pBlock->dataSize;
+  }
+
+  otaServer_SendCachedBlock( &pSession->addr, pBlock, len, pSession->transSeqNum );
+
+  pSession->nextOffset += len;
+  pSession->lastTxTime = MAP_osal_GetSystemClock();
+
+  // The page end is capped to the image size when it is known, otherwise
+  // a short block means the end of the file has been reached
+  if ( ( pSession->nextOffset >= pSession->endOffset ) ||
+       ( ( queryResponse.imageSize == 0 ) && ( len < pSession->maxDataSize ) ) )
+  {
+    pSession->inUse = FALSE;
+  }
+  else
+  {
+    // Keep the host reads ahead of the transmission
+    otaServer_BlockReadAhead( pSession->addr.addr.shortAddr, &pSession->fileId,
+                              pSession->nextOffset, pSession->maxDataSize );
+  }
+
+  return TRUE;
+}
+
+/******************************************************************************
+ * @fn      otaServer_PageTxProcess
+ *
+ * @brief   Transmit scheduler for Image Page Requests. Sends the blocks
+ *          that are due, drops transfers stalled longer than
+ *          OTA_SERVER_PAGE_TIMEOUT and rearms the timer for the next
+ *          block due. Transfers are visited round robin so that each
+ *          client gets its turn at the block cache and the host reads.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void otaServer_PageTxProcess( void )
+{
+  otaPageSession_t *pSession;
+  uint32_t now = MAP_osal_GetSystemClock();
+  uint32_t nextWait = 0xFFFFFFFF;
+  uint32_t elapsed;
+  uint32_t wait = 0;
+  uint16_t i;
+
+  for ( i = 0; i < OTA_SERVER_CLIENT_MAX; i++ )
+  {
+    pSession = &otaServer_PageSessions[( otaServer_PageTxStart + i ) % OTA_SERVER_CLIENT_MAX];
+
+    if ( !pSession->inUse )
+    {
+      continue;
+    }
+
+    elapsed = now - pSession->lastTxTime;
+
+    if ( elapsed < pSession->responseSpacing )
+    {
+      wait = pSession->responseSpacing - elapsed;
+    }
+    else if ( otaServer_PageTxNext( pSession ) )
+    {
+      wait = pSession->responseSpacing;
+    }
+    else if ( elapsed >= ( (uint32_t)pSession->responseSpacing + OTA_SERVER_PAGE_TIMEOUT ) )
+    {
+      // The host did not deliver the block in time, the client will resume
+      pSession->inUse = FALSE;
+    }
+    else
+    {
+      wait = OTA_SERVER_PAGE_RETRY;
+    }
+
+    if ( pSession->inUse && ( wait < nextWait ) )
+    {
+      nextWait = wait;
+    }
+  }
+
+  // The next pass starts with the following transfer
+  otaServer_PageTxStart = ( otaServer_PageTxStart + 1 ) % OTA_SERVER_CLIENT_MAX;
+
+  if ( nextWait != 0xFFFFFFFF )
+  {
+    UtilTimer_stop( &OtaServerPageTxClkStruct );
+    UtilTimer_setTimeout( OtaServerPageTxClkHandle, ( nextWait != 0 ) ? nextWait : 1 );
+    UtilTimer_start( &OtaServerPageTxClkStruct );
+  }
 }
 
 /******************************************************************************
@@ -2107,6 +3189,10 @@ ZStatus_t otaServer_Srv_UpgradeEndReq ( afAddrType_t *pSrcAddr, zclOTA_UpgradeEn
   {
     zclOTA_UpgradeEndRspParams_t rspParms;
 
+    // The client is done with the server
+    otaServer_PageAbort( pSrcAddr );
+    otaServer_ClientRemove( pSrcAddr->addr.shortAddr );
+
     if ( pParam->status == ZSuccess )
     {
       OsalPort_memcpy ( &rspParms.fileId, &pParam->fileId, sizeof ( zclOTA_FileID_t ) );
@@ -2237,7 +3323,9 @@ void otaServer_ProcessFileReadRsp ( uint8_t* pMsg, zclOTA_FileID_t *pFileId,
                                  afAddrType_t *pAddr )
 {
   zclOTA_ImageBlockRspParams_t blockRsp;
-  uint8_t transSeqNum = otaServer_FindSeqNumEntry(pAddr->addr.shortAddr);
+  otaBlockCacheEntry_t *pBlock = NULL;
+  otaBlockRead_t *pRead;
+  uint8_t transSeqNum;
 
   // Set the status
   blockRsp.status = *pMsg++;
@@ -2251,14 +3339,43 @@ void otaServer_ProcessFileReadRsp ( uint8_t* pMsg, zclOTA_FileID_t *pFileId,
     pMsg += 4;
     blockRsp.rsp.success.dataSize = *pMsg++;
     blockRsp.rsp.success.pData = pMsg;
+
+    // Release the read and keep the block for the other clients
+    pRead = otaServer_BlockReadFind( pFileId, blockRsp.rsp.success.fileOffset );
+    if ( pRead != NULL )
+    {
+      pRead->inUse = FALSE;
+    }
+
+    pBlock = otaServer_BlockCacheStore( pFileId, blockRsp.rsp.success.fileOffset,
+                                        blockRsp.rsp.success.dataSize, blockRsp.rsp.success.pData );
   }
   else
   {
     blockRsp.status = ZOtaAbort;
   }
 
-  // Send the block response to the peer
-  zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pAddr, &blockRsp, transSeqNum );
+  // Read-ahead responses have no client of their own
+  if ( pAddr->addrMode != afAddrNotPresent )
+  {
+    transSeqNum = otaServer_FindSeqNumEntry(pAddr->addr.shortAddr);
+
+    // Send the block response to the peer
+    zclOTA_SendImageBlockRsp ( ZCL_OTA_ENDPOINT, pAddr, &blockRsp, transSeqNum );
+
+    if ( blockRsp.status == ZSuccess )
+    {
+      otaServer_BlockServed( pAddr->addr.shortAddr );
+    }
+  }
+
+  if ( pBlock != NULL )
+  {
+    otaServer_ServeBlockWaiters( pBlock );
+
+    // A page transfer may be waiting for this block
+    otaServer_PageTxProcess();
+  }
 }
 
 /******************************************************************************
@@ -2318,7 +3435,13 @@ ZStatus_t otaServer_Srv_QuerySpecificFileReq ( afAddrType_t *pSrcAddr, zclOTA_Qu
   // Request the image from the console
   if ( zclOTA_Permit )
   {
-    status = MT_OtaGetImage ( pSrcAddr, &pParam->fileId, 0,  pParam->nodeAddr, MT_OTA_QUERY_SPECIFIC_OPTION );
+    // Keep transSeqNum for use in response
+    status = otaServer_AddSeqNumEntry( transSeqNum, pSrcAddr->addr.shortAddr );
+
+    if ( status == ZSuccess )
+    {
+      status = MT_OtaGetImage ( pSrcAddr, &pParam->fileId, 0,  pParam->nodeAddr, MT_OTA_QUERY_SPECIFIC_OPTION );
+    }
   }
   else
   {
@@ -2337,11 +3460,6 @@ ZStatus_t otaServer_Srv_QuerySpecificFileReq ( afAddrType_t *pSrcAddr, zclOTA_Qu
     // Send a failure response to the client
     zclOTA_SendQuerySpecificFileRsp ( ZCL_OTA_ENDPOINT, pSrcAddr, &queryRsp, transSeqNum );
   }
-  else
-  {
-    // Add transSeqNum to SeqNumEntryTable for use in response
-    otaServer_AddSeqNumEntry( transSeqNum, pSrcAddr->addr.shortAddr );
-  }
 
   return ZCL_STATUS_CMD_HAS_RSP;
 }
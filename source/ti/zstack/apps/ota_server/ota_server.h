@@ -65,6 +65,7 @@ extern "C"
 #define SAMPLELIGHT_LEVEL_CTRL_EVT            0x0002
 #define SAMPLEAPP_END_DEVICE_REJOIN_EVT       0x0004
 #define SAMPLEAPP_OTA_SERVER_NOTIFY_EVT       0x0008
+#define SAMPLEAPP_OTA_PAGE_TX_EVT             0x0020
 #define SAMPLEAPP_KEY_EVT                     0x4000
 
 // UI Events
@@ -87,6 +88,21 @@ extern "C"
  * TYPEDEFS
  */
 
+// Image block cache and client session counters, see otaServer_GetBlockStats()
+typedef struct
+{
+  uint32_t blockReqs;       // Image Block Requests received
+  uint32_t pageReqs;        // Image Page Requests accepted
+  uint32_t cacheHits;       // Requests answered from the block cache
+  uint32_t hostReads;       // File reads sent to the host, read-ahead included
+  uint32_t readAheads;      // File reads sent ahead of a client request
+  uint32_t blocksServed;    // Image Block Responses carrying data
+  uint16_t blocksPerSec;    // Blocks served over the last measured second
+  uint32_t clientsRejected; // Requests refused because the client table was full
+  uint32_t clientsExpired;  // Client sessions dropped for inactivity
+  uint8_t  activeClients;   // Client sessions currently open
+} otaServerBlockStats_t;
+
 /*********************************************************************
  * VARIABLES
  */
@@ -114,6 +130,12 @@ extern uint8_t  otaServer_IdentifyCommissionState;
  */
 extern void otaServer_ResetAttributesToDefaultValues(void); //implemented in ota_server_data.c
 
+/*
+ *  Get the image block cache and client session counters, optionally
+ *  clearing them.
+ */
+extern void otaServer_GetBlockStats( otaServerBlockStats_t *pStats, uint8_t clear );
+
 /*********************************************************************
 *********************************************************************/
 
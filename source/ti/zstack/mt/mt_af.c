@@ -67,6 +67,20 @@
 #define MT_AF_EXEC_DLY  1000
 #endif
 
+// Number of huge outgoing messages that the host can stage at the same time.
+#if !defined MT_AF_DATA_REQ_MAX
+#define MT_AF_DATA_REQ_MAX  4
+#endif
+
+// Number of huge incoming messages held for the host to MT_AF_DATA_RETRIEVE.
+#if !defined MT_AF_IN_MSG_MAX
+#define MT_AF_IN_MSG_MAX  8
+#endif
+
+// Optional (source endpoint, transId) key at the end of an MT_AF_DATA_STORE.
+#define MT_AF_STORE_HDR_SZ  3
+#define MT_AF_STORE_KEY_SZ  2
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Typedefs
  * ------------------------------------------------------------------------------------------------
@@ -99,7 +113,11 @@ typedef struct _mtAfInMsgList_t
  */
 
 mtAfInMsgList_t *pMtAfInMsgList = NULL;
-mtAfDataReq_t *pMtAfDataReq = NULL;
+mtAfDataReq_t *pMtAfDataReq[MT_AF_DATA_REQ_MAX];
+
+static mtAfDataReq_t *pMtAfDataReqLast = NULL;  // Most recently staged outgoing item.
+static uint8_t mtAfInMsgCnt = 0;
+static mtAfStagingStats_t mtAfStats;
 
 /* ------------------------------------------------------------------------------------------------
  *                                        Global Variables
@@ -129,6 +147,11 @@ static void MT_AfDataStore(uint8_t *pBuf);
 static void MT_AfAPSF_ConfigSet(uint8_t *pBuf);
 static void MT_AfAPSF_ConfigGet(uint8_t *pBuf);
 
+static mtAfDataReq_t **MT_AfDataReqFind(uint8_t endPoint, uint8_t transId);
+static mtAfDataReq_t **MT_AfDataReqFreeSlot(void);
+static void MT_AfDataReqFree(mtAfDataReq_t **ppReq);
+static void MT_AfStartExecTimer(void);
+
 
 /**************************************************************************************************
  * @fn          MT_AfExec
@@ -149,11 +172,15 @@ static void MT_AfAPSF_ConfigGet(uint8_t *pBuf);
 void MT_AfExec(void)
 {
   mtAfInMsgList_t *pPrev, *pItem = pMtAfInMsgList;
+  uint8_t idx, busy = FALSE;
 
   while (pItem != NULL)
   {
     if (--(pItem->tick) == 0)
     {
+      mtAfInMsgCnt--;
+      mtAfStats.inTimeouts++;
+
       if (pMtAfInMsgList == pItem)
       {
         pMtAfInMsgList = pItem->next;
@@ -174,22 +201,67 @@ void MT_AfExec(void)
     }
   }
 
-  if (pMtAfDataReq != NULL)
+  for (idx = 0; idx < MT_AF_DATA_REQ_MAX; idx++)
   {
-    if (--(pMtAfDataReq->tick) == 0)
+    if (pMtAfDataReq[idx] != NULL)
     {
-      (void)OsalPort_free(pMtAfDataReq);
-      pMtAfDataReq = NULL;
+      if (--(pMtAfDataReq[idx]->tick) == 0)
+      {
+        mtAfStats.outTimeouts++;
+        MT_AfDataReqFree(&pMtAfDataReq[idx]);
+      }
+      else
+      {
+        busy = TRUE;
+      }
     }
   }
 
-  if ((pMtAfInMsgList != NULL) || (pMtAfDataReq != NULL))
+  if ((pMtAfInMsgList != NULL) || busy)
+  {
+    MT_AfStartExecTimer();
+  }
+}
+
+/**************************************************************************************************
+ * @fn          MT_AfGetStagingStats
+ *
+ * @brief       Report the use of the huge message staging pools.
+ *
+ * input parameters
+ *
+ * @param       clear - TRUE to reset the counters after they are read.
+ *
+ * output parameters
+ *
+ * @param       pStats - Pointer to the structure to fill in.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void MT_AfGetStagingStats(mtAfStagingStats_t *pStats, uint8_t clear)
+{
+  uint8_t idx;
+
+  mtAfStats.outStaged = 0;
+  for (idx = 0; idx < MT_AF_DATA_REQ_MAX; idx++)
   {
-    if (ZSuccess != OsalPortTimers_startTimer(MT_TaskID, MT_AF_EXEC_EVT, MT_AF_EXEC_DLY))
+    if (pMtAfDataReq[idx] != NULL)
     {
-      OsalPort_setEvent(MT_TaskID, MT_AF_EXEC_EVT);
+      mtAfStats.outStaged++;
     }
   }
+  mtAfStats.inStaged = mtAfInMsgCnt;
+
+  if (pStats != NULL)
+  {
+    *pStats = mtAfStats;
+  }
+
+  if (clear)
+  {
+    (void)memset(&mtAfStats, 0, sizeof(mtAfStats));
+  }
 }
 
 /***************************************************************************************************
@@ -409,33 +481,42 @@ static void MT_AfDataRequest(uint8_t *pBuf)
   }
   else if (tempLen > (uint16_t)MT_RPC_DATA_MAX)
   {
-    if (pMtAfDataReq != NULL)
+    mtAfDataReq_t **ppReq;
+
+    if (MT_AfDataReqFind(epDesc->endPoint, transId) != NULL)
     {
+      // Already staging a message with this key.
       retValue = afStatus_INVALID_PARAMETER;
     }
-    else if ((pMtAfDataReq = OsalPort_malloc(sizeof(mtAfDataReq_t) + dataLen)) == NULL)
+    else if ((ppReq = MT_AfDataReqFreeSlot()) == NULL)
+    {
+      // Every slot is in use, the host has to wait for one to be sent or to time out.
+      mtAfStats.outRejected++;
+      retValue = ZBufferFull;
+    }
+    else if ((*ppReq = OsalPort_malloc(sizeof(mtAfDataReq_t) + dataLen)) == NULL)
     {
       retValue = afStatus_MEM_FAIL;
     }
     else
     {
+      mtAfDataReq_t *pReq = *ppReq;
+
       retValue = afStatus_SUCCESS;
 
-      pMtAfDataReq->data = (uint8_t *)(pMtAfDataReq+1);
-      (void)OsalPort_memcpy(&(pMtAfDataReq->dstAddr), &dstAddr, sizeof(afAddrType_t));
-      pMtAfDataReq->epDesc = epDesc;
-      pMtAfDataReq->cId = cId;
-      pMtAfDataReq->dataLen = dataLen;
-      pMtAfDataReq->transId = transId;
-      pMtAfDataReq->txOpts = txOpts;
-      pMtAfDataReq->radius = radius;
+      pReq->data = (uint8_t *)(pReq+1);
+      (void)OsalPort_memcpy(&(pReq->dstAddr), &dstAddr, sizeof(afAddrType_t));
+      pReq->epDesc = epDesc;
+      pReq->cId = cId;
+      pReq->dataLen = dataLen;
+      pReq->transId = transId;
+      pReq->txOpts = txOpts;
+      pReq->radius = radius;
+      pMtAfDataReqLast = pReq;
 
       // Setup to time-out the huge outgoing item if host does not MT_AF_DATA_STORE it.
-      pMtAfDataReq->tick = MT_AF_EXEC_CNT;
-      if (ZSuccess != OsalPortTimers_startTimer(MT_TaskID, MT_AF_EXEC_EVT, MT_AF_EXEC_DLY))
-      {
-        (void)OsalPort_setEvent(MT_TaskID, MT_AF_EXEC_EVT);
-      }
+      pReq->tick = MT_AF_EXEC_CNT;
+      MT_AfStartExecTimer();
     }
   }
   else
@@ -679,8 +760,10 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
 
   if (respLen > (uint16_t)MT_RPC_DATA_MAX)
   {
-    if ((pItem = (mtAfInMsgList_t *)OsalPort_malloc(sizeof(mtAfInMsgList_t) + dataLen)) == NULL)
+    if ((mtAfInMsgCnt >= MT_AF_IN_MSG_MAX) ||
+        ((pItem = (mtAfInMsgList_t *)OsalPort_malloc(sizeof(mtAfInMsgList_t) + dataLen)) == NULL))
     {
+      mtAfStats.inDropped++;
       return;  // If cannot hold a huge message, cannot give indication at all.
     }
 
@@ -780,13 +863,11 @@ void MT_AfIncomingMsg(afIncomingMSGPacket_t *pMsg)
     // Enqueue the new huge incoming item.
     pItem->next = pMtAfInMsgList;
     pMtAfInMsgList = pItem;
+    mtAfInMsgCnt++;
 
     // Setup to time-out the huge incoming item if host does not MT_AF_DATA_RETRIEVE it.
     pItem->tick = MT_AF_EXEC_CNT;
-    if (ZSuccess != OsalPortTimers_startTimer(MT_TaskID, MT_AF_EXEC_EVT, MT_AF_EXEC_DLY))
-    {
-      (void)OsalPort_setEvent(MT_TaskID, MT_AF_EXEC_EVT);
-    }
+    MT_AfStartExecTimer();
 
     pItem->timestamp = pMsg->timestamp;
     (void)OsalPort_memcpy(pItem->data, pMsg->cmd.Data, dataLen);
@@ -869,6 +950,7 @@ static void MT_AfDataRetrieve(uint8_t *pBuf)
         pPrev->next = pItem->next;
       }
       (void)OsalPort_free(pItem);
+      mtAfInMsgCnt--;
       rtrn = afStatus_SUCCESS;
     }
     else if ((pRsp = OsalPort_malloc(len + MT_AF_RTV_HDR_SZ)) == NULL)
@@ -900,6 +982,12 @@ static void MT_AfDataRetrieve(uint8_t *pBuf)
  * @brief   Process AF Data Store command to incrementally store the data buffer for very large
  *          outgoing AF message.
  *
+ *          | Index | Len | Data  | [SrcEP | TransId] |
+ *          |   2   |  1  |  Len  | [  1   |    1   ] |
+ *
+ *          The optional source endpoint and transId select which of the staged messages the
+ *          command applies to; without them it applies to the most recently staged message.
+ *
  * input parameters
  *
  * @param pBuf - pointer to the received buffer
@@ -913,29 +1001,44 @@ static void MT_AfDataRetrieve(uint8_t *pBuf)
  */
 static void MT_AfDataStore(uint8_t *pBuf)
 {
+  mtAfDataReq_t **ppReq = NULL;
+  mtAfDataReq_t *pReq;
   uint16_t idx;
   uint8_t len, rtrn = afStatus_FAILED;
+  uint8_t frameLen = pBuf[MT_RPC_POS_LEN];
 
   pBuf += MT_RPC_FRAME_HDR_SZ;
   idx = OsalPort_buildUint16( pBuf );
   len = pBuf[2];
-  pBuf += 3;
+  pBuf += MT_AF_STORE_HDR_SZ;
+
+  if (frameLen >= (MT_AF_STORE_HDR_SZ + len + MT_AF_STORE_KEY_SZ))
+  {
+    ppReq = MT_AfDataReqFind(pBuf[len], pBuf[len+1]);
+  }
+  else if (pMtAfDataReqLast != NULL)
+  {
+    for (ppReq = pMtAfDataReq; *ppReq != pMtAfDataReqLast; ppReq++);
+  }
 
-  if (pMtAfDataReq == NULL)
+  if ((ppReq == NULL) || ((pReq = *ppReq) == NULL))
   {
     rtrn = afStatus_MEM_FAIL;
   }
   else if (len == 0)  // Indication to send the message.
   {
-    rtrn = AF_DataRequest(&(pMtAfDataReq->dstAddr), pMtAfDataReq->epDesc, pMtAfDataReq->cId,
-                            pMtAfDataReq->dataLen,  pMtAfDataReq->data,
-                          &(pMtAfDataReq->transId), pMtAfDataReq->txOpts, pMtAfDataReq->radius);
-    (void)OsalPort_free(pMtAfDataReq);
-    pMtAfDataReq = NULL;
+    rtrn = AF_DataRequest(&(pReq->dstAddr), pReq->epDesc, pReq->cId,
+                            pReq->dataLen,  pReq->data,
+                          &(pReq->transId), pReq->txOpts, pReq->radius);
+    MT_AfDataReqFree(ppReq);
+  }
+  else if (((uint32_t)idx + len) > pReq->dataLen)
+  {
+    rtrn = afStatus_INVALID_PARAMETER;
   }
   else
   {
-    (void)OsalPort_memcpy(pMtAfDataReq->data+idx, pBuf, len);
+    (void)OsalPort_memcpy(pReq->data+idx, pBuf, len);
     rtrn = afStatus_SUCCESS;
   }
 
@@ -943,6 +1046,121 @@ static void MT_AfDataStore(uint8_t *pBuf)
                                                                 MT_AF_DATA_STORE, 1, &rtrn);
 }
 
+/**************************************************************************************************
+ * @fn          MT_AfDataReqFind
+ *
+ * @brief       Find the staged outgoing message with the given key.
+ *
+ * input parameters
+ *
+ * @param       endPoint - Source endpoint of the message.
+ * @param       transId - Transaction Id of the message.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      Pointer to the slot of the message or NULL if not found.
+ **************************************************************************************************
+ */
+static mtAfDataReq_t **MT_AfDataReqFind(uint8_t endPoint, uint8_t transId)
+{
+  uint8_t idx;
+
+  for (idx = 0; idx < MT_AF_DATA_REQ_MAX; idx++)
+  {
+    mtAfDataReq_t *pReq = pMtAfDataReq[idx];
+
+    if ((pReq != NULL) && (pReq->epDesc->endPoint == endPoint) && (pReq->transId == transId))
+    {
+      return &pMtAfDataReq[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/**************************************************************************************************
+ * @fn          MT_AfDataReqFreeSlot
+ *
+ * @brief       Find a slot that is not staging an outgoing message.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      Pointer to the free slot or NULL if every slot is in use.
+ **************************************************************************************************
+ */
+static mtAfDataReq_t **MT_AfDataReqFreeSlot(void)
+{
+  uint8_t idx;
+
+  for (idx = 0; idx < MT_AF_DATA_REQ_MAX; idx++)
+  {
+    if (pMtAfDataReq[idx] == NULL)
+    {
+      return &pMtAfDataReq[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/**************************************************************************************************
+ * @fn          MT_AfDataReqFree
+ *
+ * @brief       Release a staged outgoing message and its slot.
+ *
+ * input parameters
+ *
+ * @param       ppReq - Pointer to the slot of the message.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void MT_AfDataReqFree(mtAfDataReq_t **ppReq)
+{
+  if (*ppReq == pMtAfDataReqLast)
+  {
+    pMtAfDataReqLast = NULL;
+  }
+  (void)OsalPort_free(*ppReq);
+  *ppReq = NULL;
+}
+
+/**************************************************************************************************
+ * @fn          MT_AfStartExecTimer
+ *
+ * @brief       Start the timer that ages the staged huge messages.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+static void MT_AfStartExecTimer(void)
+{
+  if (ZSuccess != OsalPortTimers_startTimer(MT_TaskID, MT_AF_EXEC_EVT, MT_AF_EXEC_DLY))
+  {
+    (void)OsalPort_setEvent(MT_TaskID, MT_AF_EXEC_EVT);
+  }
+}
+
 /**************************************************************************************************
  * @fn          MT_AfAPSF_ConfigSet
  *
@@ -69,6 +69,25 @@ typedef enum {
   InterPanChk
 } InterPanCtl_t;
 #endif
+
+/***************************************************************************************************
+ * TYPEDEFS
+ ***************************************************************************************************/
+
+/*
+ * Use of the pools that hold huge AF messages staged through
+ * MT_AF_DATA_STORE and MT_AF_DATA_RETRIEVE.
+ */
+typedef struct
+{
+  uint8_t outStaged;      // Outgoing messages currently staged.
+  uint8_t inStaged;       // Incoming messages currently waiting for the host.
+  uint16_t outRejected;   // Outgoing requests refused with ZBufferFull.
+  uint16_t outTimeouts;   // Outgoing messages dropped because the host did not send them.
+  uint16_t inDropped;     // Incoming messages not indicated because the pool was full.
+  uint16_t inTimeouts;    // Incoming messages dropped because the host did not retrieve them.
+} mtAfStagingStats_t;
+
 /***************************************************************************************************
  * GLOBAL VARIABLES
  ***************************************************************************************************/
@@ -99,6 +118,11 @@ extern void MT_AfDataConfirm(afDataConfirm_t *pMsg);
  */
 extern void MT_AfReflectError(afReflectError_t *pMsg);
 
+/*
+ * Report the use of the huge message staging pools.
+ */
+extern void MT_AfGetStagingStats(mtAfStagingStats_t *pStats, uint8_t clear);
+
 /*********************************************************************
 *********************************************************************/
 #endif
@@ -50,6 +50,7 @@
 #include "bdb.h"
 #include "bdb_interface.h"
 #include "zd_app.h"
+#include "zd_sec_mgr.h"
 #include "osal_nv.h"
 
 #include "zstack.h"
@@ -335,6 +336,7 @@ static void MT_AppCnfBDBAddInstallCode(uint8_t* pBuf)
     break;
     case BDB_INSTALL_CODE_USE_KEY:
       retValue = APSME_AddTCLinkKey(pBuf,pExtAddr);
+      ZDSecMgrTCLinkKeyIdxReset();
     break;
   }
 
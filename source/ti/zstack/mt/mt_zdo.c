@@ -1258,7 +1258,7 @@ static void MT_ZdoRemoveLinkKey(uint8_t *pBuf)
     APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
     uint8_t found;
                                                    //Reset the frame counter associated to this device  TCLinkKeyRAMEntry
-    tempIndex = APSME_SearchTCLinkKeyEntry(pExtAddr,&found, &TCLKDevEntry);
+    tempIndex = ZDSecMgrTCLinkKeySearch(pExtAddr,&found, &TCLKDevEntry);
 
     if(found)
     {
@@ -1279,6 +1279,7 @@ static void MT_ZdoRemoveLinkKey(uint8_t *pBuf)
                        tempIndex,
                        sizeof(APSME_TCLinkKeyNVEntry_t),
                        &TCLKDevEntry );
+      ZDSecMgrTCLinkKeyIdxSet(tempIndex, TCLKDevEntry.extAddr);
 
       retValue = ZSuccess;
     }
@@ -61,13 +61,14 @@
 //! \name State values for MT protocol
 //@{
 #define NPIFRAMEMT_SOP_STATE 0x00
-#define NPIFRAMEMT_CMD_STATE1 0x01
-#define NPIFRAMEMT_CMD_STATE2 0x02
-#define NPIFRAMEMT_LEN_STATE 0x03
 #define NPIFRAMEMT_DATA_STATE 0x04
 #define NPIFRAMEMT_FCS_STATE 0x05
 //@}
 
+//! \brief Bytes of SOF, length and command fields at the start of a frame
+//!
+#define NPIFRAMEMT_HDR_LEN (1 + MTRPC_FRAME_HDR_SZ)
+
 //! \brief Start-of-frame delimiter for UART transport
 //!
 #define MT_SOF 0xFE
@@ -93,6 +94,8 @@ static uint8_t tempDataLen;
  Local Function Prototypes
  *****************************************************************************/
 
+static void npiframe_resync(void);
+
 /*!----------------------------------------------------------------------------
  * \brief  Calculates FCS for MT Frame
  *
@@ -197,30 +200,38 @@ NPIMSG_msg_t *NPIFrame_frameMsg(uint8_t *pIncomingMsg)
 //!             | SOP | Data Length  |   CMD   |   Data   |  FCS  |
 //!             |  1  |     1        |    2    |  0-Len   |   1   |
 //!
+//!             The header is taken in one piece once all of it is in RxBuf,
+//!             and the rest of the frame is block copied as it arrives, with
+//!             the FCS accumulated during the copy. A frame that fails the
+//!             FCS check is parsed again from the byte after its SOF so that
+//!             a good frame hidden in it by a corrupt length is not lost.
+//!
 //! \return     void
 // ----------------------------------------------------------------------------
 void NPIFrame_collectFrameData(void)
 {
-    uint8_t ch;
-    uint8_t uint8_tsInRxBuffer;
+    uint16_t count;
 
-    while (NPIRxBuf_GetRxBufCount())
+    while ((count = NPIRxBuf_GetRxBufCount()) != 0)
     {
-        NPIRxBuf_ReadFromRxBuf(&ch, 1);
-
         switch (state)
         {
             case NPIFRAMEMT_SOP_STATE:
-                if (ch == MT_SOF)
+            {
+                uint16_t sof = NPIRxBuf_FindInRxBuf(MT_SOF);
+
+                // Skip anything in front of the next SOF
+                NPIRxBuf_DiscardFromRxBuf(sof);
+                count -= sof;
+
+                if (count < NPIFRAMEMT_HDR_LEN)
                 {
-                    state = NPIFRAMEMT_LEN_STATE;
+                    // Wait for the rest of the header
+                    return;
                 }
-                break;
 
-            case NPIFRAMEMT_LEN_STATE:
-                LEN_Token = ch;
-
-                tempDataLen = 0;
+                NPIRxBuf_DiscardFromRxBuf(1);
+                NPIRxBuf_ReadFromRxBuf(&LEN_Token, 1);
 
                 /* Allocate memory for the data */
                 pMsg = (uint8_t *) OsalPort_msgAllocate(MTRPC_FRAME_HDR_SZ + LEN_Token);
@@ -228,72 +239,51 @@ void NPIFrame_collectFrameData(void)
                 if (pMsg)
                 {
                     pMsg[MTRPC_POS_LEN] = LEN_Token;
-                    state = NPIFRAMEMT_CMD_STATE1;
-                }
-                else
-                {
-                    state = NPIFRAMEMT_SOP_STATE;
-                    return;
-                }
-                break;
-
-            case NPIFRAMEMT_CMD_STATE1:
-                pMsg[MTRPC_POS_CMD0] = ch;
-                state = NPIFRAMEMT_CMD_STATE2;
-                break;
-
-            case NPIFRAMEMT_CMD_STATE2:
-                pMsg[MTRPC_POS_CMD1] = ch;
-                /* If there is no data, skip to FCS state */
-                if (LEN_Token)
-                {
-                    state = NPIFRAMEMT_DATA_STATE;
-                }
-                else
-                {
-                    state = NPIFRAMEMT_FCS_STATE;
+                    FSC_Token = LEN_Token;
+                    NPIRxBuf_ReadFromRxBufFcs(&pMsg[MTRPC_POS_CMD0], 2, &FSC_Token);
+                    tempDataLen = 0;
+                    state = (LEN_Token) ? NPIFRAMEMT_DATA_STATE : NPIFRAMEMT_FCS_STATE;
                 }
+                // else: no memory, drop the frame and look for the next one
                 break;
+            }
 
             case NPIFRAMEMT_DATA_STATE:
-
-                /* Fill in the buffer the first uint8_t of the data */
-                pMsg[MTRPC_FRAME_HDR_SZ + tempDataLen++] = ch;
-
-                /* Check number of uint8_ts left in the Rx buffer */
-                uint8_tsInRxBuffer = NPIRxBuf_GetRxBufCount();
+            {
+                uint16_t len = LEN_Token - tempDataLen;
 
                 /* If the remain of the data is there, read them all, otherwise, just read enough */
-                if (uint8_tsInRxBuffer <= LEN_Token - tempDataLen)
-                {
-                    NPIRxBuf_ReadFromRxBuf(&pMsg[MTRPC_FRAME_HDR_SZ + tempDataLen], uint8_tsInRxBuffer);
-                    tempDataLen += uint8_tsInRxBuffer;
-                }
-                else
+                if (len > count)
                 {
-                    NPIRxBuf_ReadFromRxBuf(&pMsg[MTRPC_FRAME_HDR_SZ + tempDataLen], LEN_Token - tempDataLen);
-                    tempDataLen += (LEN_Token - tempDataLen);
+                    len = count;
                 }
 
+                NPIRxBuf_ReadFromRxBufFcs(&pMsg[MTRPC_FRAME_HDR_SZ + tempDataLen], len, &FSC_Token);
+                tempDataLen += len;
+
                 /* If number of uint8_ts read is equal to data length, time to move on to FCS */
                 if (tempDataLen == LEN_Token)
                 {
                     state = NPIFRAMEMT_FCS_STATE;
                 }
-
                 break;
+            }
 
             case NPIFRAMEMT_FCS_STATE:
+            {
+                uint8_t ch;
 
-                FSC_Token = ch;
+                NPIRxBuf_ReadFromRxBuf(&ch, 1);
+
+                /* Reset the state, send or discard the buffers at this point */
+                state = NPIFRAMEMT_SOP_STATE;
 
                 /* Make sure it's correct */
-                if ((npiframe_calcMTFCS((uint8_t *)&pMsg[0], MTRPC_FRAME_HDR_SZ + LEN_Token) == FSC_Token))
+                if (ch == FSC_Token)
                 {
-
                     /* Determine if it's a SYNC or ASYNC message */
                     NPIMSG_Type msgType;
-                    
+
 #if defined(NPI_SREQRSP)
                     if ((pMsg[1] & MTRPC_CMD_TYPE_MASK) == MTRPC_CMD_SREQ)
                     {
@@ -306,23 +296,23 @@ void NPIFrame_collectFrameData(void)
 #else
                     msgType = NPIMSG_Type_ASYNC;
 #endif // NPI_SREQRSP
-                    
+
                     if ( incomingFrameCBFunc )
                     {
                         incomingFrameCBFunc(MTRPC_FRAME_HDR_SZ + LEN_Token, pMsg, msgType);
                     }
-
                 }
                 else
                 {
+                    FSC_Token = ch;
+                    npiframe_resync();
+
                     /* deallocate the msg */
                     OsalPort_msgDeallocate(pMsg);
                 }
-
-                /* Reset the state, send or discard the buffers at this point */
-                state = NPIFRAMEMT_SOP_STATE;
-
+                pMsg = NULL;
                 break;
+            }
 
             default:
                 break;
@@ -334,6 +324,33 @@ void NPIFrame_collectFrameData(void)
 /******************************************************************************
  Local Functions
  *****************************************************************************/
+// ----------------------------------------------------------------------------
+//! \brief      Put the bytes of a frame that failed the FCS check back in
+//!             RxBuf, starting at the first SOF after the one of the bad
+//!             frame, so the frame parser looks at them again.
+//!             The received FCS byte is in FSC_Token.
+//!
+//! \return     void
+// ----------------------------------------------------------------------------
+static void npiframe_resync(void)
+{
+    uint16_t len = MTRPC_FRAME_HDR_SZ + LEN_Token;
+    uint8_t *pSof = memchr(pMsg, MT_SOF, len);
+
+    if (pSof != NULL)
+    {
+        // FCS byte goes back last, so put it back first
+        if (NPIRxBuf_UnreadToRxBuf(&FSC_Token, 1))
+        {
+            NPIRxBuf_UnreadToRxBuf(pSof, len - (uint16_t)(pSof - pMsg));
+        }
+    }
+    else if (FSC_Token == MT_SOF)
+    {
+        NPIRxBuf_UnreadToRxBuf(&FSC_Token, 1);
+    }
+}
+
 // ----------------------------------------------------------------------------
 //! \brief      Calculate the FCS of a message buffer by XOR'ing each uint8_t.
 //!         Remember to exclude SOP and FCS fields, so start at the CMD field.
@@ -51,9 +51,11 @@
 #include <xdc/std.h>
 
 #include "ti_drivers_config.h"
+#include "rom_jt_154.h"
 #include "hal_types.h"
 #include "npi_config.h"
 #include "npi_tl.h"
+#include "npi_rxbuf.h"
 
 // ****************************************************************************
 // defines
@@ -138,12 +140,135 @@ uint16 NPIRxBuf_GetRxBufAvail(void)
 // -----------------------------------------------------------------------------
 uint16 NPIRxBuf_ReadFromRxBuf(uint8_t *buf, uint16 len)
 {
-	uint16_t idx;
+    return NPIRxBuf_ReadFromRxBufFcs(buf, len, NULL);
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Read bytes from RxBuf, XOR'ing them into an FCS on the way.
+//!             The circular buffer is copied in at most two contiguous spans.
+//!
+//! \param[out] buf  - Buffer to copy the bytes to.
+//! \param[in]  len  - Number of bytes to read.
+//! \param[in,out] pFcs - Running FCS, NULL if not needed.
+//!
+//! \return     uint16 - number of bytes read
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_ReadFromRxBufFcs(uint8_t *buf, uint16 len, uint8_t *pFcs)
+{
+    uint16 left = len;
+
+    while (left)
+    {
+        // Bytes up to the wrap point of the circular buffer
+        uint16 span = NPI_TL_BUF_SIZE - RxBufHead;
+        if (span > left)
+        {
+            span = left;
+        }
+
+        if (pFcs)
+        {
+            uint8_t fcs = *pFcs;
+            uint8 *pSrc = &RxBuf[RxBufHead];
+            uint16 idx;
+
+            for (idx = 0; idx < span; idx++)
+            {
+                fcs ^= pSrc[idx];
+                buf[idx] = pSrc[idx];
+            }
+            *pFcs = fcs;
+        }
+        else
+        {
+            memcpy(buf, &RxBuf[RxBufHead], span);
+        }
+
+        buf += span;
+        left -= span;
+        NPIRXBUF_RXHEAD_INC(span)
+    }
+
+    return len;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Find the first occurrence of a byte value in RxBuf.
+//!
+//! \param[in]  ch - Byte value to look for.
+//!
+//! \return     uint16 - offset from the head of RxBuf, or the number of
+//!                      bytes in RxBuf if the value is not there
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_FindInRxBuf(uint8_t ch)
+{
+    uint16 count = NPIRxBuf_GetRxBufCount();
+    uint16 span = NPI_TL_BUF_SIZE - RxBufHead;
+    uint8 *pFound;
+
+    if (span > count)
+    {
+        span = count;
+    }
+
+    pFound = memchr(&RxBuf[RxBufHead], ch, span);
+    if (pFound)
+    {
+        return (uint16)(pFound - &RxBuf[RxBufHead]);
+    }
+
+    // Second span starts at the beginning of the circular buffer
+    pFound = memchr(&RxBuf[0], ch, count - span);
+    if (pFound)
+    {
+        return (uint16)(span + (pFound - &RxBuf[0]));
+    }
+
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Drop bytes from the head of RxBuf.
+//!
+//! \param[in]  len - Number of bytes to drop.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPIRxBuf_DiscardFromRxBuf(uint16 len)
+{
+    NPIRXBUF_RXHEAD_INC(len)
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Put bytes already read back in front of the head of RxBuf, so
+//!             they are parsed again ahead of the bytes still in RxBuf.
+//!
+//! \param[in]  buf - Bytes to put back.
+//! \param[in]  len - Number of bytes to put back.
+//!
+//! \return     uint16 - number of bytes put back, 0 if there was no room
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_UnreadToRxBuf(uint8_t *buf, uint16 len)
+{
+    uint32_t key;
+    uint16 idx;
+
+    // The transport layer may be appending at the same time
+    key = OsalPort_enterCS();
+
+    if (len >= NPIRxBuf_GetRxBufAvail())
+    {
+        OsalPort_leaveCS(key);
+        return 0;
+    }
+
+    RxBufHead = (RxBufHead + NPI_TL_BUF_SIZE - len) % NPI_TL_BUF_SIZE;
     for (idx = 0; idx < len; idx++)
     {
-        *buf++ = RxBuf[RxBufHead];
-        NPIRXBUF_RXHEAD_INC(1)
+        RxBuf[(RxBufHead + idx) % NPI_TL_BUF_SIZE] = buf[idx];
     }
 
+    OsalPort_leaveCS(key);
+
     return len;
 }
@@ -104,6 +104,34 @@ uint16 NPIRxBuf_GetRxBufAvail();
 // -----------------------------------------------------------------------------
 uint16 NPIRxBuf_ReadFromRxBuf(uint8_t *buf, uint16 len);
 
+// -----------------------------------------------------------------------------
+//! \brief      Read bytes from RxBuf, XOR'ing them into an FCS on the way
+//!
+//! \return     uint16 - number of bytes read
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_ReadFromRxBufFcs(uint8_t *buf, uint16 len, uint8_t *pFcs);
+
+// -----------------------------------------------------------------------------
+//! \brief      Find the first occurrence of a byte value in RxBuf
+//!
+//! \return     uint16 - offset from the head, or count if not found
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_FindInRxBuf(uint8_t ch);
+
+// -----------------------------------------------------------------------------
+//! \brief      Drop bytes from the head of RxBuf
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPIRxBuf_DiscardFromRxBuf(uint16 len);
+
+// -----------------------------------------------------------------------------
+//! \brief      Put bytes already read back in front of the head of RxBuf
+//!
+//! \return     uint16 - number of bytes put back, 0 if there was no room
+// -----------------------------------------------------------------------------
+uint16 NPIRxBuf_UnreadToRxBuf(uint8_t *buf, uint16 len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -103,6 +103,16 @@
 //! \brief Task priority for NPI RTOS task
 #define NPITASK_PRIORITY 4
 
+//! \brief Most ASYNC frames combined into one transport layer write. Frames
+//!        are only combined on UART, where the host parses a byte stream.
+#ifndef NPITASK_TX_AGGR_MAX
+#if defined(NPI_USE_UART)
+#define NPITASK_TX_AGGR_MAX 8
+#else
+#define NPITASK_TX_AGGR_MAX 1
+#endif
+#endif
+
 
 // ****************************************************************************
 // typedefs
@@ -191,6 +201,14 @@ static npiIncomingEventCBack_t incomingTXEventAppCBFunc = NULL;
 //!
 static NPI_IncomingNPIEventRerouteType incomingTXReroute = NONE;
 
+//! \brief ASYNC TX throughput counters
+//!
+static NPITask_txStats_t npiTxStats;
+
+//! \brief Clock tick when the ASYNC TX counters were last reset
+//!
+static uint32_t npiTxStatsStart = 0;
+
 extern Semaphore_Handle npiInitializationMutexHandle;
 
 //*****************************************************************************
@@ -463,17 +481,10 @@ static void NPITask_process(void)
                 // - ? for your favorite technology
                 NPIFrame_collectFrameData();
 
-                if (NPIRxBuf_GetRxBufCount() == 0)
-                {
-                    // No additional bytes to collect, clear the flag.
-                    npiServiceTaskEvents &= ~NPITASK_TRANSPORT_RX_EVENT;
-                }
-                else
-                {
-                    // Additional bytes to collect, preserve the flag and repost
-                    // to the semaphore
-                    Semaphore_post(npiSemHandle);
-                }
+                // The collector consumes everything up to an incomplete frame
+                // header, which is picked up again on the next RX event, so
+                // there is nothing to repost for.
+                npiServiceTaskEvents &= ~NPITASK_TRANSPORT_RX_EVENT;
             }
 
             // A complete frame (msg) has been received and is ready for handling
@@ -700,6 +711,40 @@ void NPITask_sendToHost(uint8_t *pMsg)
     OsalPort_leaveCS(key);
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      Read the ASYNC TX throughput counters.
+//!
+//! \param[out] pStats  Counters and the rates derived from them.
+//! \param[in]  reset   TRUE to restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+void NPITask_getTxStats(NPITask_txStats_t *pStats, bool reset)
+{
+    uint32_t key;
+    uint32_t now;
+    uint32_t start;
+
+    key = OsalPort_enterCS();
+
+    now = Clock_getTicks();
+    start = npiTxStatsStart;
+    *pStats = npiTxStats;
+    if (reset)
+    {
+        memset(&npiTxStats, 0, sizeof(npiTxStats));
+        npiTxStatsStart = now;
+    }
+
+    OsalPort_leaveCS(key);
+
+    pStats->elapsedMs = (uint32_t)(((uint64_t)(now - start) * Clock_tickPeriod) / 1000);
+    pStats->bytesPerSec = (pStats->elapsedMs == 0) ? 0 :
+        (uint32_t)(((uint64_t)pStats->numBytes * 1000) / pStats->elapsedMs);
+    pStats->framesPerTransferX100 = (pStats->numTransfers == 0) ? 0 :
+        (uint16_t)((pStats->numFrames * 100) / pStats->numTransfers);
+}
+
 // -----------------------------------------------------------------------------
 // Utility functions
 
@@ -842,34 +887,77 @@ static void NPITask_processStackMsg(uint8_t *pMsg)
 }
 
 // -----------------------------------------------------------------------------
-//! \brief      Dequeue next message in the ASYNC TX Queue and send to serial
-//!             interface.
+//! \brief      Dequeue messages in the ASYNC TX Queue and send them to serial
+//!             interface. As many queued messages as fit in one transport
+//!             fragment are sent together in a single write.
 //!
 //! \return     void
 // -----------------------------------------------------------------------------
 static void NPITask_ProcessTXQ(void)
 {
     uint32_t key;
-    NPI_QueueRec *recPtr = NULL;
+    uint8_t i;
+    uint8_t numRecs = 0;
+    uint16_t len = 0;
+    uint16_t maxLen = NPITL_getMaxTxFragSize();
+    NPI_QueueRec *recs[NPITASK_TX_AGGR_MAX];
+    NPITL_txSeg_t segs[NPITASK_TX_AGGR_MAX];
 
     // Processing of any TX Queue should only be done
     // in a critical section since any application
     // task can enqueue items freely
     key = OsalPort_enterCS();
 
-    recPtr = Queue_dequeue(npiTxQueue);
-
-    if (recPtr != NULL)
+    while ((numRecs < NPITASK_TX_AGGR_MAX) && !Queue_empty(npiTxQueue))
     {
-        NPITL_writeTL(recPtr->npiMsg->pBuf, recPtr->npiMsg->pBufSize);
+        NPI_QueueRec *recPtr = Queue_head(npiTxQueue);
 
-        //free the Queue record
-        OsalPort_msgDeallocate(recPtr->npiMsg->pBuf);
-        OsalPort_free(recPtr->npiMsg);
-        OsalPort_free(recPtr);
+        // Leave the rest for the next write once the fragment is full
+        if ((numRecs > 0) && ((len + recPtr->npiMsg->pBufSize) > maxLen))
+        {
+            break;
+        }
+
+        Queue_remove(&recPtr->_elem);
+        recs[numRecs] = recPtr;
+        segs[numRecs].buf = recPtr->npiMsg->pBuf;
+        segs[numRecs].len = recPtr->npiMsg->pBufSize;
+        len += recPtr->npiMsg->pBufSize;
+        numRecs++;
     }
 
     OsalPort_leaveCS(key);
+
+    if (numRecs == 0)
+    {
+        return;
+    }
+
+    if (len > maxLen)
+    {
+        // A single message larger than a fragment is sent in pieces
+        NPITL_writeTL(segs[0].buf, segs[0].len);
+    }
+    else
+    {
+        NPITL_writeTLv(segs, numRecs);
+    }
+
+    npiTxStats.numTransfers++;
+    npiTxStats.numFrames += numRecs;
+    npiTxStats.numBytes += len;
+    if (numRecs > npiTxStats.maxFramesPerTransfer)
+    {
+        npiTxStats.maxFramesPerTransfer = numRecs;
+    }
+
+    for (i = 0; i < numRecs; i++)
+    {
+        //free the Queue record
+        OsalPort_msgDeallocate(recs[i]->npiMsg->pBuf);
+        OsalPort_free(recs[i]->npiMsg);
+        OsalPort_free(recs[i]);
+    }
 }
 
 #if defined(NPI_SREQRSP)
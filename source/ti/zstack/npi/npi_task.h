@@ -93,6 +93,19 @@ typedef enum NPIEventRerouteType { NONE,
                                    ECHO,
                                    INTERCEPT } NPI_IncomingNPIEventRerouteType;
 
+//! \brief      ASYNC TX throughput counters, see NPITask_getTxStats().
+//!
+typedef struct
+{
+    uint32_t numTransfers;          //!< Transport layer writes started
+    uint32_t numFrames;             //!< Frames carried by those writes
+    uint32_t numBytes;              //!< Bytes carried by those writes
+    uint32_t elapsedMs;             //!< Time since the counters were reset
+    uint32_t bytesPerSec;           //!< numBytes over elapsedMs
+    uint16_t framesPerTransferX100; //!< Average frames per write, times 100
+    uint8_t  maxFramesPerTransfer;  //!< Most frames sent in one write
+} NPITask_txStats_t;
+
 
 
 //*****************************************************************************
@@ -154,6 +167,16 @@ extern void NPITask_registerIncomingTXEventAppCB(npiIncomingEventCBack_t appTxCB
 // -----------------------------------------------------------------------------
 extern void NPITask_sendToHost(uint8_t *pMsg);
 
+// -----------------------------------------------------------------------------
+//! \brief      Read the ASYNC TX throughput counters.
+//!
+//! \param[out] pStats  Counters and the rates derived from them.
+//! \param[in]  reset   TRUE to restart the counters after reading them.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+extern void NPITask_getTxStats(NPITask_txStats_t *pStats, bool reset);
+
 
 #ifdef __cplusplus
 {
@@ -111,6 +111,9 @@ static Char npiTxBuf[NPI_TL_BUF_SIZE];
 //! \brief Number of bytes in NPI Transport Layer transmit buffer
 static uint16_t npiTxBufLen = 0;
 
+//! \brief Flag for transmit buffer being filled by a gathered write
+static volatile bool npiTxBufClaimed = FALSE;
+
 //! \brief Call back function in NPI Task for transmit complete
 static npiRtosCB_t taskTxCB = NULL;
 
@@ -210,9 +213,9 @@ void NPITL_initTL(npiRtosCB_t npiCBTx, npiRtosCB_t npiCBRx, npiRtosCB_t npiCBMrd
 bool NPITL_checkNpiBusy(void)
 {
 #if (NPI_FLOW_CTRL == 1)
-    return !PIN_getOutputValue(SRDY_PIN);
+    return npiTxBufClaimed || !PIN_getOutputValue(SRDY_PIN);
 #else
-    return npiTxActive;
+    return npiTxBufClaimed || npiTxActive;
 #endif // NPI_FLOW_CTRL = 1
 }
 
@@ -458,6 +461,84 @@ uint16 NPITL_writeTL(uint8 *buf, uint16 len)
     return len;
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine gathers several buffers into one transport layer
+//!             write. The transmit buffer is claimed in a critical section,
+//!             filled outside of it, and the transfer is then started.
+//!
+//! \param[in]  pSegs - Array of segments to write, in order.
+//! \param[in]  numSegs - Number of segments in the array.
+//!
+//! \return     uint16 - the number of bytes written to transport
+// -----------------------------------------------------------------------------
+uint16 NPITL_writeTLv(NPITL_txSeg_t *pSegs, uint8 numSegs)
+{
+    uint32_t key;
+    uint16 len = 0;
+    uint8 i;
+
+    for ( i = 0; i < numSegs; i++ )
+    {
+        len += pSegs[i].len;
+    }
+
+    // Gathered writes must go out in one fragment
+    if ( (len == 0) || (len > NPI_MAX_FRAG_SIZE) )
+    {
+        return 0;
+    }
+
+    key = OsalPort_enterCS();
+
+    // Writes are atomic at transport layer
+    if ( NPITL_checkNpiBusy() )
+    {
+        OsalPort_leaveCS(key);
+        return 0;
+    }
+
+    npiTxBufClaimed = TRUE;
+    msgFrag = NULL;
+    msgFragLen = 0;
+
+    OsalPort_leaveCS(key);
+
+    // Buffer is claimed, copy without blocking other tasks
+    len = 0;
+    for ( i = 0; i < numSegs; i++ )
+    {
+        memcpy(&npiTxBuf[len], pSegs[i].buf, pSegs[i].len);
+        len += pSegs[i].len;
+    }
+
+    key = OsalPort_enterCS();
+
+    npiTxBufClaimed = FALSE;
+    npiTxBufLen = len;
+    npiTxActive = TRUE;
+    txPktCount++;
+
+    len = transportWrite(npiTxBufLen);
+
+#if (NPI_FLOW_CTRL == 1)
+    SRDY_ENABLE();
+#endif // NPI_FLOW_CTRL = 1
+
+    OsalPort_leaveCS(key);
+
+    return len;
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the number of bytes sent by one transfer.
+//!
+//! \return     uint16 - max size of a transmit fragment
+// -----------------------------------------------------------------------------
+uint16 NPITL_getMaxTxFragSize(void)
+{
+    return(NPI_MAX_FRAG_SIZE);
+}
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine returns the max size receive buffer.
 //!
@@ -97,6 +97,13 @@ typedef void (*npiRtosCB_t)(int size);
 // -----------------------------------------------------------------------------
 typedef void (*npiMrdyRtosCB_t)();
 
+//! \brief One segment of a gathered transport layer write
+typedef struct
+{
+    uint8 *buf;     //!< Pointer to segment data
+    uint16 len;     //!< Number of bytes in the segment
+} NPITL_txSeg_t;
+
 //*****************************************************************************
 // globals
 //*****************************************************************************
@@ -139,6 +146,25 @@ uint16 NPITL_readTL(uint8 *buf, uint16 len);
 // -----------------------------------------------------------------------------
 uint16 NPITL_writeTL(uint8 *buf, uint16 len);
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine gathers several buffers into one transport layer
+//!             write. The total length must fit in a single fragment
+//!             (NPITL_getMaxTxFragSize()), gathered writes are not fragmented.
+//!
+//! \param[in]  pSegs - Array of segments to write, in order.
+//! \param[in]  numSegs - Number of segments in the array.
+//!
+//! \return     uint16 - the number of bytes written to transport
+// -----------------------------------------------------------------------------
+uint16 NPITL_writeTLv(NPITL_txSeg_t *pSegs, uint8 numSegs);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the number of bytes sent by one transfer.
+//!
+//! \return     uint16 - max size of a transmit fragment
+// -----------------------------------------------------------------------------
+uint16 NPITL_getMaxTxFragSize(void);
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine is used to handle an MRDY edge from the application
 //!             context. Certain operations such as UART_read() cannot be
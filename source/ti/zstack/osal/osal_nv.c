@@ -284,6 +284,58 @@ uint8_t osal_nv_write( uint16_t id, uint16_t len, void *buf )
   return ( osal_nv_write_ex( ZCD_NV_EX_LEGACY, id, len, buf ) );
 }
 
+/******************************************************************************
+ * @fn      osal_nv_write_begin
+ *
+ * @brief   Start a group of NV writes. Until the matching osal_nv_write_commit,
+ *          writes are held in RAM by the NV driver and are then committed
+ *          to Flash together. Reads return the pending data. Groups may
+ *          be nested. Without driver support writes go to NV immediately.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failure.
+ */
+uint8_t osal_nv_write_begin( void )
+{
+  uint8_t rtrn = SUCCESS;
+
+  if ( pZStackCfg && pZStackCfg->nvFps.beginTxn )
+  {
+    if ( pZStackCfg->nvFps.beginTxn() != NVINTF_SUCCESS )
+    {
+      rtrn = NV_OPER_FAILED;
+    }
+  }
+
+  return rtrn;
+}
+
+/******************************************************************************
+ * @fn      osal_nv_write_commit
+ *
+ * @brief   End a group of NV writes started by osal_nv_write_begin. Ending
+ *          the outermost group writes the pending items to Flash.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failure.
+ */
+uint8_t osal_nv_write_commit( void )
+{
+  uint8_t rtrn = SUCCESS;
+
+  if ( pZStackCfg && pZStackCfg->nvFps.commitTxn )
+  {
+    if ( pZStackCfg->nvFps.commitTxn() != NVINTF_SUCCESS )
+    {
+      rtrn = NV_OPER_FAILED;
+    }
+  }
+
+  return rtrn;
+}
+
 /******************************************************************************
  * @fn      osal_nv_read_ex
  *
@@ -138,6 +138,16 @@ extern uint16_t osal_nv_item_len_ex( uint16_t id, uint16_t subId );
  */
 extern uint8_t osal_nv_delete_ex( uint16_t id, uint16_t subId, uint16_t len );
 
+/*
+ * Start a group of NV writes that are committed together
+ */
+extern uint8_t osal_nv_write_begin( void );
+
+/*
+ * Commit a group of NV writes
+ */
+extern uint8_t osal_nv_write_commit( void );
+
 /*********************************************************************
 *********************************************************************/
 
@@ -62,6 +62,7 @@
 #define OTA_APP_DISCOVERY_REQ               2
 #define OTA_APP_JOIN_REQ                    3
 #define OTA_APP_LEAVE_REQ                   4
+#define OTA_APP_STATS_REQ                   5
 
 #define OTA_APP_READ_ATTRIBUTE_IND          0x80
 #define OTA_APP_IMAGE_NOTIFY_RSP            0x81
@@ -69,6 +70,7 @@
 #define OTA_APP_JOIN_IND                    0x83
 #define OTA_APP_ENDPOINT_IND                0x85
 #define OTA_APP_DONGLE_IND                  0x8A
+#define OTA_APP_STATS_IND                   0x8B
 
 // Sys App Message Lengths
 #define OTA_APP_READ_ATTRIBUTE_REQ_LEN      (8 + OTA_APP_MAX_ATTRIBUTES*2)
@@ -76,6 +78,7 @@
 #define OTA_APP_DISCOVERY_REQ_LEN           2
 #define OTA_APP_JOIN_REQ_LEN                5
 #define OTA_APP_LEAVE_REQ_LEN               2
+#define OTA_APP_STATS_REQ_LEN               3
 
 #define OTA_APP_READ_ATTRIBUTE_IND_LEN      21
 #define OTA_APP_IMAGE_NOTIFY_RSP_LEN        16
@@ -83,6 +86,10 @@
 #define OTA_APP_JOIN_IND_LEN                4
 #define OTA_APP_ENDPOINT_IND_LEN            7
 #define OTA_APP_DONGLE_IND_LEN              10
+// Stats indication: counters, then OTA_APP_STATS_CLIENT_LEN per client listed
+#define OTA_APP_STATS_IND_LEN               38
+#define OTA_APP_STATS_CLIENT_LEN            8
+#define OTA_APP_STATS_CLIENTS_MAX           8
 
 #define OTA_INVALID_ID                      0xFF
 
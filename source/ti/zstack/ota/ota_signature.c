@@ -115,8 +115,8 @@ void OTA_XorBlock(uint8_t *pHash, uint8_t *pData)
  *          this function with each block of data.
  *
  * @param   pCtrl - The control structure to calculate the MMO AES Hash
- *          pData - A block of data (must be OTA_MMO_HASH_SIZE bytes except for last block)
- *          len - The length of pData (ignored except when lastBlock = TRUE)
+ *          pData - Blocks of data (must be a multiple of OTA_MMO_HASH_SIZE bytes except for last block)
+ *          len - The length of pData
  *          lastBlock - Indicates this is the last block of data to be hashed
  *
  * @return  none
@@ -172,8 +172,14 @@ void OTA_CalculateMmoR3(OTA_MmoCtrl_t *pCtrl, uint8_t *pData, uint8_t len, uint8
   }
   else
   {
-    OTA_AesHashBlock(pCtrl->hash, pData);
-    pCtrl->length += OTA_MMO_HASH_SIZE;
+    // Hash every whole block of the run
+    while (len >= OTA_MMO_HASH_SIZE)
+    {
+      OTA_AesHashBlock(pCtrl->hash, pData);
+      pCtrl->length += OTA_MMO_HASH_SIZE;
+      pData += OTA_MMO_HASH_SIZE;
+      len -= OTA_MMO_HASH_SIZE;
+    }
   }
 }
 
@@ -64,10 +64,26 @@
   #include "bdb_tl_commissioning.h"
 #endif
 
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Number of data confirm list buckets, must be a power of 2
+#if !defined ( AF_CNF_HASH_SIZE )
+  #define AF_CNF_HASH_SIZE      16
+#endif
+
+// Time (ms) after which a data confirm that never came is given up on
+#if !defined ( AF_CNF_ITEM_TIMEOUT )
+  #define AF_CNF_ITEM_TIMEOUT   60000
+#endif
+
 /*********************************************************************
  * MACROS
  */
 
+#define AF_CNF_HASH( transID )  ( (transID) & (AF_CNF_HASH_SIZE - 1) )
+
 /*********************************************************************
  * TYPEDEF
  */
@@ -77,10 +93,19 @@ typedef struct
   void* next;
   uint8_t endpoint;
   uint8_t transID;
+  uint16_t clusterID;
   void* cnfParam;
   pfnAfCnfCB afCnfCB;
+  uint32_t stamp;
 } afDataCnfList_t;
 
+// Items are kept in the order they were added, oldest at the head
+typedef struct
+{
+  afDataCnfList_t *head;
+  afDataCnfList_t *tail;
+} afDataCnfBucket_t;
+
 /*********************************************************************
  * @fn      afSend
  *
@@ -117,7 +142,8 @@ epList_t *epList;
  * LOCAL VARIABLES
  */
 
-afDataCnfList_t *afDataCnfList;
+static afDataCnfBucket_t afDataCnfTable[AF_CNF_HASH_SIZE];
+static uint8_t afDataCnfAgeIdx;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
@@ -129,7 +155,13 @@ static void afBuildMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
 
 static epList_t *afFindEndPointDescList( uint8_t EndPoint );
 
-static pDescCB afGetDescCB( endPointDesc_t *epDesc );
+static epList_t *afGetDescList( endPointDesc_t *epDesc );
+
+static uint16_t afGetProfileID( epList_t *pList, endPointDesc_t *epDesc, uint16_t defaultID );
+
+#if !defined ( APS_NO_GROUPS )
+static epList_t *afNextGroupEndPoint( uint16_t groupID, apsGroupItem_t **ppGrp );
+#endif
 
 static bool afAddCnfItem(afDataCnfList_t* cnfItem);
 
@@ -137,6 +169,11 @@ static afDataCnfList_t* afGetCnfItem(uint8_t endpoint, uint8_t transID);
 
 static afDataCnfList_t* afFindCnfItem(uint8_t endpoint, uint8_t transID);
 
+static void afAgeCnfItems(afDataCnfBucket_t *bucket, uint32_t now);
+
+static void afSendDataConfirm( uint8_t endPoint, uint8_t transID, uint16_t clusterID, ZStatus_t status,
+                               pfnAfCnfCB afCnfCB, void* cnfParam );
+
 /*********************************************************************
  * PUBLIC FUNCTIONS
  */
@@ -181,6 +218,7 @@ epList_t *afRegisterExtended( endPointDesc_t *epDesc, pDescCB descFn, pApplCB ap
     ep->apsfCfg.windowSize = APSF_DEFAULT_WINDOW_SIZE;
     ep->flags = eEP_AllowMatch;  // Default to allow Match Descriptor.
     ep->pfnApplCB = applFn;
+    ep->profileIDCached = FALSE;  // Asked from descFn on first use.
 
   #if (BDB_FINDING_BINDING_CAPABILITY_ENABLED==1)
     //Make sure we add at least one application endpoint
@@ -237,6 +275,35 @@ afStatus_t afRegister( endPointDesc_t *epDesc )
   return ((NULL == afRegisterExtended(epDesc, NULL, NULL)) ? afStatus_MEM_FAIL : afStatus_SUCCESS);
 }
 
+/*********************************************************************
+ * @fn      afInvalidateProfileID
+ *
+ * @brief   Drop the Profile ID cached for an endpoint registered with a
+ *          descriptor callback, so that the callback is asked again.
+ *          To be called when the callback's answer changes.
+ *
+ * @param   EndPoint - Application Endpoint, or AF_BROADCAST_ENDPOINT for all
+ *
+ * @return  afStatus_SUCCESS - cache dropped
+ *          afStatus_INVALID_PARAMETER - endpoint not found
+ */
+afStatus_t afInvalidateProfileID( uint8_t EndPoint )
+{
+  epList_t *epSearch;
+  afStatus_t status = afStatus_INVALID_PARAMETER;
+
+  for (epSearch = epList; epSearch != NULL; epSearch = epSearch->nextDesc)
+  {
+    if ((EndPoint == AF_BROADCAST_ENDPOINT) || (epSearch->epDesc->endPoint == EndPoint))
+    {
+      epSearch->profileIDCached = FALSE;
+      status = afStatus_SUCCESS;
+    }
+  }
+
+  return status;
+}
+
 /*********************************************************************
  * @fn      afDelete
  *
@@ -308,9 +375,6 @@ afStatus_t afDelete( uint8_t EndPoint )
  */
 void afDataConfirm( uint8_t endPoint, uint8_t transID, uint16_t clusterID, ZStatus_t status )
 {
-  endPointDesc_t *epDesc;
-  afDataConfirm_t *msgPtr;
-  
   //get the confirm callbakck and run
   pfnAfCnfCB afCnfCB = NULL;
   void* cnfParam = NULL;
@@ -322,6 +386,30 @@ void afDataConfirm( uint8_t endPoint, uint8_t transID, uint16_t clusterID, ZStat
     OsalPort_free(cnfItem);
   }
 
+  afSendDataConfirm( endPoint, transID, clusterID, status, afCnfCB, cnfParam );
+}
+
+/*********************************************************************
+ * @fn          afSendDataConfirm
+ *
+ * @brief       Send the Data Confirm message to the application task of
+ *              the endpoint, which runs the confirm callback.
+ *
+ * @param       endPoint - confirm end point
+ * @param       transID - transaction ID from APSDE_DATA_REQUEST
+ * @param       clusterID - cluster ID of the request
+ * @param       status - status of APSDE_DATA_REQUEST
+ * @param       afCnfCB - confirm callback, NULL if none
+ * @param       cnfParam - parameter of the confirm callback
+ *
+ * @return      none
+ */
+static void afSendDataConfirm( uint8_t endPoint, uint8_t transID, uint16_t clusterID, ZStatus_t status,
+                               pfnAfCnfCB afCnfCB, void* cnfParam )
+{
+  endPointDesc_t *epDesc;
+  afDataConfirm_t *msgPtr;
+
   // Find the endpoint description
   epDesc = afFindEndPointDesc( endPoint );
   if ( epDesc == NULL )
@@ -445,25 +533,17 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16_t S
                      NLDE_Signal_t *sig, uint8_t nwkSeqNum, uint8_t SecurityUse,
                      uint32_t timestamp, uint8_t radius )
 {
-  endPointDesc_t *epDesc = NULL;
-  epList_t *pList = epList;
+  endPointDesc_t *epDesc;
+  epList_t *pList;
 #if !defined ( APS_NO_GROUPS )
-  uint8_t grpEp = APS_GROUPS_EP_NOT_FOUND;
+  apsGroupItem_t *pGrp = apsGroupTable;
 #endif
 
   if ( ((aff->FrmCtrl & APS_DELIVERYMODE_MASK) == APS_FC_DM_GROUP) )
   {
 #if !defined ( APS_NO_GROUPS )
     // Find the first endpoint for this group
-    grpEp = aps_FindGroupForEndpoint( aff->GroupID, APS_GROUPS_FIND_FIRST );
-    if ( grpEp == APS_GROUPS_EP_NOT_FOUND )
-      return;   // No endpoint found
-
-    epDesc = afFindEndPointDesc( grpEp );
-    if ( epDesc == NULL )
-      return;   // Endpoint descriptor not found
-
-    pList = afFindEndPointDescList( epDesc->endPoint );
+    pList = afNextGroupEndPoint( aff->GroupID, &pGrp );
 #else
     return; // Not supported
 #endif
@@ -471,34 +551,18 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16_t S
   else if ( aff->DstEndPoint == AF_BROADCAST_ENDPOINT )
   {
     // Set the list
-    if ( pList != NULL )
-    {
-      epDesc = pList->epDesc;
-    }
+    pList = epList;
   }
-  else if ( (epDesc = afFindEndPointDesc( aff->DstEndPoint )) )
+  else
   {
-    pList = afFindEndPointDescList( epDesc->endPoint );
+    pList = afFindEndPointDescList( aff->DstEndPoint );
   }
 
-  while ( epDesc )
+  while ( pList )
   {
-    uint16_t epProfileID = 0xFFFE;  // Invalid Profile ID
+    uint16_t epProfileID = afGetProfileID( pList, pList->epDesc, 0xFFFE );  // Invalid Profile ID
 
-    if ( pList->pfnDescCB )
-    {
-      uint16_t *pID = (uint16_t *)(pList->pfnDescCB(
-                                 AF_DESCRIPTOR_PROFILE_ID, epDesc->endPoint ));
-      if ( pID )
-      {
-        epProfileID = *pID;
-        OsalPort_free( pID );
-      }
-    }
-    else if ( epDesc->simpleDesc )
-    {
-      epProfileID = epDesc->simpleDesc->AppProfId;
-    }
+    epDesc = pList->epDesc;
 
     // First part of verification is to make sure that:
     // the local Endpoint ProfileID matches the received ProfileID OR
@@ -525,15 +589,7 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16_t S
     {
 #if !defined ( APS_NO_GROUPS )
       // Find the next endpoint for this group
-      grpEp = aps_FindGroupForEndpoint( aff->GroupID, grpEp );
-      if ( grpEp == APS_GROUPS_EP_NOT_FOUND )
-        return;   // No endpoint found
-
-      epDesc = afFindEndPointDesc( grpEp );
-      if ( epDesc == NULL )
-        return;   // Endpoint descriptor not found
-
-      pList = afFindEndPointDescList( epDesc->endPoint );
+      pList = afNextGroupEndPoint( aff->GroupID, &pGrp );
 #else
       return;
 #endif
@@ -541,13 +597,9 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16_t S
     else if ( aff->DstEndPoint == AF_BROADCAST_ENDPOINT )
     {
       pList = pList->nextDesc;
-      if ( pList )
-        epDesc = pList->epDesc;
-      else
-        epDesc = NULL;
     }
     else
-      epDesc = NULL;
+      pList = NULL;
   }
 }
 
@@ -650,7 +702,6 @@ afStatus_t AF_DataRequestExt( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
                               uint16_t cID, uint16_t len, uint8_t *buf, uint8_t *transID,
                               uint8_t options, uint8_t radius, pfnAfCnfCB afCnfCB, void* cnfParam )
 {
-  pDescCB pfnDescCB;
   ZStatus_t stat;
   APSDE_DataReq_t req;
   afDataReqMTU_t mtu;
@@ -728,22 +779,7 @@ afStatus_t AF_DataRequestExt( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
   }
   else
   {
-    req.profileID = ZDO_PROFILE_ID;
-
-    if ( (pfnDescCB = afGetDescCB( srcEP )) )
-    {
-      uint16_t *pID = (uint16_t *)(pfnDescCB(
-                                   AF_DESCRIPTOR_PROFILE_ID, srcEP->endPoint ));
-      if ( pID )
-      {
-        req.profileID = *pID;
-        OsalPort_free( pID );
-      }
-    }
-    else if ( srcEP->simpleDesc )
-    {
-      req.profileID = srcEP->simpleDesc->AppProfId;
-    }
+    req.profileID = afGetProfileID( afGetDescList( srcEP ), srcEP, ZDO_PROFILE_ID );
   }
 
   req.txOptions = 0;
@@ -808,6 +844,7 @@ afStatus_t AF_DataRequestExt( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
     //add confirm callback and param into queue, fix by luoyiming 2019-3-11
     cnfItem->endpoint = req.srcEP;
     cnfItem->transID  = req.transID;
+    cnfItem->clusterID = cID;
     cnfItem->afCnfCB  = afCnfCB;
     cnfItem->cnfParam = cnfParam;
     afAddCnfItem( cnfItem );
@@ -907,20 +944,25 @@ static bool afAddCnfItem( afDataCnfList_t* cnfItem )
 {
   if( NULL != cnfItem )
   {
+    afDataCnfBucket_t *bucket = &afDataCnfTable[AF_CNF_HASH( cnfItem->transID )];
+    uint32_t now = MAP_osal_GetSystemClock();
+
+    // Reclaim items whose confirm never came, from this bucket and in turn from the others
+    afAgeCnfItems( bucket, now );
+    afAgeCnfItems( &afDataCnfTable[afDataCnfAgeIdx], now );
+    afDataCnfAgeIdx = (afDataCnfAgeIdx + 1) & (AF_CNF_HASH_SIZE - 1);
+
     cnfItem->next = NULL;
-    if( NULL == afDataCnfList )
+    cnfItem->stamp = now;
+    if( NULL == bucket->head )
     {
-      afDataCnfList = cnfItem;
+      bucket->head = cnfItem;
     }
     else
     {
-      afDataCnfList_t* findEnd = afDataCnfList;
-      while( findEnd->next )
-      {
-        findEnd = findEnd->next;
-      }
-      findEnd->next = cnfItem;
+      bucket->tail->next = cnfItem;
     }
+    bucket->tail = cnfItem;
     return TRUE;
   }
   return FALSE;
@@ -945,7 +987,8 @@ static bool afAddCnfItem( afDataCnfList_t* cnfItem )
  */
 static afDataCnfList_t* afGetCnfItem( uint8_t endpoint, uint8_t transID )
 {
-  afDataCnfList_t* find = afDataCnfList;
+  afDataCnfBucket_t *bucket = &afDataCnfTable[AF_CNF_HASH( transID )];
+  afDataCnfList_t* find = bucket->head;
   afDataCnfList_t* pre = NULL;
   while(find)
   {
@@ -957,7 +1000,11 @@ static afDataCnfList_t* afGetCnfItem( uint8_t endpoint, uint8_t transID )
       }
       else
       {
-        afDataCnfList = afDataCnfList->next;
+        bucket->head = find->next;
+      }
+      if( bucket->tail == find )
+      {
+        bucket->tail = pre;
       }
       break;
     }
@@ -986,7 +1033,7 @@ static afDataCnfList_t* afGetCnfItem( uint8_t endpoint, uint8_t transID )
  */
 static afDataCnfList_t* afFindCnfItem( uint8_t endpoint, uint8_t transID )
 {
-  afDataCnfList_t* find = afDataCnfList;
+  afDataCnfList_t* find = afDataCnfTable[AF_CNF_HASH( transID )].head;
   while(find)
   {
     if( (endpoint == find->endpoint) && (transID == find->transID) )
@@ -998,6 +1045,43 @@ static afDataCnfList_t* afFindCnfItem( uint8_t endpoint, uint8_t transID )
   return NULL;
 }
 
+/**************************************************************************************************
+ * @fn          afAgeCnfItems
+ *
+ * @brief       confirm and free the items of a confirm list bucket that have waited longer
+ *              than AF_CNF_ITEM_TIMEOUT for their data confirm. The application gets the
+ *              confirm with ZMacTransactionExpired, so its callback can release cnfParam.
+ *
+ * input parameters
+ *
+ * @param       bucket - confirm list bucket to age.
+ * @param       now - current system clock.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      none
+ */
+static void afAgeCnfItems( afDataCnfBucket_t *bucket, uint32_t now )
+{
+  afDataCnfList_t* item;
+
+  // Items are in the order they were added, so stop at the first one still in time
+  while( ( (item = bucket->head) != NULL ) && ( (now - item->stamp) >= AF_CNF_ITEM_TIMEOUT ) )
+  {
+    bucket->head = item->next;
+    if( bucket->head == NULL )
+    {
+      bucket->tail = NULL;
+    }
+
+    afSendDataConfirm( item->endpoint, item->transID, item->clusterID, ZMacTransactionExpired,
+                       item->afCnfCB, item->cnfParam );
+    OsalPort_free( item );
+  }
+}
+
 /*********************************************************************
  * @fn      AF_DataRequestSrcRtg
  *
@@ -1138,15 +1222,15 @@ uint8_t afFindSimpleDesc( SimpleDescriptionFormat_t **ppDesc, uint8_t EP )
 }
 
 /*********************************************************************
- * @fn      afGetDescCB
+ * @fn      afGetDescList
  *
- * @brief   Get the Descriptor callback function.
+ * @brief   Get the endpoint list entry of an endpoint descriptor.
  *
  * @param   epDesc - pointer to the endpoint descriptor
  *
- * @return  function pointer or NULL
+ * @return  pointer to the entry or NULL
  */
-static pDescCB afGetDescCB( endPointDesc_t *epDesc )
+static epList_t *afGetDescList( endPointDesc_t *epDesc )
 {
   epList_t *epSearch;
 
@@ -1159,15 +1243,89 @@ static pDescCB afGetDescCB( endPointDesc_t *epDesc )
     // Is there a match?
     if ( epSearch->epDesc == epDesc )
     {
-      return ( epSearch->pfnDescCB );
+      return ( epSearch );
     }
     else
       epSearch = epSearch->nextDesc;  // Next entry
   }
 
-  return ( (pDescCB)NULL );
+  return ( (epList_t *)NULL );
+}
+
+/*********************************************************************
+ * @fn      afGetProfileID
+ *
+ * @brief   Get the Profile ID of an endpoint. The answer of a descriptor
+ *          callback is cached in the endpoint list entry until
+ *          afInvalidateProfileID() is called.
+ *
+ * @param   pList - endpoint list entry, may be NULL
+ * @param   epDesc - pointer to the endpoint descriptor
+ * @param   defaultID - Profile ID to return if the endpoint has none
+ *
+ * @return  Profile ID
+ */
+static uint16_t afGetProfileID( epList_t *pList, endPointDesc_t *epDesc, uint16_t defaultID )
+{
+  if ( (pList != NULL) && (pList->pfnDescCB != NULL) )
+  {
+    if ( !pList->profileIDCached )
+    {
+      uint16_t *pID = (uint16_t *)(pList->pfnDescCB(
+                                   AF_DESCRIPTOR_PROFILE_ID, epDesc->endPoint ));
+      if ( pID == NULL )
+      {
+        return defaultID;
+      }
+
+      pList->profileID = *pID;
+      pList->profileIDCached = TRUE;
+      OsalPort_free( pID );
+    }
+
+    return pList->profileID;
+  }
+  else if ( epDesc->simpleDesc )
+  {
+    return epDesc->simpleDesc->AppProfId;
+  }
+
+  return defaultID;
 }
 
+#if !defined ( APS_NO_GROUPS )
+/*********************************************************************
+ * @fn      afNextGroupEndPoint
+ *
+ * @brief   Get the next registered endpoint that is a member of a group.
+ *          The group table is walked once for all the endpoints of the
+ *          group instead of being searched again for each of them.
+ *
+ * @param   groupID - group to look for
+ * @param   ppGrp - in: group table item to start at (apsGroupTable for the
+ *                  first call), out: group table item to continue at
+ *
+ * @return  the endpoint list entry or NULL when there are no more
+ */
+static epList_t *afNextGroupEndPoint( uint16_t groupID, apsGroupItem_t **ppGrp )
+{
+  apsGroupItem_t *pGrp = *ppGrp;
+  epList_t *pList = NULL;
+
+  while ( (pGrp != NULL) && (pList == NULL) )
+  {
+    if ( pGrp->group.ID == groupID )
+    {
+      pList = afFindEndPointDescList( pGrp->endpoint );
+    }
+    pGrp = pGrp->next;
+  }
+
+  *ppGrp = pGrp;
+  return pList;
+}
+#endif
+
 /*********************************************************************
  * @fn      afDataReqMTU
  *
@@ -343,6 +343,8 @@ typedef struct _epList_t {
   afAPSF_Config_t apsfCfg;
   eEP_Flags flags;
   pApplCB pfnApplCB;    // Don't use it if it has not been set to a valid function pointer by the application
+  uint16_t profileID;   // Profile ID from pfnDescCB, valid if profileIDCached
+  bool profileIDCached;
 } epList_t;
 
 /*********************************************************************
@@ -400,6 +402,13 @@ extern epList_t *epList;
   */
   extern afStatus_t afDelete( uint8_t EndPoint );
 
+ /*
+  * afInvalidateProfileID - Drop the Profile ID cached from an endpoint's
+  *           descriptor callback.
+  *
+  */
+  extern afStatus_t afInvalidateProfileID( uint8_t EndPoint );
+
  /*
   * afDataConfirm - APS will call this function after a data message
   *                 has been sent.
@@ -59,6 +59,35 @@ typedef struct _genericreqrsp_t
 
 } GenericReqRsp_t;
 
+typedef struct _asyncreqrsp_t
+{
+    /** message header<br>
+     */
+    zstackmsg_HDR_t hdr;
+
+    /** Message command fields */
+    void *pReq;
+
+    /** Response fields (immediate response) */
+    void *pRsp;
+
+    /** Completion fields, not used by the ZStack Thread */
+    uint16_t reqId;
+    zstack_AsyncCB_t pfnCB;
+    void *pUserData;
+
+} AsyncReqRsp_t;
+
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+
+/** Max number of asynchronous messages (single requests or batches) in flight */
+#ifndef ZSTACKAPI_MAX_ASYNC_MSGS
+#define ZSTACKAPI_MAX_ASYNC_MSGS    16
+#endif
+
 
 //*****************************************************************************
 // Local variables
@@ -66,10 +95,150 @@ typedef struct _genericreqrsp_t
 
 uint8_t stackServiceTaskId;
 
+/** Asynchronous messages sent to the ZStack Thread and not yet completed */
+static void *asyncInFlight[ZSTACKAPI_MAX_ASYNC_MSGS];
+static uint8_t asyncNumInFlight = 0;
+
+/** Last request ID given to an asynchronous request */
+static uint16_t asyncLastReqId = ZSTACKAPI_INVALID_REQ_ID;
+
 //*****************************************************************************
 // Local Functions
 //*****************************************************************************
 
+/**
+ * Send a request message to the ZStack Thread and wait for it to come back.
+ * The returned message lands in the task's response slot, so it is found
+ * without searching the task's queue and asynchronous completions of the
+ * same command are left in the queue.
+ *
+ * @param appServiceTaskId - Application Task ID
+ * @param pMsg - Message to send
+ *
+ * @return OsalPort_msgSend() status
+ */
+static uint8_t sendMsgWaitRsp(uint8_t appServiceTaskId, void *pMsg)
+{
+    uint8_t msgStatus;
+
+    // Claim the response slot before the ZStack Thread can send it back
+    OsalPort_msgExpectRsp(appServiceTaskId, pMsg);
+
+    // Send the message
+    msgStatus = OsalPort_msgSend(stackServiceTaskId, (uint8_t*)pMsg);
+
+    if(msgStatus == OsalPort_SUCCESS)
+    {
+        do
+        {
+            // Wait for the response message
+            OsalPort_blockOnEvent(Task_self());
+        } while(OsalPort_msgRspDequeue(appServiceTaskId) == NULL);
+    }
+    else
+    {
+        OsalPort_msgExpectRsp(appServiceTaskId, NULL);
+    }
+
+    return(msgStatus);
+}
+
+/**
+ * Track an asynchronous message until it comes back from the ZStack Thread.
+ *
+ * @param pMsg - Message to track
+ * @param numReqs - Number of request IDs to reserve
+ * @param pFirstReqId - First reserved request ID
+ *
+ * @return true if tracked, false if too many messages are in flight
+ */
+static bool asyncTrack(void *pMsg, uint8_t numReqs, uint16_t *pFirstReqId)
+{
+    bool tracked = false;
+    uint32_t key = OsalPort_enterCS();
+
+    if(asyncNumInFlight < ZSTACKAPI_MAX_ASYNC_MSGS)
+    {
+        asyncInFlight[asyncNumInFlight++] = pMsg;
+
+        // Request IDs never wrap to ZSTACKAPI_INVALID_REQ_ID
+        if((uint16_t)(asyncLastReqId + numReqs) < asyncLastReqId)
+        {
+            asyncLastReqId = ZSTACKAPI_INVALID_REQ_ID;
+        }
+        *pFirstReqId = asyncLastReqId + 1;
+        asyncLastReqId += numReqs;
+        tracked = true;
+    }
+
+    OsalPort_leaveCS(key);
+    return(tracked);
+}
+
+/**
+ * Stop tracking an asynchronous message.
+ *
+ * @param pMsg - Message to look for
+ *
+ * @return true if the message was tracked, false otherwise
+ */
+static bool asyncUntrack(void *pMsg)
+{
+    bool found = false;
+    uint8_t i;
+    uint32_t key = OsalPort_enterCS();
+
+    for(i = 0; i < asyncNumInFlight; i++)
+    {
+        if(asyncInFlight[i] == pMsg)
+        {
+            // Order doesn't matter, move the last one in
+            asyncInFlight[i] = asyncInFlight[--asyncNumInFlight];
+            found = true;
+            break;
+        }
+    }
+
+    OsalPort_leaveCS(key);
+    return(found);
+}
+
+/**
+ * Fill an asynchronous request message.
+ *
+ * @param pMsg - Message to fill
+ * @param appServiceTaskId - Application Task ID
+ * @param pAsyncReq - Request
+ * @param reqId - Request ID
+ */
+static void asyncFillMsg(AsyncReqRsp_t *pMsg, uint8_t appServiceTaskId,
+                         zstack_asyncReq_t *pAsyncReq, uint16_t reqId)
+{
+    pMsg->hdr.event = pAsyncReq->cmdID;
+    pMsg->hdr.status = 0;
+    pMsg->hdr.srcServiceTask = appServiceTaskId;
+    pMsg->pReq = pAsyncReq->pReq;
+    pMsg->pRsp = pAsyncReq->pRsp;
+    pMsg->reqId = reqId;
+    pMsg->pfnCB = pAsyncReq->pfnCB;
+    pMsg->pUserData = pAsyncReq->pUserData;
+}
+
+/**
+ * Call the completion callback of an asynchronous request.
+ *
+ * @param pMsg - Request message returned by the ZStack Thread
+ */
+static void asyncComplete(AsyncReqRsp_t *pMsg)
+{
+    if(pMsg->pfnCB)
+    {
+        pMsg->pfnCB(pMsg->reqId, (zstack_CmdIDs)pMsg->hdr.event,
+                    (zstack_ZStatusValues)pMsg->hdr.status, pMsg->pRsp,
+                    pMsg->pUserData);
+    }
+}
+
 /**
  * Generic function to send a request message to the ZStack Thread
  * and wait for a "default" response message.
@@ -110,35 +279,16 @@ static zstack_ZStatusValues sendReqDefaultRsp(uint8_t appServiceTaskId,
         // Update the messges's request field
         pMsg->pReq = pReq;
 
-        // Send the message
-        msgStatus = OsalPort_msgSend( stackServiceTaskId, (uint8_t*) pMsg );
+        // Send the message and wait for the response
+        msgStatus = sendMsgWaitRsp(appServiceTaskId, pMsg);
 
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            zstackmsg_genericReq_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (zstackmsg_genericReq_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
-
-             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            // setup return of
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
-        // pCmdStatus is the same as pMsg
         OsalPort_msgDeallocate( (uint8_t*)pMsg);
     }
 
@@ -190,35 +340,16 @@ static zstack_ZStatusValues sendReqRsp(uint8_t appServiceTaskId,
         pMsg->pReq = pReq;
         pMsg->pRsp = pRsp;
 
-        // Send the message
-        msgStatus = OsalPort_msgSend( stackServiceTaskId, (uint8_t*) pMsg );
+        // Send the message and wait for the response
+        msgStatus = sendMsgWaitRsp(appServiceTaskId, pMsg);
 
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            GenericReqRsp_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (GenericReqRsp_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
-
             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
-        // pCmdStatus is the same as pMsg
         OsalPort_msgDeallocate( (uint8_t*)pMsg);
     }
 
@@ -230,6 +361,151 @@ static zstack_ZStatusValues sendReqRsp(uint8_t appServiceTaskId,
 // Public Functions
 //*****************************************************************************
 
+/**
+ * Call to send a request without waiting for it to be processed.
+ *
+ * Public function defined in zstackapi.h
+ */
+uint16_t Zstackapi_asyncReq(uint8_t appServiceTaskId,
+                            zstack_asyncReq_t *pAsyncReq)
+{
+    uint16_t reqId;
+    AsyncReqRsp_t *pMsg =
+        (AsyncReqRsp_t *)OsalPort_msgAllocate(sizeof(AsyncReqRsp_t));
+
+    // Make sure the allocation was successful
+    if(pMsg == NULL)
+    {
+        return(ZSTACKAPI_INVALID_REQ_ID);
+    }
+
+    if(!asyncTrack(pMsg, 1, &reqId))
+    {
+        OsalPort_msgDeallocate((uint8_t*)pMsg);
+        return(ZSTACKAPI_INVALID_REQ_ID);
+    }
+
+    asyncFillMsg(pMsg, appServiceTaskId, pAsyncReq, reqId);
+
+    // Send the message
+    if(OsalPort_msgSend(stackServiceTaskId, (uint8_t*)pMsg) != OsalPort_SUCCESS)
+    {
+        asyncUntrack(pMsg);
+        OsalPort_msgDeallocate((uint8_t*)pMsg);
+        return(ZSTACKAPI_INVALID_REQ_ID);
+    }
+
+    return(reqId);
+}
+
+/**
+ * Call to send several requests in one message without waiting for them
+ * to be processed.
+ *
+ * Public function defined in zstackapi.h
+ */
+zstack_ZStatusValues Zstackapi_batchReq(uint8_t appServiceTaskId,
+                                        zstack_asyncReq_t *pAsyncReqs,
+                                        uint8_t numReqs, uint16_t *pReqIds)
+{
+    zstackmsg_batchReq_t *pMsg;
+    AsyncReqRsp_t *pReqs;
+    uint16_t reqId;
+    uint8_t i;
+
+    if((pAsyncReqs == NULL) || (numReqs == 0))
+    {
+        return(zstack_ZStatusValues_ZInvalidParameter);
+    }
+
+    // The requests follow the batch header in the same message
+    pMsg = (zstackmsg_batchReq_t *)OsalPort_msgAllocate(
+               sizeof(zstackmsg_batchReq_t) + (numReqs * sizeof(AsyncReqRsp_t)));
+    if(pMsg == NULL)
+    {
+        return(zstack_ZStatusValues_ZMemError);
+    }
+
+    if(!asyncTrack(pMsg, numReqs, &reqId))
+    {
+        OsalPort_msgDeallocate((uint8_t*)pMsg);
+        return(zstack_ZStatusValues_ZBufferFull);
+    }
+
+    pReqs = (AsyncReqRsp_t *)(pMsg + 1);
+    pMsg->hdr.event = zstackmsg_CmdIDs_BATCH_REQ;
+    pMsg->hdr.status = 0;
+    pMsg->hdr.srcServiceTask = appServiceTaskId;
+    pMsg->numReqs = numReqs;
+    pMsg->reqSize = sizeof(AsyncReqRsp_t);
+    pMsg->pReqs = pReqs;
+
+    for(i = 0; i < numReqs; i++)
+    {
+        asyncFillMsg(&pReqs[i], appServiceTaskId, &pAsyncReqs[i], reqId + i);
+        if(pReqIds)
+        {
+            pReqIds[i] = reqId + i;
+        }
+    }
+
+    // Send the message
+    if(OsalPort_msgSend(stackServiceTaskId, (uint8_t*)pMsg) != OsalPort_SUCCESS)
+    {
+        asyncUntrack(pMsg);
+        OsalPort_msgDeallocate((uint8_t*)pMsg);
+        return(zstack_ZStatusValues_ZFailure);
+    }
+
+    return(zstack_ZStatusValues_ZSuccess);
+}
+
+/**
+ * Call for every message received from the ZStack Thread to complete
+ * asynchronous requests.
+ *
+ * Public function defined in zstackapi.h
+ */
+bool Zstackapi_processAsyncRsp(uint8_t appServiceTaskId, void *pMsg)
+{
+    (void)appServiceTaskId;
+
+    if((pMsg == NULL) || !asyncUntrack(pMsg))
+    {
+        // Not an asynchronous request
+        return(false);
+    }
+
+    if(((zstackmsg_HDR_t *)pMsg)->event == zstackmsg_CmdIDs_BATCH_REQ)
+    {
+        zstackmsg_batchReq_t *pBatch = (zstackmsg_batchReq_t *)pMsg;
+        AsyncReqRsp_t *pReqs = (AsyncReqRsp_t *)pBatch->pReqs;
+        uint8_t i;
+
+        for(i = 0; i < pBatch->numReqs; i++)
+        {
+            asyncComplete(&pReqs[i]);
+        }
+    }
+    else
+    {
+        asyncComplete((AsyncReqRsp_t *)pMsg);
+    }
+
+    OsalPort_msgDeallocate((uint8_t*)pMsg);
+    return(true);
+}
+
+/**
+ * Call to get the number of asynchronous requests in flight.
+ *
+ * Public function defined in zstackapi.h
+ */
+uint8_t Zstackapi_asyncReqsInFlight(void)
+{
+    return(asyncNumInFlight);
+}
+
 /**
  * Call to set the Stacks Service Task ID used to send messages to the stack.
  *
@@ -282,35 +558,16 @@ zstack_ZStatusValues Zstackapi_sysVersionReq(uint8_t appServiceTaskId,
          */
         pMsg->pRsp = pRsp;
 
-        // Send the message
-        msgStatus = OsalPort_msgSend(stackServiceTaskId, (uint8_t*) pMsg );
+        // Send the message and wait for the response
+        msgStatus = sendMsgWaitRsp(appServiceTaskId, pMsg);
 
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            zstackmsg_sysVersionReq_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (zstackmsg_sysVersionReq_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
-
             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
-        // pCmdStatus is the same as pMsg
         OsalPort_msgDeallocate((uint8_t*) pMsg);
     }
 
@@ -381,35 +638,16 @@ zstack_ZStatusValues Zstackapi_sysForceLinkStatusReq(uint8_t appServiceTaskId)
         pMsg->hdr.status = 0;
         pMsg->hdr.srcServiceTask = appServiceTaskId;
 
-        // Send the message
-        msgStatus = OsalPort_msgSend(stackServiceTaskId, (uint8_t*) pMsg );
+        // Send the message and wait for the response
+        msgStatus = sendMsgWaitRsp(appServiceTaskId, pMsg);
 
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            zstackmsg_sysForceLinkStatusReq_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (zstackmsg_sysForceLinkStatusReq_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
-
             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
-        // pCmdStatus is the same as pMsg
         OsalPort_msgDeallocate( (uint8_t*)pMsg );
     }
 
@@ -445,35 +683,16 @@ zstack_ZStatusValues Zstackapi_sysNwkInfoReadReq(
          */
         pMsg->pRsp = pRsp;
 
-        // Send the message
-        msgStatus = OsalPort_msgSend( stackServiceTaskId, (uint8_t*)pMsg );
+        // Send the message and wait for the response
+        msgStatus = sendMsgWaitRsp(appServiceTaskId, pMsg);
 
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            zstackmsg_sysNwkInfoReadReq_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (zstackmsg_sysNwkInfoReadReq_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
-
             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
-        // pCmdStatus is the same as pMsg
         OsalPort_msgDeallocate( (uint8_t*)pMsg );
     }
 
@@ -781,6 +1000,26 @@ zstack_ZStatusValues Zstackapi_AfDataReq(uint8_t      appServiceTaskId,
                               sizeof(zstackmsg_afDataReq_t)) );
 }
 
+/**
+ * Call to send an AF Data Request without waiting for it to be processed
+ *
+ * Public function defined in zstackapi.h
+ */
+uint16_t Zstackapi_AfDataReqAsync(uint8_t appServiceTaskId,
+                                  zstack_afDataReq_t *pReq,
+                                  zstack_AsyncCB_t pfnCB, void *pUserData)
+{
+    zstack_asyncReq_t asyncReq;
+
+    asyncReq.cmdID = zstackmsg_CmdIDs_AF_DATA_REQ;
+    asyncReq.pReq = pReq;
+    asyncReq.pRsp = NULL;
+    asyncReq.pfnCB = pfnCB;
+    asyncReq.pUserData = pUserData;
+
+    return(Zstackapi_asyncReq(appServiceTaskId, &asyncReq));
+}
+
 /**
  * Call to send an AF InterPAN Control Request
  *
@@ -2164,8 +2403,9 @@ bool Zstackapi_freeIndMsg(void *pMsg)
                 zstackmsg_afIncomingMsgInd_t *pInd =
                     (zstackmsg_afIncomingMsgInd_t *)pMsg;
 
-                // Free the message payload
-                if(pInd->req.pPayload)
+                // Free the message payload, unless it shares the message buffer
+                if(pInd->req.pPayload &&
+                   (pInd->req.pPayload != (uint8_t *)(pInd + 1)))
                 {
                     OsalPort_free(pInd->req.pPayload);
                 }
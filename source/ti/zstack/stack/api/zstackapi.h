@@ -411,8 +411,95 @@ extern "C"
 {
 #endif
 
+/**
+ * @brief       Completion callback of an asynchronous request, called from
+ *              Zstackapi_processAsyncRsp() in the calling thread.
+ *
+ * @param       reqId - ID returned when the request was submitted
+ * @param       cmdID - command ID of the request
+ * @param       status - status of the request
+ * @param       pRsp - response structure given with the request, NULL if none
+ * @param       pUserData - user data given with the request
+ */
+typedef void (*zstack_AsyncCB_t)(uint16_t reqId, zstack_CmdIDs cmdID,
+                                 zstack_ZStatusValues status, void *pRsp,
+                                 void *pUserData);
+
+/**
+ * Asynchronous request, the request and response structures must stay valid
+ * until the completion callback is called.
+ */
+typedef struct _zstack_asyncreq_t
+{
+    /** Command ID of the request */
+    zstack_CmdIDs cmdID;
+    /** Pointer to the request's structure */
+    void *pReq;
+    /** Pointer to the response's structure, NULL if the command has none */
+    void *pRsp;
+    /** Completion callback, can be NULL */
+    zstack_AsyncCB_t pfnCB;
+    /** User data given back to the completion callback */
+    void *pUserData;
+} zstack_asyncReq_t;
+
+/** Request ID returned when an asynchronous request can't be submitted */
+#define ZSTACKAPI_INVALID_REQ_ID    0
+
 void Zstackapi_init(uint8_t stackTaskId);
 
+/**
+ * @brief       Send a request to the ZStack Thread without waiting for it to
+ *              be processed. The completion callback is called when the
+ *              application passes the returned message to
+ *              Zstackapi_processAsyncRsp().
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       pAsyncReq - Request to send
+ *
+ * @return      request ID, ZSTACKAPI_INVALID_REQ_ID if it wasn't sent
+ */
+extern uint16_t Zstackapi_asyncReq(uint8_t appEntity,
+                                   zstack_asyncReq_t *pAsyncReq);
+
+/**
+ * @brief       Send several requests to the ZStack Thread in one message
+ *              without waiting for them to be processed. Each request gets
+ *              its own completion callback.
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       pAsyncReqs - Array of requests to send
+ * @param       numReqs - Number of requests in pAsyncReqs
+ * @param       pReqIds - Array to return the request IDs, can be NULL
+ *
+ * @return      zstack_ZStatusValues
+ */
+extern zstack_ZStatusValues Zstackapi_batchReq(uint8_t appEntity,
+                                               zstack_asyncReq_t *pAsyncReqs,
+                                               uint8_t numReqs,
+                                               uint16_t *pReqIds);
+
+/**
+ * @brief       Call for every message received from the ZStack Thread before
+ *              processing it as an indication. Completed asynchronous requests
+ *              are handed to their callbacks and freed.
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       pMsg - Pointer to the received message
+ *
+ * @return      true if the message was a completed asynchronous request and
+ *              has been freed, false otherwise
+ */
+extern bool Zstackapi_processAsyncRsp(uint8_t appEntity, void *pMsg);
+
+/**
+ * @brief       Get the number of asynchronous requests sent and not yet
+ *              handed to Zstackapi_processAsyncRsp().
+ *
+ * @return      number of requests in flight
+ */
+extern uint8_t Zstackapi_asyncReqsInFlight(void);
+
 /**
  * @brief       Call to send a System Reset Request to the ZStack Thread.
  *
@@ -843,6 +930,23 @@ extern zstack_ZStatusValues Zstackapi_AfUnRegisterReq(
 extern zstack_ZStatusValues Zstackapi_AfDataReq(uint8_t appEntity,
                                                 zstack_afDataReq_t *pReq);
 
+/**
+ * @brief       Call to send an AF Data Request without waiting for the
+ *              ZStack Thread to process it.
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       pReq - Pointer to the Request structure, it must stay valid
+ *                    until pfnCB is called.
+ * @param       pfnCB - Completion callback, can be NULL
+ * @param       pUserData - User data given back to pfnCB
+ *
+ * @return      request ID, ZSTACKAPI_INVALID_REQ_ID if it wasn't sent
+ */
+extern uint16_t Zstackapi_AfDataReqAsync(uint8_t appEntity,
+                                         zstack_afDataReq_t *pReq,
+                                         zstack_AsyncCB_t pfnCB,
+                                         void *pUserData);
+
 /**
  * @brief       Call to send an AF InterPAN Control Request,
  *
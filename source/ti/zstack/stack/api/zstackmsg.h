@@ -221,6 +221,7 @@ typedef enum
     zstackmsg_CmdIDs_GP_SEND_DEV_ANNOUNCE = 0xEA,
     zstackmsg_CmdIDs_SYS_NWK_FRAME_FWD_NOTIFICATION_IND = 0xCC,
     zstackmsg_CmdIDs_PAUSE_DEVICE_REQ = 0xEB,
+    zstackmsg_CmdIDs_BATCH_REQ = 0xEC,
     zstackmsg_CmdIDs_RESERVED_1A = 0x1A,
     zstackmsg_CmdIDs_RESERVED_31 = 0x31,
     zstackmsg_CmdIDs_RESERVED_32 = 0x32,
@@ -857,6 +858,33 @@ typedef struct _zstackmsg_afdatareq_t
 
 } zstackmsg_afDataReq_t;
 
+/**
+ * Send this message to the ZStack Thread to process several requests in one
+ * message, the whole batch is returned once every request was processed.
+ * The command ID for this message is zstackmsg_CmdIDs_BATCH_REQ.
+ */
+typedef struct _zstackmsg_batchreq_t
+{
+    /** message header<br>
+     * event field must be set to @ref zstack_CmdIDs
+     */
+    zstackmsg_HDR_t hdr;
+
+    /** Number of requests in pReqs */
+    uint8_t numReqs;
+
+    /** Size in bytes of each request in pReqs */
+    uint8_t reqSize;
+
+    /**
+     * Array of request messages, each one starts with a zstackmsg_HDR_t
+     * followed by the fields of its own command message. The status of each
+     * request is returned in its header.
+     */
+    void *pReqs;
+
+} zstackmsg_batchReq_t;
+
 /**
  * Send this message to the ZStack Thread to setup the Inter-PAN controller.
  * The command ID for this message is zstackmsg_CmdIDs_AF_INTERPAN_CTL_REQ.
@@ -935,6 +963,8 @@ typedef struct _zstackmsg_afdataconfirmind_t
  * This message is sent from ZStack Thread to indicate an incoming
  * endpoint data message.
  * The command ID for this message is zstackmsg_CmdIDs_AF_INCOMING_MSG_IND.
+ * The payload (req.pPayload) may be stored right after this structure in the
+ * same message buffer, so free the message with Zstackapi_freeIndMsg().
  */
 typedef struct _zstackmsg_afincomingmsgind_t
 {
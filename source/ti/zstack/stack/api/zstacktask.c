@@ -101,6 +101,11 @@
 
 #define ZS_START_EVENT     0x0001
 
+// Place the AF incoming message payload in the same buffer as the indication
+#ifndef ZSTACKTASK_AF_IND_INLINE_PAYLOAD
+#define ZSTACKTASK_AF_IND_INLINE_PAYLOAD  TRUE
+#endif
+
 #define ZS_ZDO_SRC_RTG_IND_CBID             0x0001
 #define ZS_ZDO_CONCENTRATOR_IND_CBID        0x0002
 #define ZS_ZDO_NWK_DISCOVERY_CNF_CBID       0x0004
@@ -215,6 +220,8 @@ static uint8_t mtTaskID;
 static devStates_t newDevState = DEV_INIT;
 #endif
 
+static zstackAfIndStats_t afIndStats = { 0 };
+
 
 
 /* ------------------------------------------------------------------------------------------------
@@ -425,6 +432,7 @@ static bool processAfUnRegisterReq( uint8_t srcServiceTaskId, void *pMsg );
 static bool processAfConfigGetReq( uint8_t srcServiceTaskId, void *pMsg );
 static bool processAfConfigSetReq( uint8_t srcServiceTaskId, void *pMsg );
 static bool processAfDataReq( uint8_t srcServiceTaskId, void *pMsg );
+static bool processBatchReq( uint8_t srcServiceTaskId, void *pMsg );
 static bool processZdoDeviceAnnounceReq( uint8_t srcServiceTaskId, void *pMsg );
 
 #if defined (ZDO_NWKADDR_REQUEST)
@@ -1605,6 +1613,9 @@ static bool appMsg( uint8_t* pMsg )
     case zstackmsg_CmdIDs_PAUSE_DEVICE_REQ:
       resend = processPauseResumeDeviceReq( srcServiceTaskId, pMsg );
     break;
+    case zstackmsg_CmdIDs_BATCH_REQ:
+      resend = processBatchReq( srcServiceTaskId, pMsg );
+    break;
     default:
       pReq->hdr.status = zstack_ZStatusValues_ZUnsupportedMode;
       break;
@@ -1737,19 +1748,34 @@ static void processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt )
 {
   zstackmsg_afIncomingMsgInd_t *pReq;
   epItem_t *pItem;
+  uint16_t msgLen = sizeof(zstackmsg_afIncomingMsgInd_t);
+
+  pItem = epTableFindEntryEP( pkt->endPoint );
+  if ( pItem == NULL )
+  {
+    // No subscriber
+    afIndStats.numDropped++;
+    return;
+  }
 
-  pReq = (zstackmsg_afIncomingMsgInd_t *)OsalPort_msgAllocate( sizeof(zstackmsg_afIncomingMsgInd_t) );
+#if ( ZSTACKTASK_AF_IND_INLINE_PAYLOAD == TRUE )
+  msgLen += pkt->cmd.DataLength;
+#endif
+
+  pReq = (zstackmsg_afIncomingMsgInd_t *)OsalPort_msgAllocate( msgLen );
   if ( pReq == NULL )
   {
     // Ignore the message
+    afIndStats.numDropped++;
     return;
   }
 
-  memset( pReq, 0, sizeof(zstackmsg_afIncomingMsgInd_t) );
-
+  // Pool blocks are recycled, clear the whole header (srcServiceTask included)
+  memset( &(pReq->hdr), 0, sizeof(zstackmsg_HDR_t) );
   pReq->hdr.event = zstackmsg_CmdIDs_AF_INCOMING_MSG_IND;
-  pReq->hdr.status = 0;
 
+  // Every request field is written below, only the address union needs clearing
+  memset( &(pReq->req.srcAddr), 0, sizeof(zstack_AFAddr_t) );
   pReq->req.srcAddr.addrMode = (zstack_AFAddrMode)pkt->srcAddr.addrMode;
 
   if ( pReq->req.srcAddr.addrMode == zstack_AFAddrMode_EXT )
@@ -1779,30 +1805,73 @@ static void processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt )
   pReq->req.macSrcAddr = pkt->macSrcAddr;
   pReq->req.radius = pkt->radius;
   pReq->req.n_payload = pkt->cmd.DataLength;
+#if ( ZSTACKTASK_AF_IND_INLINE_PAYLOAD == TRUE )
+  // Payload follows the indication, freed with it by Zstackapi_freeIndMsg()
+  pReq->req.pPayload = (uint8_t *)(pReq + 1);
+#else
   pReq->req.pPayload = OsalPort_malloc( pkt->cmd.DataLength );
-  if ( pReq->req.pPayload != NULL)
+  if ( pReq->req.pPayload == NULL )
   {
-    OsalPort_memcpy( pReq->req.pPayload, pkt->cmd.Data, pkt->cmd.DataLength );
+    afIndStats.numDropped++;
+    OsalPort_msgDeallocate( (uint8_t*)pReq );
+    return;
+  }
+#endif
+  OsalPort_memcpy( pReq->req.pPayload, pkt->cmd.Data, pkt->cmd.DataLength );
 
-    pItem = epTableFindEntryEP( pkt->endPoint );
-    if ( pItem )
-    {
-      // Send to a subscriber
-      OsalPort_msgSend( pItem->connection,
-            (uint8_t*)pReq );
-    }
-    else
-    {
-      OsalPort_free(pReq->req.pPayload);
-      OsalPort_msgDeallocate((uint8_t*)pReq);
-    }
+  // Send to a subscriber
+  if ( OsalPort_msgSend( pItem->connection, (uint8_t*)pReq ) == OsalPort_SUCCESS )
+  {
+    afIndStats.numDelivered++;
+    afIndStats.numBytes += pkt->cmd.DataLength;
   }
   else
   {
-    // TODO: handle malloc error
+    afIndStats.numDropped++;
+#if ( ZSTACKTASK_AF_IND_INLINE_PAYLOAD != TRUE )
+    OsalPort_free( pReq->req.pPayload );
+#endif
+    OsalPort_msgDeallocate( (uint8_t*)pReq );
+  }
+}
+
+/**************************************************************************************************
+ * @fn      ZStackTask_getAfIndStats
+ *
+ * @brief   Read the AF incoming message indication counters. Sampling
+ *          numDelivered over time gives the frame rate delivered to the
+ *          application endpoints.
+ *
+ * @param   pStats - where to copy the counters
+ *
+ * @return  none
+ */
+void ZStackTask_getAfIndStats( zstackAfIndStats_t *pStats )
+{
+  if ( pStats != NULL )
+  {
+    uint32_t key = OsalPort_enterCS();
+    *pStats = afIndStats;
+    OsalPort_leaveCS( key );
   }
 }
 
+/**************************************************************************************************
+ * @fn      ZStackTask_resetAfIndStats
+ *
+ * @brief   Clear the AF incoming message indication counters.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void ZStackTask_resetAfIndStats( void )
+{
+  uint32_t key = OsalPort_enterCS();
+  memset( &afIndStats, 0, sizeof(afIndStats) );
+  OsalPort_leaveCS( key );
+}
+
 
 /**************************************************************************************************
  * @fn      zsProcessZDOMsgs()
@@ -5676,31 +5745,18 @@ static bool processSecApsLinkKeyGetReq( uint8_t srcServiceTaskId, void *pMsg )
 
     if ( pPtr->pReq->tcLinkKey )
     {
-      int x;
+      uint8_t found;
       APSME_TCLinkKeyNVEntry_t tcLinkKey;
 
-      for ( x = 0; x < gZDSECMGR_TC_DEVICE_MAX; x++ )
-      {
-        pPtr->hdr.status = osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, x, 0,
-                                            sizeof(APSME_TCLinkKeyNVEntry_t),
-                                            &tcLinkKey );
-
-        if ( pPtr->hdr.status == zstack_ZStatusValues_ZSuccess )
-        {
-          if ( OsalPort_memcmp( pPtr->pReq->ieeeAddr, tcLinkKey.extAddr, Z_EXTADDR_LEN ) == 0 )
-          {
-            pPtr->pRsp->rxFrmCntr = tcLinkKey.rxFrmCntr;
-            pPtr->pRsp->txFrmCntr = tcLinkKey.txFrmCntr;
-
-            break;
-          }
-        }
-      }
+      ZDSecMgrTCLinkKeySearch( pPtr->pReq->ieeeAddr, &found, &tcLinkKey );
 
-      if ( x == gZDSECMGR_TC_DEVICE_MAX )
+      if ( found )
       {
-        pPtr->hdr.status = zstack_ZStatusValues_ZSuccess;
+        pPtr->pRsp->rxFrmCntr = tcLinkKey.rxFrmCntr;
+        pPtr->pRsp->txFrmCntr = tcLinkKey.txFrmCntr;
       }
+
+      pPtr->hdr.status = zstack_ZStatusValues_ZSuccess;
     }
     else
     {
@@ -5751,34 +5807,14 @@ static bool processSecApsLinkKeySetReq( uint8_t srcServiceTaskId, void *pMsg )
   {
     if ( pPtr->pReq->tcLinkKey )
     {
-      int y = 0;
-      int x;
+      uint16_t x;
+      uint8_t found;
       APSME_TCLinkKeyNVEntry_t tcLinkKey;
-      uint8_t dummyKey[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
-      for ( x = 0; x < gZDSECMGR_TC_DEVICE_MAX; x++ )
-      {
-        pPtr->hdr.status = osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, x, 0,
-                                            sizeof(APSME_TCLinkKeyNVEntry_t),
-                                            &tcLinkKey );
+      // Existing entry for this device, or the first empty spot
+      x = ZDSecMgrTCLinkKeySearch( pPtr->pReq->ieeeAddr, &found, &tcLinkKey );
 
-        if ( pPtr->hdr.status == zstack_ZStatusValues_ZSuccess )
-        {
-          if ( OsalPort_memcmp( pPtr->pReq->ieeeAddr, tcLinkKey.extAddr, Z_EXTADDR_LEN ) == 0 )
-          {
-            y = x;
-            break;
-          }
-          else if ( (y == 0)
-                && (OsalPort_memcmp( pPtr->pReq->ieeeAddr, dummyKey, Z_EXTADDR_LEN ) == 0) )
-          {
-            // First empty spot
-            y = x;
-          }
-        }
-      }
-
-      if ( y > 0 )
+      if ( x < gZDSECMGR_TC_DEVICE_MAX )
       {
         OsalPort_memcpy( tcLinkKey.extAddr, pPtr->pReq->ieeeAddr, Z_EXTADDR_LEN );
         tcLinkKey.txFrmCntr = pPtr->pReq->txFrmCntr;
@@ -5787,6 +5823,15 @@ static bool processSecApsLinkKeySetReq( uint8_t srcServiceTaskId, void *pMsg )
         pPtr->hdr.status = osal_nv_write_ex( ZCD_NV_EX_TCLK_TABLE, x,
                                              sizeof(APSME_TCLinkKeyNVEntry_t),
                                              &tcLinkKey );
+
+        if ( pPtr->hdr.status == zstack_ZStatusValues_ZSuccess )
+        {
+          ZDSecMgrTCLinkKeyIdxSet( x, tcLinkKey.extAddr );
+        }
+      }
+      else
+      {
+        pPtr->hdr.status = zstack_ZStatusValues_ZBufferFull;
       }
     }
     else
@@ -5839,26 +5884,25 @@ static bool processSecApsLinkKeyRemoveReq( uint8_t srcServiceTaskId, void *pMsg
   {
     if ( pPtr->pReq->tcLinkKey )
     {
-      int x;
+      uint16_t x;
+      uint8_t found;
       APSME_TCLinkKeyNVEntry_t tcLinkKey;
 
-      for ( x = 0; x < gZDSECMGR_TC_DEVICE_MAX; x++ )
+      x = ZDSecMgrTCLinkKeySearch( pPtr->pReq->ieeeAddr, &found, &tcLinkKey );
+
+      pPtr->hdr.status = zstack_ZStatusValues_ZSuccess;
+
+      if ( found )
       {
-        pPtr->hdr.status = osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, x, 0,
-                                            sizeof(APSME_TCLinkKeyNVEntry_t),
-                                            &tcLinkKey );
+        memset( &tcLinkKey, 0, sizeof(APSME_TCLinkKeyNVEntry_t) );
+
+        pPtr->hdr.status = osal_nv_write_ex( ZCD_NV_EX_TCLK_TABLE, x,
+                                             sizeof(APSME_TCLinkKeyNVEntry_t),
+                                             &tcLinkKey );
 
         if ( pPtr->hdr.status == zstack_ZStatusValues_ZSuccess )
         {
-          if ( OsalPort_memcmp( pPtr->pReq->ieeeAddr, tcLinkKey.extAddr, Z_EXTADDR_LEN ) == 0 )
-          {
-            memset( &tcLinkKey, 0, sizeof(APSME_TCLinkKeyNVEntry_t) );
-
-            pPtr->hdr.status = osal_nv_write_ex( ZCD_NV_EX_TCLK_TABLE, x,
-                                                 sizeof(APSME_TCLinkKeyNVEntry_t),
-                                                 &tcLinkKey );
-            break;
-          }
+          ZDSecMgrTCLinkKeyIdxSet( x, tcLinkKey.extAddr );
         }
       }
     }
@@ -7276,6 +7320,52 @@ static bool processAfConfigSetReq( uint8_t srcServiceTaskId, void *pMsg )
   return (TRUE);
 }
 
+/**************************************************************************************************
+ * @fn          processBatchReq
+ *
+ * @brief       Process a batch of requests carried in one message. Each request
+ *              is processed in order and keeps its own status; the whole
+ *              batch is sent back once all of them are done.
+ *
+ * @param       srcServiceTaskId - Source Task ID
+ * @param       pMsg - pointer to message
+ *
+ * @return      TRUE to send the response back
+ */
+static bool processBatchReq( uint8_t srcServiceTaskId, void *pMsg )
+{
+  zstackmsg_batchReq_t *pPtr = (zstackmsg_batchReq_t *)pMsg;
+  zstackmsg_HDR_t *pSubHdr;
+  uint8_t i;
+
+  if ( (pPtr->pReqs == NULL) || (pPtr->reqSize < sizeof(zstackmsg_genericReq_t)) )
+  {
+    pPtr->hdr.status = zstack_ZStatusValues_ZInvalidParameter;
+    return (TRUE);
+  }
+
+  for ( i = 0; i < pPtr->numReqs; i++ )
+  {
+    pSubHdr = (zstackmsg_HDR_t *)((uint8_t *)pPtr->pReqs + (i * pPtr->reqSize));
+    pSubHdr->srcServiceTask = srcServiceTaskId;
+
+    if ( pSubHdr->event == zstackmsg_CmdIDs_BATCH_REQ )
+    {
+      // Batches don't nest
+      pSubHdr->status = zstack_ZStatusValues_ZInvalidParameter;
+    }
+    else
+    {
+      // The batch message goes back as a whole, ignore the resend flag
+      (void)appMsg( (uint8_t *)pSubHdr );
+    }
+  }
+
+  pPtr->hdr.status = zstack_ZStatusValues_ZSuccess;
+
+  return (TRUE);
+}
+
 /**************************************************************************************************
  * @fn          processAfDataReq
  *
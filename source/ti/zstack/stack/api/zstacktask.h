@@ -45,6 +45,17 @@ extern "C"
 extern void ZStackTaskInit( uint8_t taskId );
 extern uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events );
 
+// AF incoming message indication counters
+typedef struct
+{
+  uint32_t numDelivered;  // indications sent to an application task
+  uint32_t numBytes;      // payload bytes in the delivered indications
+  uint32_t numDropped;    // indications lost to no subscriber or no memory
+} zstackAfIndStats_t;
+
+extern void ZStackTask_getAfIndStats( zstackAfIndStats_t *pStats );
+extern void ZStackTask_resetAfIndStats( void );
+
 // TODO: put this in a better place?
 #define OSALPORT_CLEAN_UP_TIMERS_EVT      0x4000
 
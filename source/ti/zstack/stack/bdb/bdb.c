@@ -400,6 +400,7 @@ ZStatus_t bdb_setActiveCentralizedLinkKey(uint8_t zstack_CentralizedLinkKeyModes
     case zstack_UseDefaultGlobalTrustCenterLinkKey:
       //Set the default key to be used in centralized networks as defaultTCLinkKey
       Status = APSME_SetDefaultKey();
+      ZDSecMgrTCLinkKeyIdxReset();
     break;
 
     case zstack_UseInstallCodeWithFallback:
@@ -416,6 +417,7 @@ ZStatus_t bdb_setActiveCentralizedLinkKey(uint8_t zstack_CentralizedLinkKeyModes
     case zstack_UseAPSKey:
       //Set the key as global default
       Status = APSME_AddTCLinkKey(pKey,extAddr);
+      ZDSecMgrTCLinkKeyIdxReset();
     break;
 
     default:
@@ -470,6 +472,9 @@ ZStatus_t bdb_addInstallCode(uint8_t* pInstallCode, uint8_t* pExt)
 
   sspMMOHash (NULL, 0, pInstallCode,(INSTALL_CODE_LEN + INSTALL_CODE_CRC_LEN) * BITS_PER_BYTE, hashOutput);
 
+  // The library writes the TCLK table directly
+  ZDSecMgrTCLinkKeyIdxReset();
+
   return APSME_AddTCLinkKey(hashOutput,pExt);
 }
 
@@ -693,7 +698,7 @@ void bdb_TCProcessJoiningList(void)
         uint8_t found;
 
         //search for the entry in the TCLK table
-        keyNvIndex = APSME_SearchTCLinkKeyEntry(tempJoiningDescNode->bdbJoiningNodeEui64,&found, &TCLKDevEntry);
+        keyNvIndex = ZDSecMgrTCLinkKeySearch(tempJoiningDescNode->bdbJoiningNodeEui64,&found, &TCLKDevEntry);
 
         uint16_t nwkAddr;
         //Look up nwkAddr before it is cleared by ZDSecMgrAddrClear
@@ -723,6 +728,7 @@ void bdb_TCProcessJoiningList(void)
             osal_nv_write_ex( ZCD_NV_EX_TCLK_TABLE, keyNvIndex,
                               sizeof(APSME_TCLinkKeyNVEntry_t),
                               &TCLKDevEntry );
+            ZDSecMgrTCLinkKeyIdxSet( keyNvIndex, TCLKDevEntry.extAddr );
           }
         }
 
@@ -988,7 +994,7 @@ void bdb_StartCommissioning(uint8_t mode)
               uint16_t entryIndex;
               APSME_TCLinkKeyNVEntry_t APSME_TCLKDevEntry;
 
-              entryIndex = APSME_SearchTCLinkKeyEntry(AIB_apsTrustCenterAddress, &found, &APSME_TCLKDevEntry);
+              entryIndex = ZDSecMgrTCLinkKeySearch(AIB_apsTrustCenterAddress, &found, &APSME_TCLKDevEntry);
 
             //If we must perform the TCLK exchange and we didn't complete it, then reset to FN
             if(requestNewTrustCenterLinkKey && (APSME_TCLKDevEntry.keyAttributes != ZG_NON_R21_NWK_JOINED) && (APSME_TCLKDevEntry.keyAttributes != ZG_VERIFIED_KEY))
@@ -1001,6 +1007,7 @@ void bdb_StartCommissioning(uint8_t mode)
                 osal_nv_write_ex(ZCD_NV_EX_TCLK_TABLE, entryIndex,
                                 sizeof(APSME_TCLinkKeyNVEntry_t),
                                 &APSME_TCLKDevEntry);
+                ZDSecMgrTCLinkKeyIdxSet(entryIndex, APSME_TCLKDevEntry.extAddr);
 
                 TCLinkKeyRAMEntry[entryIndex].txFrmCntr = 0;
                 TCLinkKeyRAMEntry[entryIndex].rxFrmCntr = 0;
@@ -2742,6 +2749,15 @@ uint32_t bdb_event_loop(byte task_id, uint32_t events)
     return (events ^ BDB_REPORT_TIMEOUT);
   }
 
+  if(events & BDB_REPORT_COALESCE_TIMEOUT)
+  {
+#ifdef BDB_REPORTING
+    bdb_RepProcessCoalesceEvent();
+#endif
+    // Return unprocessed events
+    return (events ^ BDB_REPORT_COALESCE_TIMEOUT);
+  }
+
 #if (ZG_BUILD_JOINING_TYPE)
   if(events & BDB_TC_LINK_KEY_EXCHANGE_FAIL)
   {
@@ -2956,7 +2972,7 @@ static void bdb_ProcessNodeDescRsp(zdoIncomingMsg_t *pMsg)
           uint8_t entryFound;
           uint16_t entryIndex;
           // Find TCLK entry with TC extAddr
-          entryIndex = APSME_SearchTCLinkKeyEntry(AIB_apsTrustCenterAddress,&entryFound,&TCLKDevEntry);
+          entryIndex = ZDSecMgrTCLinkKeySearch(AIB_apsTrustCenterAddress,&entryFound,&TCLKDevEntry);
 
           if(entryIndex < gZDSECMGR_TC_DEVICE_MAX)
           {
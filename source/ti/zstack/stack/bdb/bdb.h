@@ -372,12 +372,23 @@ struct bdb_joiningDeviceList_node*  nextDev;
 #define BDB_TC_LINK_KEY_EXCHANGE_FAIL             0x0002
 #define BDB_CHANGE_COMMISSIONING_STATE            0x0004
 #define BDB_REPORT_TIMEOUT                        0x0080
+#define BDB_REPORT_COALESCE_TIMEOUT               0x0100
 #define BDB_FINDING_AND_BINDING_PERIOD_TIMEOUT    0x0040
 #define BDB_TC_JOIN_TIMEOUT                       0x0800
 #define BDB_PROCESS_TIMEOUT                       0x1000
 #define BDB_IDENTIFY_TIMEOUT                      0x2000
 #define BDB_RESPONDENT_PROCESS_TIMEOUT            0x4000
 
+#ifdef BDB_REPORTING
+//Reporting counters, see bdb_RepGetStats
+typedef struct
+{
+  uint32_t numReportsSent;        // report commands sent, periodic or on change
+  uint32_t numChangesCoalesced;   // changes merged into a report already pending
+  uint32_t numChangesSuppressed;  // changes dropped for being within minReportInt
+} bdbRepStats_t;
+#endif
+
 //Msg event status
 #define BDB_MSG_EVENT_SUCCESS             0
 #define BDB_MSG_EVENT_FAIL                1
@@ -722,6 +733,23 @@ ZStatus_t bdb_RepAddAttrCfgRecordDefaultToList( uint8_t endpoint, uint16_t clust
  *          attribute value to validate the triggering of a reporting attribute message.
  */
 ZStatus_t bdb_RepChangedAttrValue(uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID); //newvalue must a a buffer of size 8
+
+/*
+ * @brief   Set the window in milliseconds during which attribute changes of a
+ *          cluster-endpoint are merged into a single report.
+ */
+ZStatus_t bdb_RepSetCoalesceWindow( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t windowMs );
+
+/*
+ * @brief   Get the counters of reports sent and attribute changes that did not
+ *          produce a report of their own.
+ */
+void bdb_RepGetStats( bdbRepStats_t *pStats );
+
+/*
+ * @brief   Clear the reporting counters.
+ */
+void bdb_RepResetStats( void );
 #endif
 
 /*****************************
@@ -219,6 +219,13 @@ extern "C"
 #define BDB_MAX_CLUSTERENDPOINTS_REPORTING    5
 #endif
 
+//Default window in milliseconds during which attribute changes of a
+//cluster-endpoint are merged into a single report, bounded by the consolidated
+//minReportInt of the cluster-endpoint. 0 reports every change immediately.
+#ifndef BDBREPORTING_COALESCE_WINDOW
+#define BDBREPORTING_COALESCE_WINDOW    0
+#endif
+
 //Default values contants used in the bdb reporting code
 #define BDBREPORTING_DEFAULTMAXINTERVAL    BDBREPORTING_REPORTOFF
 #define BDBREPORTING_DEFAULTMININTERVAL    0x000A
@@ -69,7 +69,26 @@
  * CONSTANTS
  */
 #define BDBREPORTING_HASBINDING_FLAG_MASK      0x01
-#define BDBREPORTING_NONEXTINCREMENT_FLAG_MASK 0x02
+#define BDBREPORTING_PENDING_FLAG_MASK         0x02
+
+// Number of buckets of the cluster-endpoint lookup index, must be a power of 2
+#ifndef BDBREPORTING_CLUSTERENDPOINT_HASH_SIZE
+#define BDBREPORTING_CLUSTERENDPOINT_HASH_SIZE 16
+#endif
+
+#define BDBREPORTING_HASH( endpoint, cluster, manuCode, direction ) \
+  ( (uint8_t)( (endpoint) ^ (cluster) ^ ((cluster) >> 8) ^ (manuCode) ^ ((direction) << 3) ) & \
+    ( BDBREPORTING_CLUSTERENDPOINT_HASH_SIZE - 1 ) )
+
+// Largest report payload built, frames are also bounded by the data request MTU
+#ifndef BDBREPORTING_MAX_FRAME_LEN
+#define BDBREPORTING_MAX_FRAME_LEN 100
+#endif
+
+// Absolute time (seconds) of the next periodic report of an entry
+#define BDBREPORTING_DEADLINE( index ) \
+  ( bdb_reportingClusterEndpointArray[(index)].lastReportTime + \
+    bdb_reportingClusterEndpointArray[(index)].consolidatedMaxReportInt )
 
 
 #if BDBREPORTING_MAX_ANALOG_ATTR_SIZE == 8
@@ -146,7 +165,11 @@ typedef struct
   uint16_t  manuCode;         //add by luoyiming, 2019-10-21
   uint16_t  consolidatedMinReportInt;             // attribute ID
   uint16_t  consolidatedMaxReportInt;           // attribute data type
-  uint16_t  timeSinceLastReport;
+  uint32_t  lastReportTime;     // reporting time (seconds) of the last periodic report
+  uint8_t   heapPos;            // position in the deadline heap, INVALIDINDEX if not scheduled
+  uint8_t   hashNext;           // next entry in the same lookup bucket
+  uint16_t  coalesceWindow;     // ms to merge attribute changes into one report, 0 reports immediately
+  uint32_t  coalesceDeadline;   // coalescing time (ms) at which the pending report is sent
   bdbAttrLinkedListAttr_t attrLinkedList;
 } bdbReportAttrClusterEndpoint_t;
 
@@ -160,6 +183,8 @@ typedef struct
   uint8_t  direction;  //add by luoyiming, 2020-01-07
   uint16_t  cluster;
   uint16_t  manuCode;  //add by luoyiming, 2019-10-21
+  uint16_t  coalesceWindow;
+  uint32_t  coalesceDeadline;
 } bdbReportFlagsHolder_t;
 
 //This structure holds the data of a default attribute reporting configuration
@@ -220,9 +245,26 @@ bdbReportAttrClusterEndpoint_t bdb_reportingClusterEndpointArray[BDB_MAX_CLUSTER
 uint8_t bdb_reportingClusterEndpointArrayCount;
 //This variable has the timeout value of the currrent timer use to report peridically
 uint16_t bdb_reportingNextEventTimeout;
-//This variable hasthe index of the cluster-endpoint entry that trigger the current
-//timer use to report periodically
-uint8_t bdb_reportingNextClusterEndpointIndex;
+//Reporting time in seconds at which the current timer was started, advanced
+//every time the timer expires or is stopped
+uint32_t bdb_reportingClock;
+//Min-heap of cluster-endpoint indexes ordered by next periodic report deadline
+uint8_t bdb_reportingHeap[BDB_MAX_CLUSTERENDPOINTS_REPORTING];
+//Current size of the deadline heap
+uint8_t bdb_reportingHeapCount;
+//Lookup index of the cluster-endpoint table, first entry index of each bucket
+uint8_t bdb_reportingClusterEndpointHash[BDBREPORTING_CLUSTERENDPOINT_HASH_SIZE];
+//Number of cluster-endpoint entries waiting for their coalescing window to close
+uint8_t bdb_reportingPendingCount;
+//Coalescing time in milliseconds at which the window timer was started,
+//advanced every time the timer expires, is re-armed or is stopped
+uint32_t bdb_reportingCoalesceClock;
+//Timeout the window timer was armed with, 0 if it is not running
+uint16_t bdb_reportingCoalesceTimeout;
+//Reports sent and changes merged or suppressed
+bdbRepStats_t bdb_reportingStats;
+//Report frame being built, starts with room for the ZCL header
+uint8_t bdb_reportingFrameBuf[ZCL_FRAME_HDR_MAX_LEN + BDBREPORTING_MAX_FRAME_LEN];
 //This is the table that holds in the memory the attribute reporting configurations (dynamic table)
 bdbReportAttrCfgData_t* bdb_reportingAttrCfgRecordsArray;
 //Current size of the attribute reporting configurations table
@@ -251,19 +293,21 @@ static bdbLinkedListAttrItem_t* bdb_linkedListAttrSearch( bdbAttrLinkedListAttr_
 static bdbReportAttrLive_t* bdb_linkedListAttrRemove( bdbAttrLinkedListAttr_t *list );
 static uint8_t bdb_linkedListAttrFreeAll( bdbAttrLinkedListAttr_t *list );
 static void bdb_linkedListAttrClearList( bdbAttrLinkedListAttr_t *list );
-static bdbLinkedListAttrItem_t* bdb_linkedListAttrGetAtIndex( bdbAttrLinkedListAttr_t *list, uint8_t index );
 //End: Single Linked List methods
 
 //Begin: Cluster-endpoint array live methods
 static void bdb_clusterEndpointArrayInit( void );
-static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t consolidatedMinReportInt, uint16_t consolidatedMaxReportInt, uint16_t timeSinceLastReport );
+static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t consolidatedMinReportInt, uint16_t consolidatedMaxReportInt, uint32_t lastReportTime );
+static uint8_t bdb_clusterEndpointArrayIsScheduled( uint8_t index );
 static uint8_t bdb_clusterEndpointArrayGetMin( void );
-static void bdb_clusterEndpointArrayMoveTo( uint8_t indexSrc, uint8_t indexDest );
-static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTimeSinceLastReport, uint8_t markHasBinding, uint8_t noNextIncrement );
+static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint32_t newLastReportTime, uint8_t markHasBinding, uint8_t noNextIncrement );
 static void bdb_clusterEndpointArrayFreeAll( void );
 static uint8_t bdb_clusterEndpointArraySearch( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction );
-static uint8_t bdb_clusterEndpointArrayRemoveAt( uint8_t index );
-static void bdb_clusterEndpointArrayIncrementAll( uint16_t timeSinceLastReportIncrement, uint8_t CheckNoIncrementFlag );
+static void bdb_repHeapSet( uint8_t pos, uint8_t index );
+static void bdb_repHeapSiftUp( uint8_t pos );
+static void bdb_repHeapSiftDown( uint8_t pos );
+static void bdb_repHeapUpdate( uint8_t index );
+static void bdb_repHeapRebuild( void );
 //End: Cluster-endpoint array live methods
 
 //Begin: Single linked list default attr cfg records methods
@@ -292,16 +336,25 @@ static uint8_t bdb_RepConstructAttrCfgArray( void );
 static void bdb_RepInitAttrCfgRecords( void );
 
 static endPointDesc_t* bdb_FindEpDesc( uint8_t endPoint );
+static CONST zclAttrRec_t* bdb_RepFindAttrRec( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID );
 static uint8_t bdb_RepFindAttrEntry( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID, zclAttribute_t* attrRes );
 static uint8_t bdb_RepLoadCfgRecords( void );
 static uint8_t bdb_isAttrValueChangedSurpassDelta( uint8_t datatype, uint8_t* delta, uint8_t* curValue, uint8_t* lastValue );
 static uint16_t bdb_RepCalculateEventElapsedTime( uint32_t remainingTimeoutTimer, uint16_t nextEventTimeout );
+static uint32_t bdb_RepGetTime( void );
 static void bdb_RepRestartNextEventTimer( void );
 
 static void bdb_RepStartReporting( void );
 static void bdb_RepStopEventTimer( void );
 static void bdb_RepSetupReporting( void );
 static void bdb_RepReport( uint8_t indexClusterEndpoint );
+static void bdb_RepSendReportFrame( bdbReportAttrClusterEndpoint_t* clusterEndpointItem, afAddrType_t *dstAddr,
+                                    zclReportCmd_t *pReportCmd, uint8_t numRecs, uint8_t payloadLen );
+static void bdb_RepFreeReadData( uint8_t **ppReadData, uint8_t numRecs );
+static uint16_t bdb_RepGetCoalesceWindow( uint8_t indexClusterEndpoint );
+static void bdb_RepClearPending( uint8_t indexClusterEndpoint );
+static uint32_t bdb_RepGetCoalesceTime( void );
+static void bdb_RepRestartCoalesceTimer( void );
 
 extern zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint ); //Definition is located in zcl.h
 
@@ -321,6 +374,9 @@ extern zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint ); //Definition is
 void bdb_RepInit( void )
 {
   bdb_reportingNextEventTimeout = 0;
+  bdb_reportingClock = 0;
+  bdb_reportingCoalesceClock = 0;
+  bdb_reportingCoalesceTimeout = 0;
   bdb_reportingAcceptDefaultConfs = BDBREPORTING_TRUE;
   bdb_repAttrCfgRecordsArrayInit( );
   bdb_repAttrDefaultCfgRecordsLinkedListInit( &attrDefaultCfgRecordLinkedList );
@@ -360,6 +416,9 @@ void bdb_RepConstructReportingData( void )
  * @param       cluster - cluster id of the entry to locate
  * @param       manuCode - manuCode of the entry to locate, add by luoyiming 2020-01-07
  * @param       direction - direction of the entry to locate, add by luoyiming 2020-01-07
+ * @param       unMark - BDBREPORTING_TRUE to clear the binding flag
+ * @param       setNoNextIncrementFlag - kept for compatibility, the periodic
+ *              interval always restarts from the current reporting time
  *
  * @return      none
  */
@@ -374,11 +433,11 @@ void bdb_RepMarkHasBindingInEndpointClusterArray( uint8_t endpoint, uint16_t clu
     {
       if( unMark == BDBREPORTING_TRUE )
       {
-        bdb_clusterEndpointArrayUpdateAt( foundIndex, 0, BDBREPORTING_FALSE, setNoNextIncrementFlag );
+        bdb_clusterEndpointArrayUpdateAt( foundIndex, bdb_RepGetTime( ), BDBREPORTING_FALSE, setNoNextIncrementFlag );
       }
       else
       {
-        bdb_clusterEndpointArrayUpdateAt( foundIndex, 0, BDBREPORTING_TRUE, setNoNextIncrementFlag );
+        bdb_clusterEndpointArrayUpdateAt( foundIndex, bdb_RepGetTime( ), BDBREPORTING_TRUE, setNoNextIncrementFlag );
       }
     }
   }
@@ -399,9 +458,7 @@ static void bdb_RepStartReporting( void )
   if( !OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT ) )
   {
     //timerElapsedTime is zero
-    OsalPortTimers_stopTimer( bdb_TaskID, BDB_REPORT_TIMEOUT );
-    bdb_reportingNextEventTimeout = 0;
-    bdb_reportingNextClusterEndpointIndex = BDBREPORTING_INVALIDINDEX;
+    bdb_RepStopEventTimer( );
     //Start Timer
     bdb_RepRestartNextEventTimer( );
   }
@@ -411,30 +468,15 @@ static void bdb_RepStartReporting( void )
  * @fn          bdb_RepStartOrContinueReporting
  *
  * @brief       Restarts the periodic reporting timer, if the timer was already
- *              running it calculates the remaining time of timer before stopping it,
- *              then sustracts this elapsed time from the next event endpoint-cluster
- *              table.
+ *              running its elapsed time is added to the reporting time before
+ *              stopping it, then the timer is armed for the earliest deadline.
  *
  * @return      none
  */
 void bdb_RepStartOrContinueReporting( void )
 {
-  //Stop if reporting timer is active
-  uint32_t remainingTimeOfEvent = OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT );
-  if( remainingTimeOfEvent == 0 )
-  {
-    //Timer was not running
-    bdb_RepStartReporting( );
-  }
-  else
-  {
-    uint16_t elapsedTime = bdb_RepCalculateEventElapsedTime( remainingTimeOfEvent, bdb_reportingNextEventTimeout );
-    bdb_RepStopEventTimer( );
-
-    bdb_clusterEndpointArrayIncrementAll( elapsedTime, BDBREPORTING_TRUE );
-    bdb_RepStartReporting( );
-  }
-
+  bdb_RepStopEventTimer( );
+  bdb_RepStartReporting( );
 }
 
  /*********************************************************************
@@ -458,39 +500,56 @@ static uint16_t bdb_RepCalculateEventElapsedTime( uint32_t remainingTimeoutTimer
   return elapsedTime;
 }
 
+ /*********************************************************************
+ * @fn          bdb_RepGetTime
+ *
+ * @brief       Get the current reporting time, the time at which the running
+ *              timer started plus its elapsed time.
+ *
+ * @return      reporting time in seconds
+ */
+static uint32_t bdb_RepGetTime( void )
+{
+  uint32_t remainingTimeOfEvent = OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT );
+  if( remainingTimeOfEvent == 0 )
+  {
+    return bdb_reportingClock;
+  }
+  return bdb_reportingClock + bdb_RepCalculateEventElapsedTime( remainingTimeOfEvent, bdb_reportingNextEventTimeout );
+}
+
  /*********************************************************************
  * @fn          bdb_RepProcessEvent
  *
  * @brief       Method that process the timer expired event in the reporting
- *              code, it calculate the next cluster-endpoint entry based
- *              on the minimum with consolidatedMaxReportInt - timeSinceLastReport,
- *              updates timeSinceLastReport of all entries. If the minimum is zero,
- *              report the cluster-endpoint attrs.
+ *              code, it advances the reporting time by the expired timeout and
+ *              reports every cluster-endpoint entry whose deadline
+ *              (lastReportTime + consolidatedMaxReportInt) was reached, then
+ *              arms the timer for the earliest remaining deadline.
  *
  * @return      none
  */
 void bdb_RepProcessEvent( void )
 {
-  bdb_clusterEndpointArrayIncrementAll( bdb_reportingNextEventTimeout, BDBREPORTING_FALSE );
-  uint8_t minIndex =  bdb_clusterEndpointArrayGetMin( );
-  if( minIndex == BDBREPORTING_INVALIDINDEX )
+  uint8_t minIndex;
+
+  if( OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT ) > 0 )
   {
+    //Stale event, the timer was restarted before this event was processed
     return;
   }
-   uint16_t minVal = bdb_reportingClusterEndpointArray[minIndex].consolidatedMaxReportInt - bdb_reportingClusterEndpointArray[minIndex].timeSinceLastReport;
-   if( minVal>0 )
-   {
-     bdb_reportingNextEventTimeout = minVal;
-   }
-   else
-   {
-     //Something was triggered, report clusterEndpoint with minIndex
-     bdb_reportingNextClusterEndpointIndex = minIndex;
-     bdb_RepReport( BDBREPORTING_INVALIDINDEX );
-     bdb_clusterEndpointArrayUpdateAt( minIndex, 0, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE );
-     bdb_reportingNextEventTimeout = 0;
-   }
-   bdb_RepRestartNextEventTimer( );
+  bdb_reportingClock += bdb_reportingNextEventTimeout;
+  bdb_reportingNextEventTimeout = 0;
+
+  minIndex = bdb_clusterEndpointArrayGetMin( );
+  while( ( minIndex != BDBREPORTING_INVALIDINDEX ) && ( BDBREPORTING_DEADLINE( minIndex ) <= bdb_reportingClock ) )
+  {
+    //Something was triggered, report clusterEndpoint with minIndex
+    bdb_RepReport( minIndex );
+    bdb_clusterEndpointArrayUpdateAt( minIndex, bdb_reportingClock, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE );
+    minIndex = bdb_clusterEndpointArrayGetMin( );
+  }
+  bdb_RepRestartNextEventTimer( );
 }
 
 /*********************************************************************
@@ -823,7 +882,7 @@ void bdb_RepUpdateMarkBindings( void )
     if( numMarkedEntries == 0 ) //No entries
     {
       //Stop Timer
-      OsalPortTimers_stopTimer( bdb_TaskID, BDB_REPORT_TIMEOUT );
+      bdb_RepStopEventTimer( );
     }
   }
   else
@@ -988,37 +1047,6 @@ static void bdb_linkedListAttrClearList( bdbAttrLinkedListAttr_t *list )
   list->numItems = 0;
 }
 
-/*********************************************************************
- * @fn      bdb_linkedListAttrGetAtIndex
- *
- * @brief   Returns the ith element of the list starting from the head
- *
- * @param   list - Pointer to linked list
- *
- * @return  A pointer to the ith node element
- */
-static bdbLinkedListAttrItem_t* bdb_linkedListAttrGetAtIndex( bdbAttrLinkedListAttr_t *list, uint8_t index )
-{
-  if( index > list->numItems-1 )
-  {
-    return NULL;
-  }
-  bdbLinkedListAttrItem_t* cur = list->head;
-  uint8_t i;
-  for( i=0; i<=index; i++ )
-  {
-    if( cur == NULL )
-    {
-      return NULL;
-    }
-    if( i < index )
-    {
-      cur = cur->next;
-    }
-  }
-  return cur;
-}
-
 /*
 * End: Single linked list for attributes in a cluster-endpoint entry methods
 */
@@ -1031,13 +1059,17 @@ static bdbLinkedListAttrItem_t* bdb_linkedListAttrGetAtIndex( bdbAttrLinkedListA
 /*********************************************************************
  * @fn      bdb_clusterEndpointArrayInit
  *
- * @brief   Initiates the clusterEndpoint array variables
+ * @brief   Initiates the clusterEndpoint array variables, the lookup index
+ *          and the deadline heap
  *
  * @return
  */
 static void bdb_clusterEndpointArrayInit( void )
 {
   bdb_reportingClusterEndpointArrayCount = 0;
+  bdb_reportingHeapCount = 0;
+  bdb_reportingPendingCount = 0;
+  memset( bdb_reportingClusterEndpointHash, BDBREPORTING_INVALIDINDEX, sizeof( bdb_reportingClusterEndpointHash ) );
 }
 
 /*********************************************************************
@@ -1048,97 +1080,234 @@ static void bdb_clusterEndpointArrayInit( void )
  * @param   endpoint - Endpoint ID of the entry
  * @param   cluster - Cluster ID of the entry
  * @param   manuCode - manufacture Code of the entry, added by luoyiming 2019-10-21
+ * @param   direction - direction of the entry
  * @param   consolidatedMinReportInterval - Cluster ID of the entry
-
+ * @param   consolidatedMaxReportInterval - Cluster ID of the entry
+ * @param   lastReportTime - reporting time (seconds) the intervals count from
  *
- * @return  A pointer to the ith node element
+ * @return  Status code (BDBREPORTING_SUCCESS or BDBREPORTING_ERROR)
  */
-static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t consolidatedMinReportInt, uint16_t consolidatedMaxReportInt, uint16_t timeSinceLastReport )
+static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t consolidatedMinReportInt, uint16_t consolidatedMaxReportInt, uint32_t lastReportTime )
 {
+  bdbReportAttrClusterEndpoint_t* entry;
+  uint8_t hashIdx;
+
   if( bdb_reportingClusterEndpointArrayCount>=BDB_MAX_CLUSTERENDPOINTS_REPORTING )
   {
     return BDBREPORTING_ERROR;
   }
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].endpoint = endpoint;
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].cluster = cluster;
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].manuCode = manuCode;  //fixed by luoyiming 2019-10-21
-
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].consolidatedMinReportInt = consolidatedMinReportInt;
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].consolidatedMaxReportInt = consolidatedMaxReportInt;
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].timeSinceLastReport = timeSinceLastReport;
-  bdb_linkedListAttrInit( &bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].attrLinkedList );
-  FLAGS_TURNOFFALLFLAGS( bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].flags );
+  entry = &bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount];
+  entry->endpoint = endpoint;
+  entry->cluster = cluster;
+  entry->manuCode = manuCode;  //fixed by luoyiming 2019-10-21
+  entry->direction = direction;
+
+  entry->consolidatedMinReportInt = consolidatedMinReportInt;
+  entry->consolidatedMaxReportInt = consolidatedMaxReportInt;
+  entry->lastReportTime = lastReportTime;
+  entry->heapPos = BDBREPORTING_INVALIDINDEX; // not scheduled until it has a binding
+  entry->coalesceWindow = BDBREPORTING_COALESCE_WINDOW;
+  bdb_linkedListAttrInit( &entry->attrLinkedList );
+  FLAGS_TURNOFFALLFLAGS( entry->flags );
+
+  // link into the lookup index
+  hashIdx = BDBREPORTING_HASH( endpoint, cluster, manuCode, direction );
+  entry->hashNext = bdb_reportingClusterEndpointHash[hashIdx];
+  bdb_reportingClusterEndpointHash[hashIdx] = bdb_reportingClusterEndpointArrayCount;
 
   bdb_reportingClusterEndpointArrayCount++;
   return BDBREPORTING_SUCCESS;
 }
 
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayIsScheduled
+ *
+ * @brief   Check if an entry takes part in periodic reporting, it must have
+ *          a binding and a periodic max interval
+ *
+ * @param   index - index of the entry
+ *
+ * @return  BDBREPORTING_TRUE if the entry must be in the deadline heap
+ */
+static uint8_t bdb_clusterEndpointArrayIsScheduled( uint8_t index )
+{
+  bdbReportAttrClusterEndpoint_t* entry = &bdb_reportingClusterEndpointArray[index];
+
+  if( ( FLAGS_CHECKFLAG( entry->flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE ) &&
+      ( entry->consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC ) &&
+      ( entry->consolidatedMaxReportInt != BDBREPORTING_REPORTOFF ) )
+  {
+    return BDBREPORTING_TRUE;
+  }
+  return BDBREPORTING_FALSE;
+}
+
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayGetMin
+ *
+ * @brief   Get the entry with the earliest periodic report deadline
+ *
+ * @return  index of the entry, BDBREPORTING_INVALIDINDEX if none scheduled
+ */
 static uint8_t bdb_clusterEndpointArrayGetMin( void )
 {
-  uint8_t indexMin = 0xFF;
-  uint16_t ValueMin = 0xFFFF;
-  uint16_t possibleMin;
-  uint8_t i;
-  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  if( bdb_reportingHeapCount == 0 )
   {
-    if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE )
-    { //Only do with valid entries (HasBinding==true)
-      if( bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC &&
-         bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF )
-      {
-        //If maxInterval is BDBREPORTING_NOPERIODIC=0x0000 or BDBREPORTING_REPORTOFF=0xFFFF, ignore to calculate min
-        if( ValueMin == 0 )
-        {
-          //stop if we find a minValue of zero because there no other Min less than that
-          break;
-        }
-        possibleMin = bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt - bdb_reportingClusterEndpointArray[i].timeSinceLastReport;
-        if( possibleMin<ValueMin )
-        {
-          indexMin = i;
-          ValueMin = possibleMin;
-        }
-      }
+    return BDBREPORTING_INVALIDINDEX;
+  }
+  return bdb_reportingHeap[0];
+}
+
+/*********************************************************************
+ * @fn      bdb_repHeapSet
+ *
+ * @brief   Place an entry at a position of the deadline heap
+ *
+ * @param   pos - heap position
+ * @param   index - index of the entry
+ *
+ * @return
+ */
+static void bdb_repHeapSet( uint8_t pos, uint8_t index )
+{
+  bdb_reportingHeap[pos] = index;
+  bdb_reportingClusterEndpointArray[index].heapPos = pos;
+}
+
+/*********************************************************************
+ * @fn      bdb_repHeapSiftUp
+ *
+ * @brief   Move an entry towards the root while its deadline is earlier
+ *          than its parent's
+ *
+ * @param   pos - heap position of the entry
+ *
+ * @return
+ */
+static void bdb_repHeapSiftUp( uint8_t pos )
+{
+  uint8_t index = bdb_reportingHeap[pos];
+  uint32_t deadline = BDBREPORTING_DEADLINE( index );
+  uint8_t parent;
+
+  while( pos > 0 )
+  {
+    parent = ( pos - 1 ) / 2;
+    if( BDBREPORTING_DEADLINE( bdb_reportingHeap[parent] ) <= deadline )
+    {
+      break;
     }
+    bdb_repHeapSet( pos, bdb_reportingHeap[parent] );
+    pos = parent;
   }
-  return indexMin;
+  bdb_repHeapSet( pos, index );
+}
+
+/*********************************************************************
+ * @fn      bdb_repHeapSiftDown
+ *
+ * @brief   Move an entry towards the leaves while a child has an earlier
+ *          deadline
+ *
+ * @param   pos - heap position of the entry
+ *
+ * @return
+ */
+static void bdb_repHeapSiftDown( uint8_t pos )
+{
+  uint8_t index = bdb_reportingHeap[pos];
+  uint32_t deadline = BDBREPORTING_DEADLINE( index );
+  uint16_t child;
 
+  for( ;; )
+  {
+    child = 2 * (uint16_t)pos + 1;
+    if( child >= bdb_reportingHeapCount )
+    {
+      break;
+    }
+    if( ( child + 1 < bdb_reportingHeapCount ) &&
+        ( BDBREPORTING_DEADLINE( bdb_reportingHeap[child + 1] ) < BDBREPORTING_DEADLINE( bdb_reportingHeap[child] ) ) )
+    {
+      child++;
+    }
+    if( deadline <= BDBREPORTING_DEADLINE( bdb_reportingHeap[child] ) )
+    {
+      break;
+    }
+    bdb_repHeapSet( pos, bdb_reportingHeap[child] );
+    pos = (uint8_t)child;
+  }
+  bdb_repHeapSet( pos, index );
 }
 
-static uint8_t bdb_clusterEndpointArrayRemoveAt( uint8_t index )
+/*********************************************************************
+ * @fn      bdb_repHeapUpdate
+ *
+ * @brief   Insert, move or remove an entry in the deadline heap after its
+ *          flags, intervals or last report time changed
+ *
+ * @param   index - index of the entry
+ *
+ * @return
+ */
+static void bdb_repHeapUpdate( uint8_t index )
 {
-  if( index>=bdb_reportingClusterEndpointArrayCount )
+  uint8_t pos = bdb_reportingClusterEndpointArray[index].heapPos;
+
+  if( bdb_clusterEndpointArrayIsScheduled( index ) == BDBREPORTING_TRUE )
   {
-    return BDBREPORTING_ERROR;
+    if( pos == BDBREPORTING_INVALIDINDEX )
+    {
+      pos = bdb_reportingHeapCount++;
+      bdb_repHeapSet( pos, index );
+    }
+    bdb_repHeapSiftUp( pos );
+    bdb_repHeapSiftDown( bdb_reportingClusterEndpointArray[index].heapPos );
+  }
+  else if( pos != BDBREPORTING_INVALIDINDEX )
+  {
+    bdb_reportingClusterEndpointArray[index].heapPos = BDBREPORTING_INVALIDINDEX;
+    bdb_reportingHeapCount--;
+    if( pos < bdb_reportingHeapCount )
+    {
+      // fill the hole with the last entry
+      bdb_repHeapSet( pos, bdb_reportingHeap[bdb_reportingHeapCount] );
+      bdb_repHeapSiftUp( pos );
+      bdb_repHeapSiftDown( bdb_reportingClusterEndpointArray[bdb_reportingHeap[pos]].heapPos );
+    }
   }
-  //Freeing list, all the other fields are not dynamic
-  bdb_linkedListAttrFreeAll( &bdb_reportingClusterEndpointArray[index].attrLinkedList );
-  //moving last element to free slot
-  bdb_clusterEndpointArrayMoveTo( index, bdb_reportingClusterEndpointArrayCount-1 );
-  bdb_reportingClusterEndpointArrayCount--;
-  return BDBREPORTING_SUCCESS;
 }
 
-static void bdb_clusterEndpointArrayMoveTo( uint8_t indexSrc, uint8_t indexDest )
+/*********************************************************************
+ * @fn      bdb_repHeapRebuild
+ *
+ * @brief   Rebuild the deadline heap from the whole clusterEndpoint array
+ *
+ * @return
+ */
+static void bdb_repHeapRebuild( void )
 {
-  bdb_reportingClusterEndpointArray[indexSrc].cluster = bdb_reportingClusterEndpointArray[indexDest].cluster;
-  bdb_reportingClusterEndpointArray[indexSrc].manuCode = bdb_reportingClusterEndpointArray[indexDest].manuCode; //added by luoyiming, 2019-10-21
-  bdb_reportingClusterEndpointArray[indexSrc].endpoint = bdb_reportingClusterEndpointArray[indexDest].endpoint;
-  bdb_reportingClusterEndpointArray[indexSrc].consolidatedMaxReportInt = bdb_reportingClusterEndpointArray[indexDest].consolidatedMaxReportInt;
-  bdb_reportingClusterEndpointArray[indexSrc].consolidatedMinReportInt = bdb_reportingClusterEndpointArray[indexDest].consolidatedMinReportInt;
-  bdb_reportingClusterEndpointArray[indexSrc].timeSinceLastReport = bdb_reportingClusterEndpointArray[indexDest].timeSinceLastReport;
-  bdb_reportingClusterEndpointArray[indexSrc].attrLinkedList = bdb_reportingClusterEndpointArray[indexDest].attrLinkedList;
-  bdb_reportingClusterEndpointArray[indexSrc].flags = bdb_reportingClusterEndpointArray[indexDest].flags;
-  bdb_linkedListAttrClearList( &bdb_reportingClusterEndpointArray[indexDest].attrLinkedList );
+  uint8_t i;
+
+  bdb_reportingHeapCount = 0;
+  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  {
+    bdb_reportingClusterEndpointArray[i].heapPos = BDBREPORTING_INVALIDINDEX;
+  }
+  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  {
+    bdb_repHeapUpdate( i );
+  }
 }
 
-static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTimeSinceLastReport, uint8_t markHasBinding, uint8_t markNoNextIncrement )
+static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint32_t newLastReportTime, uint8_t markHasBinding, uint8_t markNoNextIncrement )
 {
   if( index >= bdb_reportingClusterEndpointArrayCount )
   {
     return BDBREPORTING_ERROR;
   }
-  bdb_reportingClusterEndpointArray[index].timeSinceLastReport = newTimeSinceLastReport;
+  bdb_reportingClusterEndpointArray[index].lastReportTime = newLastReportTime;
   if( markHasBinding != BDBREPORTING_IGNORE )
   {
     if( markHasBinding == BDBREPORTING_TRUE )
@@ -1150,83 +1319,41 @@ static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTime
       FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_HASBINDING_FLAG_MASK );
     }
   }
-  if( markNoNextIncrement != BDBREPORTING_IGNORE )
-  {
-    if( markNoNextIncrement == BDBREPORTING_TRUE )
-    {
-      FLAGS_TURNONFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK );
-    }
-    else
-    {
-      FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK );
-    }
-  }
+  // Deadlines are absolute, an entry updated here already counts from
+  // newLastReportTime so there is no increment to skip any more
+  (void)markNoNextIncrement;
+
+  bdb_repHeapUpdate( index );
   return BDBREPORTING_SUCCESS;
 }
 
 static void bdb_clusterEndpointArrayFreeAll( )
 {
   uint8_t i;
-  uint8_t numElements = bdb_reportingClusterEndpointArrayCount;
-  for( i=0; i<numElements; i++ )
+  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
   {
-    bdb_clusterEndpointArrayRemoveAt( 0 );
+    //Freeing list, all the other fields are not dynamic
+    bdb_linkedListAttrFreeAll( &bdb_reportingClusterEndpointArray[i].attrLinkedList );
   }
+  bdb_clusterEndpointArrayInit( );
 }
 
 static uint8_t bdb_clusterEndpointArraySearch( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction )
 {
-  uint8_t i;
-  uint8_t foundIndex = BDBREPORTING_INVALIDINDEX;
-  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  uint8_t i = bdb_reportingClusterEndpointHash[BDBREPORTING_HASH( endpoint, cluster, manuCode, direction )];
+
+  while( i != BDBREPORTING_INVALIDINDEX )
   {
-    if( bdb_reportingClusterEndpointArray[i].endpoint == endpoint && 
+    if( bdb_reportingClusterEndpointArray[i].endpoint == endpoint &&
         bdb_reportingClusterEndpointArray[i].cluster == cluster &&
         bdb_reportingClusterEndpointArray[i].manuCode == manuCode &&  // fixed by luoyiming, 2020-01-08.
         bdb_reportingClusterEndpointArray[i].direction == direction ) // fixed by luoyiming, 2020-01-07.
     {
-      foundIndex = i;
       break;
     }
+    i = bdb_reportingClusterEndpointArray[i].hashNext;
   }
-  return foundIndex;
-}
-
-static void bdb_clusterEndpointArrayIncrementAll( uint16_t timeSinceLastReportIncrement, uint8_t CheckNoIncrementFlag )
-{
-  uint8_t i;
-  uint8_t doIncrement;
-  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
-  {
-    doIncrement = BDBREPORTING_FALSE;
-    if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE )
-    {
-      //Only do with valid entries (HasBinding==true)
-      if( CheckNoIncrementFlag == BDBREPORTING_FALSE )
-      {
-        doIncrement = BDBREPORTING_TRUE;
-      }
-      else
-      {
-        if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ) == BDBREPORTING_FALSE )
-        {
-          doIncrement = BDBREPORTING_TRUE;
-        }
-      }
-      if( doIncrement == BDBREPORTING_TRUE )
-      {
-        if( bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC &&  bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF )
-        {
-          bdb_reportingClusterEndpointArray[i].timeSinceLastReport = (bdb_reportingClusterEndpointArray[i].timeSinceLastReport+timeSinceLastReportIncrement
-                                                                      > bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt)?
-                                                                      bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt:
-                                                                      bdb_reportingClusterEndpointArray[i].timeSinceLastReport+timeSinceLastReportIncrement;
-        }
-      }
-      FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ); //Always turn off, one shot functionality
-
-    }
-  }
+  return i;
 }
 
 /*
@@ -1488,7 +1615,7 @@ static uint8_t bdb_repAttrBuildClusterEndPointArrayBasedOnConfRecordsArray( void
                                                             &consolidatedMinReportInt, &consolidatedMaxReportInt );
       if( status == BDBREPORTING_SUCCESS )
       {
-        status = bdb_clusterEndpointArrayAdd( curEndpoint, curCluster, curManuCode, curDirection, consolidatedMinReportInt, consolidatedMaxReportInt, 0 );
+        status = bdb_clusterEndpointArrayAdd( curEndpoint, curCluster, curManuCode, curDirection, consolidatedMinReportInt, consolidatedMaxReportInt, bdb_reportingClock );
         if( status == BDBREPORTING_SUCCESS )
         {
           //disable un-config attribute reporting. add by luoyiming
@@ -1718,94 +1845,363 @@ static uint8_t bdb_RepLoadCfgRecords( void )
 
 }
 
+/*********************************************************************
+ * @fn      bdb_RepReport
+ *
+ * @brief   Report all the attributes of a cluster-endpoint entry. Attributes
+ *          with storage are serialized from it straight into the frame buffer,
+ *          attributes handled by the application callback are read into a
+ *          buffer of their own. The records are split in as many frames as
+ *          needed to fit the data request MTU.
+ *
+ * @param   specificCLusterEndpointIndex - index of the entry
+ *
+ * @return
+ */
 static void bdb_RepReport( uint8_t specificCLusterEndpointIndex )
 {
   afAddrType_t dstAddr;
   zclReportCmd_t *pReportCmd = NULL;
-  uint8_t i;
+  uint8_t **ppReadData = NULL;
+  bdbLinkedListAttrItem_t* attrListItem;
+  CONST zclAttrRec_t *pAttrRec;
+  uint8_t *pAttrData;
+  uint8_t *pReadData;
+  uint8_t *pPayload = &bdb_reportingFrameBuf[ZCL_FRAME_HDR_MAX_LEN];
+  uint8_t *pBuf;
+  uint16_t dataLen;
+  uint16_t recLen;
+  uint8_t maxLen;
+  uint8_t numRecs = 0;
 
   bdbReportAttrClusterEndpoint_t* clusterEndpointItem = NULL;
-  if( specificCLusterEndpointIndex == BDBREPORTING_INVALIDINDEX )
-  {
-    if( bdb_reportingNextClusterEndpointIndex < bdb_reportingClusterEndpointArrayCount )
-    {
-      clusterEndpointItem = &(bdb_reportingClusterEndpointArray[bdb_reportingNextClusterEndpointIndex]);
-    }
-  }
-  else
+  if( specificCLusterEndpointIndex < bdb_reportingClusterEndpointArrayCount )
   {
     clusterEndpointItem = &(bdb_reportingClusterEndpointArray[specificCLusterEndpointIndex]);
+    //This report carries every change waiting in the coalescing window
+    bdb_RepClearPending( specificCLusterEndpointIndex );
   }
 
-  // actually send the report
-  if( (clusterEndpointItem != NULL) &&
-      (clusterEndpointItem->consolidatedMaxReportInt != ZCL_REPORTING_OFF) &&
-      (clusterEndpointItem->attrLinkedList.numItems)
+  if( (clusterEndpointItem == NULL) ||
+      (clusterEndpointItem->consolidatedMaxReportInt == ZCL_REPORTING_OFF) ||
+      (clusterEndpointItem->attrLinkedList.numItems == 0)
     )
   {
-    uint8_t *pAttrData = NULL;
-    uint8_t *pAttrDataTemp = NULL;
-    dstAddr.addrMode = (afAddrMode_t)AddrNotPresent;
-    dstAddr.addr.shortAddr = 0;
-    dstAddr.endPoint = clusterEndpointItem->endpoint;
-    dstAddr.panId = _NIB.nwkPanId;
+    return;
+  }
+
+  dstAddr.addrMode = (afAddrMode_t)AddrNotPresent;
+  dstAddr.addr.shortAddr = 0;
+  dstAddr.endPoint = clusterEndpointItem->endpoint;
+  dstAddr.panId = _NIB.nwkPanId;
+
+  maxLen = zcl_GetCmdPayloadMTU( clusterEndpointItem->endpoint, clusterEndpointItem->cluster,
+                                 dstAddr.addrMode, clusterEndpointItem->manuCode );
+  if( maxLen > BDBREPORTING_MAX_FRAME_LEN )
+  {
+    maxLen = BDBREPORTING_MAX_FRAME_LEN;
+  }
 
+  if( pBdb_SendReportCmdCallback != NULL )
+  {
+    //The callback takes the parsed command, the values read through the
+    //application callback must stay allocated until its frame is sent
     pReportCmd = OsalPort_malloc( sizeof( zclReportCmd_t ) + (clusterEndpointItem->attrLinkedList.numItems * sizeof( zclReport_t )) );
-    pAttrData = OsalPort_malloc(clusterEndpointItem->attrLinkedList.numItems * BDBREPORTING_MAX_ANALOG_ATTR_SIZE);
-    if ( (pReportCmd != NULL) && (pAttrData != NULL) )
+    ppReadData = OsalPort_malloc( clusterEndpointItem->attrLinkedList.numItems * sizeof( uint8_t* ) );
+    if( (pReportCmd == NULL) || (ppReadData == NULL) )
     {
-      pAttrDataTemp = pAttrData;
-      pReportCmd->numAttr = clusterEndpointItem->attrLinkedList.numItems;
-      for ( i = 0; i < clusterEndpointItem->attrLinkedList.numItems; ++ i )
+      if( pReportCmd != NULL )
       {
-        pReportCmd->attrList[i].attrID   = 0xFFFF;
-        pReportCmd->attrList[i].dataType = 0xFF;
-        pReportCmd->attrList[i].attrData = NULL;
+        OsalPort_free( pReportCmd );
+      }
+      if( ppReadData != NULL )
+      {
+        OsalPort_free( ppReadData );
+      }
+      return;
+    }
+  }
 
-        bdbLinkedListAttrItem_t* attrListItem = bdb_linkedListAttrGetAtIndex( &clusterEndpointItem->attrLinkedList, i );
-        if(attrListItem!=NULL)
-        {
-          zclAttribute_t attrRec;
-          pReportCmd->attrList[i].attrID = attrListItem->data->attrID;
-          uint8_t attrRes = bdb_RepFindAttrEntry( clusterEndpointItem->endpoint, clusterEndpointItem->cluster,
-                                                  clusterEndpointItem->manuCode, clusterEndpointItem->direction, //fixed by luoyiming, 2020-01-07
-                                                  attrListItem->data->attrID, &attrRec ); 
-          if( attrRes == BDBREPORTING_TRUE )
-          {
-            pReportCmd->attrList[i].dataType = attrRec.dataType;
-            pReportCmd->attrList[i].attrData = pAttrDataTemp;
-            pAttrDataTemp = OsalPort_memcpy(pAttrDataTemp, attrRec.dataPtr, BDBREPORTING_MAX_ANALOG_ATTR_SIZE);
-            //Update last value reported
-            if( zclAnalogDataType( attrRec.dataType ) )
-            {
-              //Only if the datatype is analog
-              memset( attrListItem->data->lastValueReported,0x00, BDBREPORTING_MAX_ANALOG_ATTR_SIZE );
-              OsalPort_memcpy( attrListItem->data->lastValueReported, attrRec.dataPtr, zclGetDataTypeLength( attrRec.dataType ) );
-            }
-          }
-        }
+  pBuf = pPayload;
+  for( attrListItem = clusterEndpointItem->attrLinkedList.head; attrListItem != NULL; attrListItem = attrListItem->next )
+  {
+    pAttrRec = bdb_RepFindAttrRec( clusterEndpointItem->endpoint, clusterEndpointItem->cluster,
+                                   clusterEndpointItem->manuCode, clusterEndpointItem->direction, //fixed by luoyiming, 2020-01-07
+                                   attrListItem->data->attrID );
+    if( pAttrRec == NULL )
+    {
+      continue;
+    }
+
+    pReadData = NULL;
+    if( pAttrRec->attr.dataPtr != NULL )
+    {
+      pAttrData = pAttrRec->attr.dataPtr;
+      dataLen = zclGetAttrDataLength( pAttrRec->attr.dataType, pAttrData );
+    }
+    else
+    {
+      //No storage, read the value through the application callback
+      dataLen = zcl_GetAttrDataLengthEx( clusterEndpointItem->endpoint, clusterEndpointItem->cluster,
+                                         clusterEndpointItem->manuCode, clusterEndpointItem->direction,
+                                         pAttrRec->attr.attrId );
+      if( dataLen < BDBREPORTING_MAX_ANALOG_ATTR_SIZE )
+      {
+        //Analog values are copied to lastValueReported with their full size
+        dataLen = BDBREPORTING_MAX_ANALOG_ATTR_SIZE;
       }
+      pReadData = OsalPort_malloc( dataLen );
+      if( pReadData == NULL )
+      {
+        continue;
+      }
+      memset( pReadData, 0x00, dataLen );
+      if( zcl_ReadAttrDataEx( clusterEndpointItem->endpoint, clusterEndpointItem->cluster,
+                              clusterEndpointItem->manuCode, clusterEndpointItem->direction,
+                              pAttrRec->attr.attrId, pReadData, &dataLen ) != ZCL_STATUS_SUCCESS )
+      {
+        OsalPort_free( pReadData );
+        continue;
+      }
+      pAttrData = pReadData;
+      dataLen = zclGetAttrDataLength( pAttrRec->attr.dataType, pAttrData );
+    }
 
-      // Trigger callback befor send reporting, don't send reporting if callback returns TRUE, fixed by luoyiming 2019-11-22.
-      uint8_t frameCounter = zcl_getFrameCounter( ); //get current frame counter, uoyiming fix at 2019-11-22.
-      if( ( pBdb_SendReportCmdCallback == NULL ) ||
-          ( FALSE == pBdb_SendReportCmdCallback( clusterEndpointItem->endpoint, &dstAddr, clusterEndpointItem->cluster,
-                                                 pReportCmd, !clusterEndpointItem->direction, BDB_REPORTING_DISABLE_DEFAULT_RSP,
-                                                 clusterEndpointItem->manuCode, frameCounter ) ) )
+    recLen = 2 + 1 + dataLen; // Attribute ID + data type + data
+    if( (pBuf - pPayload) + recLen > maxLen )
+    {
+      //Frame is full, send it and start a new one
+      if( numRecs > 0 )
       {
-        // If callback is invalid, send reporting in task stack, luoyiming fix at 2019-11-22.
-        zcl_StackSendReportCmd( clusterEndpointItem->endpoint, &dstAddr, clusterEndpointItem->cluster,
-                                pReportCmd, !clusterEndpointItem->direction, BDB_REPORTING_DISABLE_DEFAULT_RSP,
-                                clusterEndpointItem->manuCode, frameCounter );
+        bdb_RepSendReportFrame( clusterEndpointItem, &dstAddr, pReportCmd, numRecs, (uint8_t)(pBuf - pPayload) );
+        bdb_RepFreeReadData( ppReadData, numRecs );
+        pBuf = pPayload;
+        numRecs = 0;
       }
+      if( recLen > maxLen )
+      {
+        //Attribute does not fit in a frame by itself
+        if( pReadData != NULL )
+        {
+          OsalPort_free( pReadData );
+        }
+        continue;
+      }
+    }
+
+    *pBuf++ = LO_UINT16( pAttrRec->attr.attrId );
+    *pBuf++ = HI_UINT16( pAttrRec->attr.attrId );
+    *pBuf++ = pAttrRec->attr.dataType;
+    pBuf = zclSerializeData( pAttrRec->attr.dataType, pAttrData, pBuf );
+
+    //Update last value reported
+    if( zclAnalogDataType( pAttrRec->attr.dataType ) )
+    {
+      //Only if the datatype is analog
+      memset( attrListItem->data->lastValueReported,0x00, BDBREPORTING_MAX_ANALOG_ATTR_SIZE );
+      OsalPort_memcpy( attrListItem->data->lastValueReported, pAttrData, zclGetDataTypeLength( pAttrRec->attr.dataType ) );
+    }
+
+    if( pReportCmd != NULL )
+    {
+      pReportCmd->attrList[numRecs].attrID = pAttrRec->attr.attrId;
+      pReportCmd->attrList[numRecs].dataType = pAttrRec->attr.dataType;
+      pReportCmd->attrList[numRecs].attrData = pAttrData;
+      ppReadData[numRecs] = pReadData;
+    }
+    else if( pReadData != NULL )
+    {
+      //Already serialized, nothing else refers to the value
+      OsalPort_free( pReadData );
+    }
+    numRecs++;
+  }
+
+  if( numRecs > 0 )
+  {
+    bdb_RepSendReportFrame( clusterEndpointItem, &dstAddr, pReportCmd, numRecs, (uint8_t)(pBuf - pPayload) );
+    bdb_RepFreeReadData( ppReadData, numRecs );
+  }
+
+  if( pReportCmd != NULL )
+  {
+    OsalPort_free( pReportCmd );
+    OsalPort_free( ppReadData );
+  }
+}
+
+/*********************************************************************
+ * @fn      bdb_RepSendReportFrame
+ *
+ * @brief   Send one report frame serialized in bdb_reportingFrameBuf
+ *
+ * @param   clusterEndpointItem - entry being reported
+ * @param   dstAddr - destination address
+ * @param   pReportCmd - records of the frame for the application callback, NULL if not registered
+ * @param   numRecs - number of attribute records in the frame
+ * @param   payloadLen - length of the serialized records
+ *
+ * @return
+ */
+static void bdb_RepSendReportFrame( bdbReportAttrClusterEndpoint_t* clusterEndpointItem, afAddrType_t *dstAddr,
+                                    zclReportCmd_t *pReportCmd, uint8_t numRecs, uint8_t payloadLen )
+{
+  // Trigger callback befor send reporting, don't send reporting if callback returns TRUE, fixed by luoyiming 2019-11-22.
+  uint8_t frameCounter = zcl_getFrameCounter( ); //get current frame counter, uoyiming fix at 2019-11-22.
+
+  if( pReportCmd != NULL )
+  {
+    pReportCmd->numAttr = numRecs;
+  }
+  if( ( pReportCmd == NULL ) ||
+      ( FALSE == pBdb_SendReportCmdCallback( clusterEndpointItem->endpoint, dstAddr, clusterEndpointItem->cluster,
+                                             pReportCmd, !clusterEndpointItem->direction, BDB_REPORTING_DISABLE_DEFAULT_RSP,
+                                             clusterEndpointItem->manuCode, frameCounter ) ) )
+  {
+    // If callback is invalid, send reporting in task stack, luoyiming fix at 2019-11-22.
+    zcl_SendCommandInPlaceEx( clusterEndpointItem->endpoint, dstAddr, clusterEndpointItem->cluster,
+                              ZCL_CMD_REPORT, FALSE, !clusterEndpointItem->direction, BDB_REPORTING_DISABLE_DEFAULT_RSP,
+                              clusterEndpointItem->manuCode, frameCounter, payloadLen,
+                              &bdb_reportingFrameBuf[ZCL_FRAME_HDR_MAX_LEN], FALSE );
+  }
+  bdb_reportingStats.numReportsSent++;
+}
+
+/*********************************************************************
+ * @fn      bdb_RepFreeReadData
+ *
+ * @brief   Free the attribute values read through the application callback
+ *          for the records of a frame already sent
+ *
+ * @param   ppReadData - value buffer of each record, NULL if not read into one
+ * @param   numRecs - number of attribute records in the frame
+ *
+ * @return
+ */
+static void bdb_RepFreeReadData( uint8_t **ppReadData, uint8_t numRecs )
+{
+  uint8_t i;
+
+  if( ppReadData == NULL )
+  {
+    return;
+  }
+  for( i = 0; i < numRecs; i++ )
+  {
+    if( ppReadData[i] != NULL )
+    {
+      OsalPort_free( ppReadData[i] );
+      ppReadData[i] = NULL;
     }
-    if( (pReportCmd != NULL ) )
+  }
+}
+
+/*********************************************************************
+ * @fn      bdb_RepGetCoalesceWindow
+ *
+ * @brief   Get the coalescing window of a cluster-endpoint entry, bounded by
+ *          its consolidated minReportInt
+ *
+ * @param   indexClusterEndpoint - index of the entry
+ *
+ * @return  window in milliseconds, 0 to report immediately
+ */
+static uint16_t bdb_RepGetCoalesceWindow( uint8_t indexClusterEndpoint )
+{
+  bdbReportAttrClusterEndpoint_t* entry = &bdb_reportingClusterEndpointArray[indexClusterEndpoint];
+
+  if( ( entry->consolidatedMinReportInt != BDBREPORTING_NOLIMIT ) &&
+      ( entry->coalesceWindow > 1000L * entry->consolidatedMinReportInt ) )
+  {
+    return (uint16_t)( 1000L * entry->consolidatedMinReportInt );
+  }
+  return entry->coalesceWindow;
+}
+
+/*********************************************************************
+ * @fn      bdb_RepGetCoalesceTime
+ *
+ * @brief   Get the current coalescing time in milliseconds
+ *
+ * @return  coalescing clock plus the time elapsed on the window timer
+ */
+static uint32_t bdb_RepGetCoalesceTime( void )
+{
+  uint32_t remainingTimeOfEvent;
+
+  if( bdb_reportingCoalesceTimeout == 0 )
+  {
+    return bdb_reportingCoalesceClock;
+  }
+  //An expired timer not processed yet has no time remaining
+  remainingTimeOfEvent = OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_COALESCE_TIMEOUT );
+  if( remainingTimeOfEvent > bdb_reportingCoalesceTimeout )
+  {
+    remainingTimeOfEvent = bdb_reportingCoalesceTimeout;
+  }
+  return bdb_reportingCoalesceClock + ( bdb_reportingCoalesceTimeout - remainingTimeOfEvent );
+}
+
+/*********************************************************************
+ * @fn      bdb_RepRestartCoalesceTimer
+ *
+ * @brief   Arm the window timer for the earliest coalescing deadline of the
+ *          pending cluster-endpoint entries, stop it if none is waiting
+ *
+ * @return
+ */
+static void bdb_RepRestartCoalesceTimer( void )
+{
+  uint32_t now = bdb_RepGetCoalesceTime( );
+  int32_t minRemaining = 0;
+  uint8_t found = BDBREPORTING_FALSE;
+  uint8_t i;
+
+  bdb_reportingCoalesceClock = now;
+  bdb_reportingCoalesceTimeout = 0;
+  OsalPortTimers_stopTimer( bdb_TaskID, BDB_REPORT_COALESCE_TIMEOUT );
+  if( bdb_reportingPendingCount == 0 )
+  {
+    return;
+  }
+  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  {
+    if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_PENDING_FLAG_MASK ) == BDBREPORTING_TRUE )
     {
-      OsalPort_free( pReportCmd );
+      int32_t remaining = (int32_t)( bdb_reportingClusterEndpointArray[i].coalesceDeadline - now );
+      if( ( found == BDBREPORTING_FALSE ) || ( remaining < minRemaining ) )
+      {
+        minRemaining = remaining;
+        found = BDBREPORTING_TRUE;
+      }
     }
-    if ( (pAttrData != NULL) )
+  }
+  if( found == BDBREPORTING_TRUE )
+  {
+    //A deadline already reached is served on the next tick
+    bdb_reportingCoalesceTimeout = ( minRemaining > 0 ) ? (uint16_t)minRemaining : 1;
+    OsalPortTimers_startTimer( bdb_TaskID, BDB_REPORT_COALESCE_TIMEOUT, bdb_reportingCoalesceTimeout );
+  }
+}
+
+/*********************************************************************
+ * @fn      bdb_RepClearPending
+ *
+ * @brief   Take a cluster-endpoint entry out of the coalescing window, the
+ *          window timer is stopped once no entry is waiting
+ *
+ * @param   indexClusterEndpoint - index of the entry
+ *
+ * @return
+ */
+static void bdb_RepClearPending( uint8_t indexClusterEndpoint )
+{
+  if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[indexClusterEndpoint].flags, BDBREPORTING_PENDING_FLAG_MASK ) == BDBREPORTING_TRUE )
+  {
+    FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[indexClusterEndpoint].flags, BDBREPORTING_PENDING_FLAG_MASK );
+    if( --bdb_reportingPendingCount == 0 )
     {
-      OsalPort_free( pAttrData );
+      bdb_RepRestartCoalesceTimer( );
     }
   }
 }
@@ -2003,6 +2399,17 @@ static uint8_t bdb_isAttrValueChangedSurpassDelta( uint8_t datatype, uint8_t* de
 static void bdb_RepRestartNextEventTimer( void )
 {
   uint32_t timeMs;
+  uint32_t deadline;
+  uint8_t minIndex = bdb_clusterEndpointArrayGetMin( );
+
+  if( minIndex == BDBREPORTING_INVALIDINDEX )
+  {
+    //Nothing to report periodically
+    bdb_reportingNextEventTimeout = 0;
+    return;
+  }
+  deadline = BDBREPORTING_DEADLINE( minIndex );
+  bdb_reportingNextEventTimeout = ( deadline > bdb_reportingClock ) ? (uint16_t)( deadline - bdb_reportingClock ) : 0;
   // convert from seconds to milliseconds
   timeMs = 1000L * (bdb_reportingNextEventTimeout);
   OsalPortTimers_startTimer( bdb_TaskID, BDB_REPORT_TIMEOUT, timeMs );
@@ -2012,7 +2419,7 @@ static void bdb_RepSetupReporting( void )
 {
   uint8_t numArrayFlags, i;
   //Stop if reporting timer is active
-  OsalPortTimers_stopTimer( bdb_TaskID, BDB_REPORT_TIMEOUT );
+  bdb_RepStopEventTimer( );
 
   numArrayFlags = bdb_reportingClusterEndpointArrayCount;
   bdbReportFlagsHolder_t* arrayFlags = (bdbReportFlagsHolder_t *)OsalPort_malloc( sizeof( bdbReportFlagsHolder_t )*numArrayFlags );
@@ -2027,6 +2434,8 @@ static void bdb_RepSetupReporting( void )
     arrayFlags[i].manuCode = bdb_reportingClusterEndpointArray[i].manuCode;  //add by luoyiming, 2019-10-21
     arrayFlags[i].direction = bdb_reportingClusterEndpointArray[i].direction; //add by luoyiming, 2020-01-07
     arrayFlags[i].flags =  bdb_reportingClusterEndpointArray[i].flags;
+    arrayFlags[i].coalesceWindow = bdb_reportingClusterEndpointArray[i].coalesceWindow;
+    arrayFlags[i].coalesceDeadline = bdb_reportingClusterEndpointArray[i].coalesceDeadline;
   }
 
   if( bdb_reportingClusterEndpointArrayCount > 0 )
@@ -2043,14 +2452,31 @@ static void bdb_RepSetupReporting( void )
     if( clusterEndpointIndex != BDBREPORTING_INVALIDINDEX )
     {
       bdb_reportingClusterEndpointArray[clusterEndpointIndex].flags = arrayFlags[i].flags;
+      bdb_reportingClusterEndpointArray[clusterEndpointIndex].coalesceWindow = arrayFlags[i].coalesceWindow;
+      bdb_reportingClusterEndpointArray[clusterEndpointIndex].coalesceDeadline = arrayFlags[i].coalesceDeadline;
+      if( FLAGS_CHECKFLAG( arrayFlags[i].flags, BDBREPORTING_PENDING_FLAG_MASK ) == BDBREPORTING_TRUE )
+      {
+        bdb_reportingPendingCount++;
+      }
     }
   }
   OsalPort_free( arrayFlags );
+  //Restored flags decide which entries are scheduled
+  bdb_repHeapRebuild( );
+  //Pending entries dropped by the rebuild are no longer waiting
+  bdb_RepRestartCoalesceTimer( );
 }
 
 
 static void bdb_RepStopEventTimer( void )
 {
+  uint32_t remainingTimeOfEvent = OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT );
+  if( remainingTimeOfEvent > 0 )
+  {
+    //Keep the reporting time running across the stop
+    bdb_reportingClock += bdb_RepCalculateEventElapsedTime( remainingTimeOfEvent, bdb_reportingNextEventTimeout );
+    bdb_reportingNextEventTimeout = 0;
+  }
   OsalPortTimers_stopTimer( bdb_TaskID, BDB_REPORT_TIMEOUT );
 }
 
@@ -2095,18 +2521,18 @@ static endPointDesc_t* bdb_FindEpDesc( uint8_t endPoint )
   return CurrEpDescriptor;
 }
 
-static uint8_t bdb_RepFindAttrEntry( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID, zclAttribute_t* attrRes )
+static CONST zclAttrRec_t* bdb_RepFindAttrRec( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID )
 {
-  epList_t *epCur = epList;
-  uint8_t i;
+  epList_t *epCur;
+  uint16_t i;
+  CONST zclAttrRec_t *pCur;
 
   //valid cluster & manuCode, fixed by luoyiming 2019-10-23
   if ( FALSE == zcl_MatchClusterManuCode( cluster, manuCode ) )
   {
-    return BDBREPORTING_FALSE;
+    return ( NULL );
   }
 
-  zcl_memset(gAttrDataValue, 0, BDBREPORTING_MAX_ANALOG_ATTR_SIZE);
   for ( epCur = epList; epCur != NULL; epCur = epCur->nextDesc )
   {
     if( epCur->epDesc->endPoint == endpoint )
@@ -2115,30 +2541,47 @@ static uint8_t bdb_RepFindAttrEntry( uint8_t endpoint, uint16_t cluster, uint16_
 
       if( (attrItem != NULL) && ( (attrItem->numAttributes > 0) && (attrItem->attrs != NULL) ) )
       {
-        for ( i = 0; i < attrItem->numAttributes; i++ )
+        // binary search the sorted attribute index, then check the records with same ID
+        for ( i = zclFindAttrRecsIdx( attrItem, cluster, attrID ); i < attrItem->numAttributes; i++ )
         {
-          if ( ( attrItem->attrs[i].clusterID == cluster ) && 
-               ( zcl_GetAttrManuCode( attrItem->attrs[i] ) == manuCode ) && 
-               ( attrItem->attrs[i].attr.attrId ==  attrID ) && 
-               ( zcl_matchDirection( attrItem->attrs[i].attr.accessControl, direction ) == TRUE ) ) // fixed by luoyiming, 2020-01-07
+          pCur = zclAttrRecsIdxRec( attrItem, i );
+          if ( ( pCur->clusterID != cluster ) || ( pCur->attr.attrId != attrID ) )
           {
-            uint16_t dataLen;
-
-            attrRes->attrId = attrItem->attrs[i].attr.attrId;
-            attrRes->dataType = attrItem->attrs[i].attr.dataType;
-            attrRes->accessControl = attrItem->attrs[i].attr.accessControl;
-
-            dataLen = zclGetDataTypeLength(attrRes->dataType);
-            zcl_ReadAttrDataEx( endpoint, cluster, manuCode, direction, attrRes->attrId, gAttrDataValue, &dataLen );
-            attrRes->dataPtr = gAttrDataValue;
-            return BDBREPORTING_TRUE;
+            break;
+          }
+          if ( ( zcl_GetAttrManuCode( *pCur ) == manuCode ) &&
+               ( zcl_matchDirection( pCur->attr.accessControl, direction ) == TRUE ) ) // fixed by luoyiming, 2020-01-07
+          {
+            return ( pCur );
           }
         }
       }
     }
   }
-  return BDBREPORTING_FALSE;
- }
+  return ( NULL );
+}
+
+static uint8_t bdb_RepFindAttrEntry( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t attrID, zclAttribute_t* attrRes )
+{
+  CONST zclAttrRec_t *pCur;
+  uint16_t dataLen;
+
+  pCur = bdb_RepFindAttrRec( endpoint, cluster, manuCode, direction, attrID );
+  if ( pCur == NULL )
+  {
+    return BDBREPORTING_FALSE;
+  }
+
+  zcl_memset(gAttrDataValue, 0, BDBREPORTING_MAX_ANALOG_ATTR_SIZE);
+  attrRes->attrId = pCur->attr.attrId;
+  attrRes->dataType = pCur->attr.dataType;
+  attrRes->accessControl = pCur->attr.accessControl;
+
+  dataLen = zclGetDataTypeLength(attrRes->dataType);
+  zcl_ReadAttrDataEx( endpoint, cluster, manuCode, direction, attrRes->attrId, gAttrDataValue, &dataLen );
+  attrRes->dataPtr = gAttrDataValue;
+  return BDBREPORTING_TRUE;
+}
 
 /*
 * End: Ztack zcl helper methods
@@ -2309,20 +2752,14 @@ ZStatus_t bdb_RepChangedAttrValue( uint8_t endpoint, uint16_t cluster, uint16_t
     return ZInvalidParameter; //Attr not found in attributes app data
   }
 
-  //Get time of timer if active
-  uint32_t remainingTimeOfEvent = OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_TIMEOUT );
-  uint16_t elapsedTime = 0;
-  uint8_t isTimeRemaining = BDBREPORTING_FALSE;
-  if( remainingTimeOfEvent > 0 )
-  {
-    elapsedTime = bdb_RepCalculateEventElapsedTime( remainingTimeOfEvent, bdb_reportingNextEventTimeout );
-    isTimeRemaining =  BDBREPORTING_TRUE;
-  }
+  //Get the reporting time, includes the elapsed time of the timer if active
+  uint32_t now = bdb_RepGetTime( );
 
   if( bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt != BDBREPORTING_NOLIMIT &&
-     (bdb_reportingClusterEndpointArray[indexClusterEndpoint].timeSinceLastReport + elapsedTime) <= bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt)
+     (now - bdb_reportingClusterEndpointArray[indexClusterEndpoint].lastReportTime) <= bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt)
   {
       //Attr value has changed before minInterval, ommit reporting
+      bdb_reportingStats.numChangesSuppressed++;
       return ZSuccess;
   }
 
@@ -2341,20 +2778,150 @@ ZStatus_t bdb_RepChangedAttrValue( uint8_t endpoint, uint16_t cluster, uint16_t
     //Attr is discrete, just report without checking the changeValue
   }
 
+  if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[indexClusterEndpoint].flags, BDBREPORTING_PENDING_FLAG_MASK ) == BDBREPORTING_TRUE )
+  {
+    //A report of this cluster-endpoint is already waiting, it will carry this change
+    bdb_reportingStats.numChangesCoalesced++;
+    return ZSuccess;
+  }
+
+  uint16_t coalesceWindow = bdb_RepGetCoalesceWindow( indexClusterEndpoint );
+  if( coalesceWindow > 0 )
+  {
+    //Wait for other attributes to change before reporting
+    uint32_t coalesceDeadline = bdb_RepGetCoalesceTime( ) + coalesceWindow;
+    FLAGS_TURNONFLAG( bdb_reportingClusterEndpointArray[indexClusterEndpoint].flags, BDBREPORTING_PENDING_FLAG_MASK );
+    bdb_reportingClusterEndpointArray[indexClusterEndpoint].coalesceDeadline = coalesceDeadline;
+    bdb_reportingPendingCount++;
+    if( ( bdb_reportingCoalesceTimeout == 0 ) ||
+        ( (int32_t)( coalesceDeadline - ( bdb_reportingCoalesceClock + bdb_reportingCoalesceTimeout ) ) < 0 ) )
+    {
+      //Window closes before the one the timer is armed for
+      bdb_RepRestartCoalesceTimer( );
+    }
+    return ZSuccess;
+  }
+
   //Stop reporting
   bdb_RepStopEventTimer( );
   bdb_RepReport( indexClusterEndpoint );
-  if( isTimeRemaining == BDBREPORTING_TRUE )
-  {
-    bdb_clusterEndpointArrayIncrementAll( elapsedTime, BDBREPORTING_FALSE );
-  }
-  bdb_clusterEndpointArrayUpdateAt( indexClusterEndpoint, 0, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE ); //return time since last report to zero
+  bdb_clusterEndpointArrayUpdateAt( indexClusterEndpoint, bdb_reportingClock, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE ); //restart the periodic interval from now
   //Restart reporting
   bdb_RepStartReporting( );
 
   return ZSuccess;
 }
 
+/*********************************************************************
+ * @fn          bdb_RepSetCoalesceWindow
+ *
+ * @brief       Set the window during which attribute changes of a
+ *              cluster-endpoint are merged into a single report. The window
+ *              never exceeds the consolidated minReportInt of the entry.
+ *
+ * @param       endpoint
+ * @param       cluster
+ * @param       manuCode
+ * @param       direction
+ * @param       windowMs - window in milliseconds, 0 reports every change immediately
+ *
+ * @return      ZInvalidParameter - No endpoint, cluster, manuCode found in the reporting table
+ *              ZSuccess
+ */
+ZStatus_t bdb_RepSetCoalesceWindow( uint8_t endpoint, uint16_t cluster, uint16_t manuCode, uint8_t direction, uint16_t windowMs )
+{
+  uint8_t indexClusterEndpoint = bdb_clusterEndpointArraySearch( endpoint, cluster, manuCode, direction );
+  if( indexClusterEndpoint == BDBREPORTING_INVALIDINDEX )
+  {
+    return ZInvalidParameter;
+  }
+  bdb_reportingClusterEndpointArray[indexClusterEndpoint].coalesceWindow = windowMs;
+  return ZSuccess;
+}
+
+/*********************************************************************
+ * @fn          bdb_RepGetStats
+ *
+ * @brief       Get the counters of reports sent and attribute changes that
+ *              did not produce a report of their own.
+ *
+ * @param       pStats - buffer to copy the counters to
+ *
+ * @return      none
+ */
+void bdb_RepGetStats( bdbRepStats_t *pStats )
+{
+  if( pStats != NULL )
+  {
+    *pStats = bdb_reportingStats;
+  }
+}
+
+/*********************************************************************
+ * @fn          bdb_RepResetStats
+ *
+ * @brief       Clear the reporting counters.
+ *
+ * @return      none
+ */
+void bdb_RepResetStats( void )
+{
+  memset( &bdb_reportingStats, 0, sizeof( bdbRepStats_t ) );
+}
+
+/*********************************************************************
+ * @fn          bdb_RepProcessCoalesceEvent
+ *
+ * @brief       Coalescing window timer expired, send one report for every
+ *              cluster-endpoint whose window has closed, restart their
+ *              periodic interval and arm the timer for the next window.
+ *
+ * @return      none
+ */
+void bdb_RepProcessCoalesceEvent( void )
+{
+  uint32_t now;
+  uint8_t i;
+
+  if( OsalPortTimers_getTimerTimeout( bdb_TaskID, BDB_REPORT_COALESCE_TIMEOUT ) > 0 )
+  {
+    //Stale event, the timer was re-armed before this event was processed
+    return;
+  }
+
+  //Advance the coalescing time by the expired timeout
+  bdb_reportingCoalesceClock += bdb_reportingCoalesceTimeout;
+  bdb_reportingCoalesceTimeout = 0;
+  if( bdb_reportingPendingCount == 0 )
+  {
+    return;
+  }
+  now = bdb_reportingCoalesceClock;
+  //Stop reporting
+  bdb_RepStopEventTimer( );
+  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  {
+    if( ( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_PENDING_FLAG_MASK ) == BDBREPORTING_TRUE ) &&
+        ( (int32_t)( bdb_reportingClusterEndpointArray[i].coalesceDeadline - now ) <= 0 ) )
+    {
+      if( ( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE ) &&
+          ( bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF ) )
+      {
+        bdb_RepReport( i );
+        bdb_clusterEndpointArrayUpdateAt( i, bdb_reportingClock, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE ); //restart the periodic interval from now
+      }
+      else
+      {
+        //Binding or reporting was removed while waiting
+        bdb_RepClearPending( i );
+      }
+    }
+  }
+  //Restart reporting
+  bdb_RepStartReporting( );
+  bdb_RepRestartCoalesceTimer( );
+}
+
 #endif //BDB_REPORTING
 
 /*
@@ -95,6 +95,7 @@ extern bool (*pBdb_SendReportCmdCallback)( uint8_t srcEP, afAddrType_t *dstAddr,
 void bdb_RepInit( void );
 void bdb_RepConstructReportingData( void );
 void bdb_RepProcessEvent( void );
+void bdb_RepProcessCoalesceEvent( void );
 void bdb_RepStartOrContinueReporting( void );
 void bdb_RepMarkHasBindingInEndpointClusterArray( uint8_t endpoint, uint16_t cluster, uint16_t manuCode,
                                                   uint8_t direction, uint8_t unMark, uint8_t setNoNextIncrementFlag );
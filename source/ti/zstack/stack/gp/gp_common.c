@@ -664,31 +664,108 @@ void gp_PopulateField( uint8_t* pField, uint8_t** pData, uint8_t size )
  */
 uint8_t gpLookForGpd( uint16_t currEntryId, uint8_t* pNew )
 {
-  uint8_t status;
+  gpdID_t gpdID;
 
-  uint8_t newEntry[GP_TBL_OPT_AND_GPD_ID_LEN];
-  uint8_t currEntry[GP_TBL_OPT_AND_GPD_ID_LEN];
+  // The proxy table index holds the GPD ID of every entry, no NV read needed
+  gp_TblEntryGetGpdId(pNew, &gpdID);
 
-  zcl_memcpy(newEntry, pNew, GP_TBL_OPT_AND_GPD_ID_LEN);
+  return (gp_ProxyTblIdxFind(&gpdID) == currEntryId);
+}
+
+/*********************************************************************
+ * @fn          gp_TblEntryGetGpdId
+ *
+ * @brief       Get the GPD ID of a proxy or sink table entry. Both tables
+ *              share the layout of the options and GPD ID fields.
+ *
+ * @param       pEntry - proxy or sink table entry
+ *              pGpdID - GPD ID of the entry
+ *
+ * @return      none
+ */
+void gp_TblEntryGetGpdId( uint8_t* pEntry, gpdID_t* pGpdID )
+{
+  pGpdID->appID = GP_GET_APPLICATION_ID(pEntry[GP_TBL_OPT]);
 
-  status = zclport_readNV(ZCL_PORT_PROXY_TABLE_NV_ID, currEntryId,
-                          0,
-                          GP_TBL_OPT_AND_GPD_ID_LEN,
-                          currEntry);
+  if(pGpdID->appID == GP_OPT_APP_ID_IEEE)
+  {
+    zcl_memcpy(pGpdID->id.gpdExtAddr, &pEntry[GP_TBL_GPD_ID], Z_EXTADDR_LEN);
+  }
+  else
+  {
+    zcl_memcpy(&pGpdID->id.srcID, &pEntry[GP_TBL_SRC_ID], sizeof(uint32_t));
+  }
+}
+
+/*********************************************************************
+ * @fn          gp_TblIdxSet
+ *
+ * @brief       Update a table index slot from a proxy or sink table entry
+ *
+ * @param       pIdx - index slot to update
+ *              pEntry - entry stored in the NV slot, NULL if it could
+ *                       not be read
+ *
+ * @return      none
+ */
+void gp_TblIdxSet( gpTblIdx_t* pIdx, uint8_t* pEntry )
+{
+  uint16_t emptyEntry = 0xFFFF;
 
-  if((status == SUCCESS) && (GP_TBL_COMP_APPLICATION_ID( newEntry[GP_TBL_OPT], currEntry[GP_TBL_OPT])))
+  if(pEntry == NULL)
   {
-    if((GP_GET_APPLICATION_ID(newEntry[GP_TBL_OPT]) == GP_OPT_APP_ID_GPD))
+    pIdx->appID = GP_TBL_IDX_UNKNOWN;
+  }
+  else if(zcl_memcmp(&pEntry[GP_TBL_OPT], &emptyEntry, sizeof(uint16_t)))
+  {
+    pIdx->appID = GP_TBL_IDX_EMPTY;
+  }
+  else
+  {
+    pIdx->appID = GP_GET_APPLICATION_ID(pEntry[GP_TBL_OPT]);
+    zcl_memcpy(pIdx->gpdId, &pEntry[GP_TBL_GPD_ID], Z_EXTADDR_LEN);
+  }
+}
+
+/*********************************************************************
+ * @fn          gp_TblIdxFind
+ *
+ * @brief       Look for a GPD, or an empty slot, in a table index
+ *
+ * @param       pIdx - table index
+ *              numEntries - number of slots in the table
+ *              pGpdID - GPD to look for, NULL for the first empty slot
+ *
+ * @return      slot of the entry, GP_TBL_IDX_NOT_FOUND if there is none
+ */
+uint16_t gp_TblIdxFind( gpTblIdx_t* pIdx, uint16_t numEntries, gpdID_t* pGpdID )
+{
+  uint16_t i;
+
+  for(i = 0; i < numEntries; i++, pIdx++)
+  {
+    if(pGpdID == NULL)
     {
-      status = zcl_memcmp(&newEntry[GP_TBL_SRC_ID], &currEntry[GP_TBL_SRC_ID], sizeof(uint32_t));
+      if(pIdx->appID == GP_TBL_IDX_EMPTY)
+      {
+        return i;
+      }
     }
-    else if((GP_GET_APPLICATION_ID(newEntry[GP_TBL_OPT]) == GP_OPT_APP_ID_IEEE))
+    else if(pIdx->appID == GP_GET_APPLICATION_ID(pGpdID->appID))
     {
-      status = zcl_memcmp(&newEntry[GP_TBL_GPD_ID], &currEntry[GP_TBL_GPD_ID], Z_EXTADDR_LEN);
+      if((pGpdID->appID == GP_OPT_APP_ID_GPD) &&
+         zcl_memcmp(&pGpdID->id.srcID, &pIdx->gpdId[GP_TBL_SRC_ID - GP_TBL_GPD_ID], sizeof(uint32_t)))
+      {
+        return i;
+      }
+      else if((pGpdID->appID == GP_OPT_APP_ID_IEEE) &&
+              zcl_memcmp(pGpdID->id.gpdExtAddr, pIdx->gpdId, Z_EXTADDR_LEN))
+      {
+        return i;
+      }
     }
-    return status;
   }
-  return FALSE;
+  return GP_TBL_IDX_NOT_FOUND;
 }
 
 /*********************************************************************
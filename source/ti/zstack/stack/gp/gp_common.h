@@ -123,6 +123,11 @@ extern CONFIG_ITEM uint8_t zgpSharedKey[SEC_KEY_LEN];
 
 #define GP_QUEUE_DATA_SEND_INTERVAL 50
 
+// Proxy/sink table RAM index
+#define GP_TBL_IDX_EMPTY          0xFF    // Slot holds no entry
+#define GP_TBL_IDX_UNKNOWN        0xFE    // Slot not read from NV yet
+#define GP_TBL_IDX_NOT_FOUND      0xFFFF
+
  /*********************************************************************
  * TYPEDEFS
  */
@@ -142,6 +147,13 @@ typedef struct
   uint16_t        GPPAddress;           //Address of the GPP that generates the Notification
 } gpdIndication_t;
 
+// RAM copy of the GPD identity stored in one proxy or sink table slot
+typedef struct
+{
+  uint8_t appID;                  //Application ID, GP_TBL_IDX_EMPTY or GP_TBL_IDX_UNKNOWN
+  uint8_t gpdId[Z_EXTADDR_LEN];   //GPD ID field of the entry, SrcID is the last 4 bytes
+} gpTblIdx_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -205,6 +217,21 @@ extern void gp_PopulateField( uint8_t* pField, uint8_t** pData, uint8_t size );
  */
 extern uint8_t gpLookForGpd( uint16_t currEntryId, uint8_t* pNew );
 
+/*
+ * @brief       Get the GPD ID of a proxy or sink table entry
+ */
+extern void gp_TblEntryGetGpdId( uint8_t* pEntry, gpdID_t* pGpdID );
+
+/*
+ * @brief       Update a table index slot from a proxy or sink table entry
+ */
+extern void gp_TblIdxSet( gpTblIdx_t* pIdx, uint8_t* pEntry );
+
+/*
+ * @brief       Look for a GPD, or an empty slot, in a table index
+ */
+extern uint16_t gp_TblIdxFind( gpTblIdx_t* pIdx, uint16_t numEntries, gpdID_t* pGpdID );
+
 /*
  * @brief       Primitive from dGP stub to GP EndPoint asking how to process a GPDF.
  */
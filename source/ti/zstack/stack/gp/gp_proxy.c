@@ -106,6 +106,7 @@ static ZStatus_t zclGp_CommissioningModeDataIndParse(gp_DataInd_t *pInd, gpCommi
 static ZStatus_t zclGp_DataIndParse(gp_DataInd_t *pInd, gpNotificationCmd_t *pGpNotification);
 static void gp_ZclPairingParse(zclGpPairing_t* pCmd, gpPairingCmd_t* payload);
 static void gp_ZclProxyTableReqParse(zclGpTableRequest_t* pCmd, gpTableReqCmd_t* payload);
+static void gp_ProxyTblIdxSync(void);
 
 /*********************************************************************
  * LOCAL VARIABLES
@@ -114,6 +115,10 @@ static gpCommissioningMode_t  pfnCommissioningMode = NULL;
 static gpChangeChannelReq_t   pfnChangeChannelReq = NULL;
 static gpChangeChannelReq_t   pfnChangeChannelReqForBDB = NULL;
 
+// GPD ID of every proxy table NV slot, so lookups read only the matching slot
+static gpTblIdx_t             proxyTblIdx[GPP_MAX_PROXY_TABLE_ENTRIES];
+static bool                   proxyTblIdxValid = FALSE;
+
 
 /*********************************************************************
  * PUBLIC FUNCTIONS
@@ -156,9 +161,7 @@ void zclGp_GpPairingCommandCB( zclGpPairing_t *pCmd )
     if(gp_getProxyTableByGpId(&gpdID, currEntry, &proxyTableIndex) == ZSuccess)
     {
       gp_ResetProxyTblEntry(currEntry);
-      zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                               PROXY_TBL_LEN,
-                               currEntry);
+      gp_setProxyTableByIndex(proxyTableIndex, currEntry);
     }
     return;
   }
@@ -460,10 +463,7 @@ void zclGp_GpResponseCommandCB(zclGpResponse_t *pCmd)
       if(PROXY_TBL_GET_FIRST_TO_FORWARD(ProxyTableEntryTemp[PROXY_TBL_OPT]) == 0)
       {
         PROXY_TBL_SET_FIRST_TO_FORWARD(&ProxyTableEntryTemp[PROXY_TBL_OPT], TRUE);
-        zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID,
-                        NvProxyTableIndex,
-                        PROXY_TBL_LEN,
-                        &ProxyTableEntryTemp);
+        gp_setProxyTableByIndex(NvProxyTableIndex, ProxyTableEntryTemp);
       }
     }
     //Depends on TempMasterAddress
@@ -501,10 +501,7 @@ void zclGp_GpResponseCommandCB(zclGpResponse_t *pCmd)
        (PROXY_TBL_GET_FIRST_TO_FORWARD(ProxyTableEntryTemp[PROXY_TBL_OPT]) == 1))
     {
         PROXY_TBL_SET_FIRST_TO_FORWARD(&ProxyTableEntryTemp[PROXY_TBL_OPT], FALSE);
-        zclport_writeNV( ZCL_PORT_PROXY_TABLE_NV_ID,
-                         NvProxyTableIndex,
-                         PROXY_TBL_LEN,
-                         ProxyTableEntryTemp );
+        gp_setProxyTableByIndex(NvProxyTableIndex, ProxyTableEntryTemp);
     }
     //Also remove any packet to the GPD
     gp_DataReq->Action = 0;
@@ -591,6 +588,8 @@ uint8_t gp_ProxyTblInit(uint8_t resetTable)
  uint8_t emptyEntry[PROXY_TBL_LEN];
 
  gp_ResetProxyTblEntry(emptyEntry);
+ // The index is rebuilt once the table is initialized
+ proxyTblIdxValid = FALSE;
 
  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
  {
@@ -609,6 +608,10 @@ uint8_t gp_ProxyTblInit(uint8_t resetTable)
                               emptyEntry );
    }
  }
+
+ // Rebuild the RAM index from the table contents
+ gp_ProxyTblIdxSync();
+
  return status;
 }
 
@@ -661,53 +664,28 @@ void gp_stopCommissioningMode(void)
  */
 uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvProxyTableIndex)
 {
-  uint8_t i;
-  uint8_t status;
+  uint16_t i;
 
   if((pEntry == NULL) || (gpdID == NULL) || (NvProxyTableIndex == NULL))
   {
     return ZFailure;
   }
 
-  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+  i = gp_ProxyTblIdxFind(gpdID);
+  if(i == GP_TBL_IDX_NOT_FOUND)
   {
-    status = gp_getProxyTableByIndex(i, pEntry);
-    if(status == NV_OPER_FAILED)
-    {
-      // FAIL
-      return ZFailure;
-    }
-
-    // if the entry is empty
-    if(status == NV_INVALID_DATA)
-    {
-      continue;
-    }
+    return ZInvalidParameter;
+  }
 
-    //Check that App ID is the same
-    if(GP_TBL_COMP_APPLICATION_ID(gpdID->appID, pEntry[PROXY_TBL_OPT]))
-    {
-      if((gpdID->appID == GP_OPT_APP_ID_GPD) &&
-        zcl_memcmp( &gpdID->id.srcID, &pEntry[PROXY_TBL_GPD_ID + 4], sizeof(uint32_t)))
-      {
-        // Entry found
-        *NvProxyTableIndex = i;
-        return ZSuccess;
-      }
-      else if((gpdID->appID == GP_OPT_APP_ID_IEEE) &&
-              zcl_memcmp(&gpdID->id.gpdExtAddr, &pEntry[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN))
-      {
-        // Entry found
-        *NvProxyTableIndex = i;
-        return ZSuccess;
-      }
-    }
-    else
-    {
-      continue;
-    }
+  if(gp_getProxyTableByIndex(i, pEntry) != SUCCESS)
+  {
+    // FAIL
+    return ZFailure;
   }
-  return ZInvalidParameter;
+
+  // Entry found
+  *NvProxyTableIndex = i;
+  return ZSuccess;
 }
 
  /*********************************************************************
@@ -725,6 +703,14 @@ uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
   uint8_t status;
   uint16_t emptyEntry = 0xFFFF;
 
+  if((proxyTblIdxValid == TRUE) && (nvIndex < GPP_MAX_PROXY_TABLE_ENTRIES) &&
+     (proxyTblIdx[nvIndex].appID == GP_TBL_IDX_EMPTY))
+  {
+    // Known empty slot, no need to read it from NV
+    gp_ResetProxyTblEntry(pEntry);
+    return NV_INVALID_DATA;
+  }
+
   status = zclport_readNV(ZCL_PORT_PROXY_TABLE_NV_ID, nvIndex,
                             0,
                             PROXY_TBL_LEN,
@@ -736,6 +722,11 @@ uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
     return status;
   }
 
+  if((proxyTblIdxValid == TRUE) && (nvIndex < GPP_MAX_PROXY_TABLE_ENTRIES))
+  {
+    gp_TblIdxSet(&proxyTblIdx[nvIndex], pEntry);
+  }
+
   // if the entry is empty
   if(zcl_memcmp(pEntry, &emptyEntry, sizeof(uint16_t)))
   {
@@ -745,6 +736,50 @@ uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
   return status;
 }
 
+ /*********************************************************************
+ * @fn          gp_setProxyTableByIndex
+ *
+ * @brief       General function to write a proxy table entry by NV index,
+ *              keeping the proxy table index up to date
+ *
+ * @param       nvIndex - NV Id of proxy table
+ *              pEntry  - pointer to PROXY_TBL_LEN array
+ *
+ * @return      status of the NV write
+ */
+uint8_t gp_setProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
+{
+  uint8_t status;
+
+  status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, nvIndex,
+                           PROXY_TBL_LEN,
+                           pEntry);
+
+  if((proxyTblIdxValid == TRUE) && (nvIndex < GPP_MAX_PROXY_TABLE_ENTRIES))
+  {
+    // On failure the slot content is unknown, it's read again on next lookup
+    gp_TblIdxSet(&proxyTblIdx[nvIndex], (status == SUCCESS) ? pEntry : NULL);
+  }
+
+  return status;
+}
+
+ /*********************************************************************
+ * @fn          gp_ProxyTblIdxFind
+ *
+ * @brief       Look for a GPD, or an empty slot, in the proxy table index
+ *
+ * @param       gpdID - GPD to look for, NULL for the first empty slot
+ *
+ * @return      NV index of the entry, GP_TBL_IDX_NOT_FOUND if there is none
+ */
+uint16_t gp_ProxyTblIdxFind( gpdID_t *gpdID )
+{
+  gp_ProxyTblIdxSync();
+
+  return gp_TblIdxFind(proxyTblIdx, GPP_MAX_PROXY_TABLE_ENTRIES, gpdID);
+}
+
 /*********************************************************************
  * @fn          gp_dataIndProxy
  *
@@ -846,9 +881,7 @@ void gp_dataIndProxy(gp_DataInd_t *gp_DataInd)
               (uint8_t*)&gp_DataInd->GPDSecFrameCounter,
               sizeof(uint32_t));
 
-    zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, nvIndex,
-                     PROXY_TBL_LEN,
-                     pProxyTableEntry);
+    gp_setProxyTableByIndex(nvIndex, pProxyTableEntry);
   }
 
   if(zgGP_ProxyCommissioningMode == TRUE)
@@ -1331,53 +1364,43 @@ static ZStatus_t zclGp_DataIndParse( gp_DataInd_t *pInd, gpNotificationCmd_t *pG
 {
   uint8_t currEntry[PROXY_TBL_LEN];
   uint8_t  ntfOpt[2] = {0x00, 0x00};
-  uint8_t i;
   int8_t RSSI;
   uint8_t LQI;
   ZStatus_t status;
+  gpdID_t gpdID;
+  uint16_t nvIndex;
 
-  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+  gpdID.appID = pInd->appID;
+  if(pInd->appID == GP_OPT_APP_ID_IEEE)
   {
-    status = gp_getProxyTableByIndex(i, currEntry);
-
-    if(status == NV_OPER_FAILED)
-    {
-      return status;
-    }
-
-    // if the entry is empty
-    if(status == NV_INVALID_DATA)
-    {
-      continue;
-    }
+    zcl_memcpy(gpdID.id.gpdExtAddr, pInd->srcAddr.addr.extAddr, Z_EXTADDR_LEN);
+  }
+  else
+  {
+    gpdID.id.srcID = pInd->SrcId;
+  }
 
-    if(GP_TBL_COMP_APPLICATION_ID( pInd->appID, currEntry[PROXY_TBL_OPT]))
+  status = gp_getProxyTableByGpId(&gpdID, currEntry, &nvIndex);
+  if(status == ZSuccess)
+  {
+    if(pInd->appID == GP_OPT_APP_ID_GPD)
     {
-      if((pInd->appID == GP_OPT_APP_ID_GPD) &&
-          (zcl_memcmp( &pInd->SrcId, &currEntry[PROXY_TBL_GPD_ID + 4], sizeof(uint32_t))))
-      {
-        // Entry found
-        pGpNotification->gpdId = pInd->SrcId;
-        ntfOpt[0] = GP_OPT_APP_ID_GPD;
-        status = SUCCESS;
-        break;
-      }
-      else if((pInd->appID == GP_OPT_APP_ID_IEEE) &&
-              (zcl_memcmp(&pInd->srcAddr, &currEntry[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN)))
-      {
-        // Entry found
-        zcl_memcpy(pGpNotification->gpdIEEE, &(pInd->srcAddr.addr.extAddr), Z_EXTADDR_LEN);
-        pGpNotification->ep = pInd->EndPoint;
-        ntfOpt[0] = GP_OPT_APP_ID_IEEE;
-        status = SUCCESS;
-        break;
-      }
+      // Entry found
+      pGpNotification->gpdId = pInd->SrcId;
+      ntfOpt[0] = GP_OPT_APP_ID_GPD;
     }
     else
     {
-      status = INVALIDPARAMETER;
-      continue;
+      // Entry found
+      zcl_memcpy(pGpNotification->gpdIEEE, &(pInd->srcAddr.addr.extAddr), Z_EXTADDR_LEN);
+      pGpNotification->ep = pInd->EndPoint;
+      ntfOpt[0] = GP_OPT_APP_ID_IEEE;
     }
+    status = SUCCESS;
+  }
+  else if(status == ZInvalidParameter)
+  {
+    status = INVALIDPARAMETER;
   }
 
   if(status == SUCCESS)
@@ -1639,6 +1662,41 @@ static void gp_ZclProxyTableReqParse( zclGpTableRequest_t* pCmd, gpTableReqCmd_t
   }
 }
 
+/*********************************************************************
+ * @fn      gp_ProxyTblIdxSync
+ *
+ * @brief   Make sure every slot of the proxy table index is known,
+ *          reading from NV the slots that are not (all of them on the
+ *          first call).
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void gp_ProxyTblIdxSync(void)
+{
+  uint8_t i;
+  uint8_t entry[PROXY_TBL_LEN];
+
+  if(proxyTblIdxValid == FALSE)
+  {
+    for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES; i++)
+    {
+      gp_TblIdxSet(&proxyTblIdx[i], NULL);
+    }
+    proxyTblIdxValid = TRUE;
+  }
+
+  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES; i++)
+  {
+    if(proxyTblIdx[i].appID == GP_TBL_IDX_UNKNOWN)
+    {
+      // A successful read updates the index slot
+      gp_getProxyTableByIndex(i, entry);
+    }
+  }
+}
+
 #endif
 /*********************************************************************
 *********************************************************************/
@@ -146,6 +146,16 @@ extern uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t*
  */
 extern uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
 
+/*
+ * @brief   General function to write a proxy table entry by NV index
+ */
+extern uint8_t gp_setProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
+
+/*
+ * @brief   Look for a GPD, or an empty slot, in the proxy table index
+ */
+extern uint16_t gp_ProxyTblIdxFind( gpdID_t *gpdID );
+
 /*
  * @brief   Handle Gp attributes.
  */
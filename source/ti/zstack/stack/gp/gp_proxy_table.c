@@ -298,72 +298,67 @@ uint8_t pt_ZclReadGetProxyEntry( uint16_t nvId, uint8_t* pData, uint8_t* len )
  */
 uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictResolution )
 {
-  uint8_t i;
   uint8_t newEntry[PROXY_TBL_LEN];
   uint8_t currEntry[PROXY_TBL_LEN];
   uint16_t proxyTableIndex;
   uint8_t status;
+  gpdID_t gpdID;
 
   // Copy the new entry pointer to array
   proxyTableCpy( &newEntry, pEntry );
 
-  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+  // Look for the GPD in the proxy table index
+  gp_TblEntryGetGpdId(newEntry, &gpdID);
+  proxyTableIndex = gp_ProxyTblIdxFind(&gpdID);
+
+  if(proxyTableIndex == GP_TBL_IDX_NOT_FOUND)
   {
-    proxyTableIndex = i;
-    status = gp_getProxyTableByIndex(proxyTableIndex, currEntry);
-    if(status == NV_OPER_FAILED)
+    proxyTableIndex = gp_ProxyTblIdxFind(NULL);
+
+    if((proxyTableIndex == GP_TBL_IDX_NOT_FOUND) ||
+       (GP_PAIRING_OPT_ADD_SINK(options) == FALSE))
     {
-      // FAIL
-      return status;
+      // No space for new entries, or no entry to remove
+      return FAILURE;
     }
 
-    // if the entry is empty
-    if((status == NV_INVALID_DATA) && (GP_PAIRING_OPT_ADD_SINK(options) == TRUE))
+    // Save new entry
+    status = gp_setProxyTableByIndex(proxyTableIndex, newEntry);
+
+    // Perform address conflict resolution
+    if(zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_ALIAS], sizeof(uint16_t))        ||
+       zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_1ST_GRP_ADDR], sizeof(uint16_t)) ||
+       zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_2ND_GRP_ADDR], sizeof(uint16_t))   )
     {
-      // Save new entry
-      status = zclport_writeNV( ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                                PROXY_TBL_LEN,
-                                newEntry );
-
-      // Perform address conflict resolution
-      if(zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_ALIAS], sizeof(uint16_t))        ||
-         zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_1ST_GRP_ADDR], sizeof(uint16_t)) ||
-         zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_2ND_GRP_ADDR], sizeof(uint16_t))   )
-      {
 #if (defined (USE_ICALL) || defined (OSAL_PORT2TIRTOS))
-        zstack_gpAddrConflict_t *pMsg;
+      zstack_gpAddrConflict_t *pMsg;
 
-        pMsg = (zstack_gpAddrConflict_t*)zcl_mem_alloc( sizeof(zstack_gpAddrConflict_t));
-        if(pMsg != NULL)
-        {
-            zcl_memset(pMsg, 0, sizeof(zstack_gpAddrConflict_t));
+      pMsg = (zstack_gpAddrConflict_t*)zcl_mem_alloc( sizeof(zstack_gpAddrConflict_t));
+      if(pMsg != NULL)
+      {
+          zcl_memset(pMsg, 0, sizeof(zstack_gpAddrConflict_t));
 
-            pMsg->conflictResolution = conflictResolution;
+          pMsg->conflictResolution = conflictResolution;
 
-            Zstackapi_gpAliasConflict(gpAppEntity, pMsg);
-            zcl_mem_free(pMsg);
-        }
-        else
-        {
-            return ZMemError;
-        }
+          Zstackapi_gpAliasConflict(gpAppEntity, pMsg);
+          zcl_mem_free(pMsg);
+      }
+      else
+      {
+          return ZMemError;
+      }
 #else
-        NLME_ReportAddressConflict(_NIB.nwkDevAddress, TRUE);
+      NLME_ReportAddressConflict(_NIB.nwkDevAddress, TRUE);
 #endif
-      }
-      return status;
     }
+    return status;
+  }
 
-    if(gpLookForGpd(proxyTableIndex, newEntry))
-    {
-      // Entry found
-      break;
-    }
-    if(i >= GPP_MAX_PROXY_TABLE_ENTRIES)
-    {
-      // No space for new entries
-      return FAILURE;
-    }
+  status = gp_getProxyTableByIndex(proxyTableIndex, currEntry);
+  if(status != SUCCESS)
+  {
+    // FAIL
+    return status;
   }
 
   // Remove the entry
@@ -376,9 +371,7 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
     {
       gp_ResetProxyTblEntry(currEntry);
     }
-    status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                             PROXY_TBL_LEN,
-                             currEntry);
+    status = gp_setProxyTableByIndex(proxyTableIndex, currEntry);
     return status;
   }
 
@@ -419,9 +412,7 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
   zcl_memcpy(&currEntry[PROXY_TBL_SEC_FRAME], &newEntry[PROXY_TBL_SEC_FRAME], sizeof(uint32_t));
   currEntry[PROXY_TBL_RADIUS] = newEntry[PROXY_TBL_RADIUS];
   currEntry[PROXY_TBL_SEARCH_COUNTER] = newEntry[PROXY_TBL_SEARCH_COUNTER];
-  status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                           PROXY_TBL_LEN,
-                           currEntry);
+  status = gp_setProxyTableByIndex(proxyTableIndex, currEntry);
 
   if (zcl_memcmp(&_NIB.nwkDevAddress, &currEntry[PROXY_TBL_ALIAS], sizeof(uint16_t))        ||
       zcl_memcmp(&_NIB.nwkDevAddress, &currEntry[PROXY_TBL_1ST_GRP_ADDR], sizeof(uint16_t)) ||
@@ -97,6 +97,7 @@ static ZStatus_t zclGp_GpChannelRequestProcess( zclGpCommissioningNotification_t
 static ZStatus_t zclGp_GpCommissioningNotificationProcess( zclGpCommissioningNotification_t *pCmd );
 static ZStatus_t zclGp_GpSuccessNotificationProcess( zclGpCommissioningNotification_t *pCmd );
 static uint8_t* gp_processCommissioning(gpdID_t *pGPDId, uint8_t *pAsdu, gpdCommissioningCmd_t *pCommissioningCmdPayload, uint8_t* pLen);
+static void gp_SinkTblIdxSync(void);
 
 /*********************************************************************
  * LOCAL VARIABLES
@@ -105,6 +106,10 @@ static uint8_t* gp_processCommissioning(gpdID_t *pGPDId, uint8_t *pAsdu, gpdComm
 GpSink_AppCallbacks_t *GpSink_AppCallbacks = NULL;
 uint8_t* pNewSinkEntry = NULL;
 
+// GPD ID of every sink table NV slot, so lookups read only the matching slot
+static gpTblIdx_t sinkTblIdx[GPS_MAX_SINK_TABLE_ENTRIES];
+static bool sinkTblIdxValid = FALSE;
+
 
 /*********************************************************************
  * PUBLIC FUNCTIONS
@@ -413,53 +418,43 @@ ZStatus_t zclGp_DataIndParse( gp_DataInd_t *pInd, gpNotificationCmd_t *pGpNotifi
 {
   uint8_t currEntry[PROXY_TBL_LEN];
   uint8_t  ntfOpt[2] = {0x00, 0x00};
-  uint8_t i;
   int8_t RSSI;
   uint8_t LQI;
   ZStatus_t status;
+  gpdID_t gpdID;
+  uint16_t nvIndex;
 
-  for (i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+  gpdID.appID = pInd->appID;
+  if(pInd->appID == GP_OPT_APP_ID_IEEE)
   {
-    status = gp_getProxyTableByIndex(i, currEntry);
-
-    if(status == NV_OPER_FAILED)
-    {
-      return status;
-    }
-
-    // if the entry is empty
-    if (status == NV_INVALID_DATA)
-    {
-      continue;
-    }
+    zcl_memcpy(gpdID.id.gpdExtAddr, pInd->srcAddr.addr.extAddr, Z_EXTADDR_LEN);
+  }
+  else
+  {
+    gpdID.id.srcID = pInd->SrcId;
+  }
 
-    if(GP_TBL_COMP_APPLICATION_ID( pInd->appID, currEntry[PROXY_TBL_OPT]))
+  status = gp_getProxyTableByGpId(&gpdID, currEntry, &nvIndex);
+  if(status == ZSuccess)
+  {
+    if(pInd->appID == GP_OPT_APP_ID_GPD)
     {
-      if((pInd->appID == GP_OPT_APP_ID_GPD) &&
-         zcl_memcmp( &pInd->SrcId, &currEntry[PROXY_TBL_GPD_ID + 4], sizeof (uint32_t)))
-      {
-        // Entry found
-        pGpNotification->gpdId = pInd->SrcId;
-        ntfOpt[0] = GP_OPT_APP_ID_GPD;
-        status = SUCCESS;
-        break;
-      }
-      else if((pInd->appID == GP_OPT_APP_ID_IEEE ) &&
-               zcl_memcmp( &pInd->srcAddr, &currEntry[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN))
-      {
-        // Entry found
-        zcl_memcpy(pGpNotification->gpdIEEE, &(pInd->srcAddr.addr.extAddr), Z_EXTADDR_LEN);
-        pGpNotification->ep = pInd->EndPoint;
-        ntfOpt[0] = GP_OPT_APP_ID_IEEE;
-        status = SUCCESS;
-        break;
-      }
+      // Entry found
+      pGpNotification->gpdId = pInd->SrcId;
+      ntfOpt[0] = GP_OPT_APP_ID_GPD;
     }
     else
     {
-      status = INVALIDPARAMETER;
-      continue;
+      // Entry found
+      zcl_memcpy(pGpNotification->gpdIEEE, &(pInd->srcAddr.addr.extAddr), Z_EXTADDR_LEN);
+      pGpNotification->ep = pInd->EndPoint;
+      ntfOpt[0] = GP_OPT_APP_ID_IEEE;
     }
+    status = SUCCESS;
+  }
+  else if(status == ZInvalidParameter)
+  {
+    status = INVALIDPARAMETER;
   }
 
   if ( status == SUCCESS )
@@ -751,6 +746,8 @@ uint8_t gp_SinkTblInit(uint8_t resetTable)
   uint8_t emptyEntry[SINK_TBL_ENTRY_LEN];
 
   gp_ResetSinkTblEntry(emptyEntry);
+  // The index is rebuilt once the table is initialized
+  sinkTblIdxValid = FALSE;
 
   for(i = 0; i < GPS_MAX_SINK_TABLE_ENTRIES ; i++)
   {
@@ -767,6 +764,10 @@ uint8_t gp_SinkTblInit(uint8_t resetTable)
                                SINK_TBL_ENTRY_LEN, emptyEntry );
     }
   }
+
+  // Rebuild the RAM index from the table contents
+  gp_SinkTblIdxSync();
+
   return status;
 }
 
@@ -782,60 +783,32 @@ uint8_t gp_SinkTblInit(uint8_t resetTable)
 */
 uint8_t gp_getSinkTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvSinkTableIndex)
 {
- uint8_t i;
- uint8_t status;
+ uint16_t i;
+
  if((pEntry == NULL) || (gpdID == NULL) || (NvSinkTableIndex == NULL))
  {
    return ZFailure;
  }
 
- // Initialize index as invalid
- *NvSinkTableIndex = ZCD_NV_INVALID_INDEX;
-
- for(i = 0; i < GPS_MAX_SINK_TABLE_ENTRIES ; i++)
+ i = gp_SinkTblIdxFind(gpdID);
+ if(i == GP_TBL_IDX_NOT_FOUND)
  {
-   status = gp_getSinkTableByIndex(i, pEntry);
-
-   if(status == NV_OPER_FAILED)
-   {
-     // FAIL
-     return ZMemError;
-   }
-
-   // if the entry is empty
-   if(status == NV_INVALID_DATA)
-   {
-     if(*NvSinkTableIndex == ZCD_NV_INVALID_INDEX)
-     {
-       *NvSinkTableIndex = i;
-     }
-     continue;
-   }
+   // Return the first empty entry, if any, for a new pairing
+   i = gp_SinkTblIdxFind(NULL);
+   *NvSinkTableIndex = (i == GP_TBL_IDX_NOT_FOUND) ? ZCD_NV_INVALID_INDEX : i;
+   return ZInvalidParameter;
+ }
 
-   //Check that App ID is the same
-   if(GP_TBL_COMP_APPLICATION_ID( gpdID->appID, pEntry[SINK_TBL_OPT]))
-   {
-     if((gpdID->appID == GP_OPT_APP_ID_GPD) &&
-         zcl_memcmp(&gpdID->id.srcID, &pEntry[SINK_TBL_SRC_ID], sizeof(uint32_t)))
-     {
-       // Entry found
-       *NvSinkTableIndex = i;
-       return ZSuccess;
-     }
-     else if((gpdID->appID == GP_OPT_APP_ID_IEEE) &&
-              zcl_memcmp(&gpdID->id.gpdExtAddr, &pEntry[SINK_TBL_GPD_ID], Z_EXTADDR_LEN))
-     {
-       // Entry found
-       *NvSinkTableIndex = i;
-       return ZSuccess;
-     }
-   }
-   else
-   {
-     continue;
-   }
+ *NvSinkTableIndex = ZCD_NV_INVALID_INDEX;
+ if(gp_getSinkTableByIndex(i, pEntry) != SUCCESS)
+ {
+   // FAIL
+   return ZMemError;
  }
- return ZInvalidParameter;
+
+ // Entry found
+ *NvSinkTableIndex = i;
+ return ZSuccess;
 }
 
 /*********************************************************************
@@ -853,6 +826,14 @@ uint8_t gp_getSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
  uint8_t status;
  uint16_t emptyEntry = 0xFFFF;
 
+ if((sinkTblIdxValid == TRUE) && (nvIndex < GPS_MAX_SINK_TABLE_ENTRIES) &&
+    (sinkTblIdx[nvIndex].appID == GP_TBL_IDX_EMPTY))
+ {
+   // Known empty slot, no need to read it from NV
+   gp_ResetSinkTblEntry(pEntry);
+   return NV_INVALID_DATA;
+ }
+
  status = zclport_readNV(ZCL_PORT_SINK_TABLE_NV_ID, nvIndex,
                            0, SINK_TBL_ENTRY_LEN, pEntry);
  if(status != SUCCESS)
@@ -861,6 +842,11 @@ uint8_t gp_getSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
    return status;
  }
 
+ if((sinkTblIdxValid == TRUE) && (nvIndex < GPS_MAX_SINK_TABLE_ENTRIES))
+ {
+   gp_TblIdxSet(&sinkTblIdx[nvIndex], pEntry);
+ }
+
  // if the entry is empty
  if(zcl_memcmp(pEntry, &emptyEntry, sizeof(uint16_t)))
  {
@@ -869,6 +855,48 @@ uint8_t gp_getSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
  return status;
 }
 
+/*********************************************************************
+* @fn          gp_setSinkTableByIndex
+*
+* @brief       General function to write a sink table entry by NV index,
+*              keeping the sink table index up to date
+*
+* @param       nvIndex - NV Id of sink table
+*              pEntry  - pointer to SINK_TBL_LEN array
+*
+* @return      status of the NV write
+*/
+uint8_t gp_setSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
+{
+ uint8_t status;
+
+ status = zclport_writeNV(ZCL_PORT_SINK_TABLE_NV_ID, nvIndex,
+                          SINK_TBL_ENTRY_LEN, pEntry);
+
+ if((sinkTblIdxValid == TRUE) && (nvIndex < GPS_MAX_SINK_TABLE_ENTRIES))
+ {
+   // On failure the slot content is unknown, it's read again on next lookup
+   gp_TblIdxSet(&sinkTblIdx[nvIndex], (status == SUCCESS) ? pEntry : NULL);
+ }
+ return status;
+}
+
+/*********************************************************************
+* @fn          gp_SinkTblIdxFind
+*
+* @brief       Look for a GPD, or an empty slot, in the sink table index
+*
+* @param       gpdID - GPD to look for, NULL for the first empty slot
+*
+* @return      NV index of the entry, GP_TBL_IDX_NOT_FOUND if there is none
+*/
+uint16_t gp_SinkTblIdxFind( gpdID_t *gpdID )
+{
+ gp_SinkTblIdxSync();
+
+ return gp_TblIdxFind(sinkTblIdx, GPS_MAX_SINK_TABLE_ENTRIES, gpdID);
+}
+
  /*********************************************************************
   * @fn      GP_SinkProcessDataIndicationCommissioningGpdf
   *
@@ -1252,8 +1280,7 @@ void gp_dataIndSink(gp_DataInd_t *gpDataInd)
       zcl_buffer_uint32(&sinkTableEntry[SINK_TBL_SEC_FRAME], gpDataInd->GPDSecFrameCounter);
 
       //Update Sec Frame counter to sink table entry
-      zclport_writeNV( ZCL_PORT_SINK_TABLE_NV_ID, sinkTableEntryIndex,
-                       SINK_TBL_ENTRY_LEN, sinkTableEntry );
+      gp_setSinkTableByIndex( sinkTableEntryIndex, sinkTableEntry );
       secNumber = gpDataInd->GPDSecFrameCounter;
     }
 
@@ -1323,8 +1350,7 @@ void gp_dataIndSink(gp_DataInd_t *gpDataInd)
 
       zclGp_SendGpPairing(pNewSinkEntry, GP_ACTION_EXTEND, gpDataInd->GPDSecFrameCounter, zcl_InSeqNum);
       gp_sinkAddProxyEntry(pNewSinkEntry);
-      status = zclport_writeNV( ZCL_PORT_SINK_TABLE_NV_ID, sinkTableEntryIndex,
-                                SINK_TBL_ENTRY_LEN, pNewSinkEntry );
+      status = gp_setSinkTableByIndex( sinkTableEntryIndex, pNewSinkEntry );
 
       zcl_mem_free(pNewSinkEntry);
       // To not process this indication in the proxy side
@@ -1785,9 +1811,7 @@ static ZStatus_t zclGp_GpCommissioningNotificationProcess( zclGpCommissioningNot
        (commissioningCmdPayload.gpdOutCounter > frameCounter))
     {
       zcl_memcpy(&pEntry[SINK_TBL_SEC_FRAME], &commissioningCmdPayload.gpdOutCounter, FRAME_COUNTER_LEN);
-      zclport_writeNV( ZCL_PORT_SINK_TABLE_NV_ID, index,
-                       SINK_TBL_ENTRY_LEN,
-                       pEntry );
+      gp_setSinkTableByIndex( index, pEntry );
     }
   }
   // No matches and an empty entry was found
@@ -1945,8 +1969,7 @@ static ZStatus_t zclGp_GpSuccessNotificationProcess( zclGpCommissioningNotificat
     Zstackapi_gpCommissioningSucess(gpAppEntity, &msg);
     zclGp_SendGpPairing(pNewSinkEntry, GP_ACTION_EXTEND, pCmd->securityFrameCounter, zcl_InSeqNum);
     gp_sinkAddProxyEntry(pNewSinkEntry);
-    status = zclport_writeNV(ZCL_PORT_SINK_TABLE_NV_ID, index,
-                             SINK_TBL_ENTRY_LEN, pNewSinkEntry);
+    status = gp_setSinkTableByIndex(index, pNewSinkEntry);
 
      zcl_mem_free(pNewSinkEntry);
   }
@@ -2101,6 +2124,41 @@ void gp_SetSinkCommissioningMode(bool enabled)
 {
   zgGP_SinkCommissioningMode = enabled;
 }
+
+/*********************************************************************
+ * @fn          gp_SinkTblIdxSync
+ *
+ * @brief       Make sure every slot of the sink table index is known,
+ *              reading from NV the slots that are not (all of them on
+ *              the first call).
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+static void gp_SinkTblIdxSync(void)
+{
+  uint8_t i;
+  uint8_t entry[SINK_TBL_ENTRY_LEN];
+
+  if(sinkTblIdxValid == FALSE)
+  {
+    for(i = 0; i < GPS_MAX_SINK_TABLE_ENTRIES; i++)
+    {
+      gp_TblIdxSet(&sinkTblIdx[i], NULL);
+    }
+    sinkTblIdxValid = TRUE;
+  }
+
+  for(i = 0; i < GPS_MAX_SINK_TABLE_ENTRIES; i++)
+  {
+    if(sinkTblIdx[i].appID == GP_TBL_IDX_UNKNOWN)
+    {
+      // A successful read updates the index slot
+      gp_getSinkTableByIndex(i, entry);
+    }
+  }
+}
 #endif
 
 /*********************************************************************
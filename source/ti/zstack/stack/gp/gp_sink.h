@@ -225,6 +225,16 @@ extern uint8_t gp_SinkTblInit( uint8_t resetTable );
  */
 uint8_t gp_getSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
 
+/*
+ * @brief    General function to write a sink table entry by NV index
+ */
+extern uint8_t gp_setSinkTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
+
+/*
+ * @brief    Look for a GPD, or an empty slot, in the sink table index
+ */
+extern uint16_t gp_SinkTblIdxFind( gpdID_t *gpdID );
+
 /*
  * @brief   General function to get sink table entry by gpdID (GP Src ID or Extended Adddress)
  */
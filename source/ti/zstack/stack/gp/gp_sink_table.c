@@ -409,8 +409,7 @@ uint16_t gp_PairingConfigUpdateSinkTbl( gpPairingConfigCmd_t* payload )
 ZStatus_t gp_commissioningSinkTblUpdate(gpdID_t *gpdId, uint8_t ep, uint8_t deviceId, uint8_t *pEntry, uint16_t nvIndex, gpSinkTableOptions_t sinkOptions, gpdCommissioningCmd_t *pCommissioningCmd)
 {
     gp_commissioningSinkEntryParse(gpdId, ep, deviceId, pEntry, sinkOptions, pCommissioningCmd);
-    return zclport_writeNV( ZCL_PORT_SINK_TABLE_NV_ID, nvIndex,
-                            SINK_TBL_ENTRY_LEN, pEntry );
+    return gp_setSinkTableByIndex( nvIndex, pEntry );
 }
 
 /*********************************************************************
@@ -543,59 +542,48 @@ void gp_commissioningSinkEntryParse(gpdID_t *gpdId, uint8_t ep, uint8_t deviceId
 
 static uint16_t gp_UpdateSinkTbl( uint8_t* pEntry, uint8_t actions )
 {
-  uint8_t i;
   uint8_t newEntry[SINK_TBL_ENTRY_LEN];
   uint8_t currEntry[SINK_TBL_ENTRY_LEN];
   uint16_t sinkTableIndex;
-  uint8_t status;
+  gpdID_t gpdID;
 
   // Copy the new entry pointer to array
   sinkTableCpy(newEntry, pEntry);
 
-  for (i = 0; i < GPS_MAX_SINK_TABLE_ENTRIES ; i++)
-  {
-    sinkTableIndex = i;
-    status = gp_getSinkTableByIndex(sinkTableIndex, currEntry);
+  // Look for the GPD in the sink table index
+  gp_TblEntryGetGpdId(newEntry, &gpdID);
+  sinkTableIndex = gp_SinkTblIdxFind(&gpdID);
 
-    if (status == NV_OPER_FAILED)
-    {
-      // FAIL
-      return ZCD_NV_INVALID_INDEX;
-    }
+  if(sinkTableIndex == GP_TBL_IDX_NOT_FOUND)
+  {
+    sinkTableIndex = gp_SinkTblIdxFind(NULL);
 
-    // if the entry is empty
-    if((status == NV_INVALID_DATA) &&
+    // if there is an empty entry
+    if((sinkTableIndex != GP_TBL_IDX_NOT_FOUND) &&
        (GP_PAIRING_CONFIG_ACTION_IS_EXTEND(actions) ||
         GP_PAIRING_CONFIG_ACTION_IS_REPLACE(actions)))
     {
-      status = zclport_writeNV( ZCL_PORT_SINK_TABLE_NV_ID, sinkTableIndex,
-                                SINK_TBL_ENTRY_LEN,
-                                newEntry );
+      gp_setSinkTableByIndex(sinkTableIndex, newEntry);
       return sinkTableIndex;
     }
 
-    if ( gpLookForGpd( sinkTableIndex, newEntry ) )
-    {
-      // Entry found
-      break;
-    }
+    // No space for new entries, or no entry to remove
+    return ZCD_NV_INVALID_INDEX;
+  }
 
-    if ( i >= GPS_MAX_SINK_TABLE_ENTRIES )
-    {
-      // No space for new entries
-      return ZCD_NV_INVALID_INDEX;
-    }
+  if(gp_getSinkTableByIndex(sinkTableIndex, currEntry) != SUCCESS)
+  {
+    // FAIL
+    return ZCD_NV_INVALID_INDEX;
   }
 
   // Remove the entry
   if(GP_PAIRING_CONFIG_ACTION_IS_REMOVE_PAIRING(actions) ||
      GP_PAIRING_CONFIG_ACTION_IS_REMOVE_GPD(actions))
   {
-      gp_ResetSinkTblEntry( currEntry );
+    gp_ResetSinkTblEntry( currEntry );
 
-    status = zclport_writeNV(ZCL_PORT_SINK_TABLE_NV_ID, sinkTableIndex,
-                             SINK_TBL_ENTRY_LEN,
-                             currEntry);
+    gp_setSinkTableByIndex(sinkTableIndex, currEntry);
     return sinkTableIndex;
   }
 
@@ -621,9 +609,7 @@ static uint16_t gp_UpdateSinkTbl( uint8_t* pEntry, uint8_t actions )
     zcl_memcpy(&currEntry[SINK_TBL_SEC_FRAME], &newEntry[SINK_TBL_SEC_FRAME], sizeof(uint32_t));
   }
 
-  status = zclport_writeNV(ZCL_PORT_SINK_TABLE_NV_ID, sinkTableIndex,
-                           PROXY_TBL_LEN,
-                           currEntry);
+  gp_setSinkTableByIndex(sinkTableIndex, currEntry);
 
   return sinkTableIndex;
 }
@@ -55,6 +55,12 @@
 /*********************************************************************
  * MACROS
  */
+#define BIND_IDX_CL_HASH( ep, cl ) \
+          ( ( (ep) ^ (uint8_t)(cl) ^ (uint8_t)((cl) >> 8) ) & (BIND_IDX_HASH_SIZE - 1) )
+#define BIND_IDX_DST_HASH( dstIdx ) \
+          ( ( (uint8_t)(dstIdx) ^ (uint8_t)((dstIdx) >> 8) ) & (BIND_IDX_HASH_SIZE - 1) )
+
+#define BIND_NV_IS_DIRTY( x )   ( bindNvDirty[(x) >> 3] & (1 << ((x) & 7)) )
 
 /*********************************************************************
  * CONSTANTS
@@ -63,6 +69,25 @@
 #define NV_BIND_REC_SIZE (gBIND_REC_SIZE)
 #define NV_BIND_ITEM_SIZE  (gBIND_REC_SIZE * gNWK_MAX_BINDING_ENTRIES)
 
+// Number of hash buckets of each binding table index, must be a power of 2
+#if !defined ( BIND_IDX_HASH_SIZE )
+  #define BIND_IDX_HASH_SIZE  32
+#endif
+
+// End of an index chain
+#define BIND_IDX_NONE       0xFFFF
+
+// Time (ms) that changed binding records are held in RAM so that further
+// changes are written to NV together, 0 writes them at once
+#if !defined ( BIND_NV_FLUSH_DELAY )
+  #define BIND_NV_FLUSH_DELAY  1000
+#endif
+
+// Index nodes: one per cluster ID slot of each entry for the (srcEP, clusterID)
+// index, one per entry for the destination index
+#define BIND_IDX_CL_NODES   ( NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS )
+#define BIND_IDX_DST_NODES  ( NWK_MAX_BINDING_ENTRIES )
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -93,12 +118,36 @@ uint16_t bindingAddrMgsHelperFind( zAddrType_t *addr );
 uint8_t bindingAddrMgsHelperConvert( uint16_t idx, zAddrType_t *addr );
 void bindAddrMgrLocalLoad( void );
 
+static void bindIdxLink( uint16_t *pHead, uint16_t *pNext, uint16_t node );
+static void bindIdxUnlink( uint16_t *pHead, uint16_t *pNext, uint16_t node );
+static void bindIdxAdd( bindTableIndex_t x );
+static void bindIdxRemove( bindTableIndex_t x );
+static void bindIdxRebuild( void );
+static bindTableIndex_t bindIdxSlot( BindingEntry_t *entry );
+static BindingEntry_t *bindDstNext( uint16_t dstIdx, uint8_t dstGroupMode, uint16_t *pNode );
+static void bindNvMarkDirty( bindTableIndex_t x );
 
 /*********************************************************************
  * LOCAL VARIABLES
  */
 static uint8_t bindAddrMgrLocalLoaded = FALSE;
 
+// (srcEP, clusterID) index, node = entry * MAX_BINDING_CLUSTER_IDS + cluster slot
+static uint16_t bindIdxClHead[BIND_IDX_HASH_SIZE];
+static uint16_t bindIdxClNext[BIND_IDX_CL_NODES];
+
+// Destination (address manager index or group address) index, node = entry
+static uint16_t bindIdxDstHead[BIND_IDX_HASH_SIZE];
+static uint16_t bindIdxDstNext[BIND_IDX_DST_NODES];
+
+// Set when the indexes no longer match BindingTable, rebuilt on next use
+static uint8_t bindIdxStale = TRUE;
+
+// Records changed since the last NV write, one bit per entry
+static uint8_t bindNvDirty[(NWK_MAX_BINDING_ENTRIES + 7) / 8];
+static uint8_t bindNvFlushPending = FALSE;
+static bindNvStats_t bindNvStats;
+
 /*********************************************************************
  * Function Pointers
  */
@@ -145,6 +194,8 @@ void BindAddrMgrCB( uint8_t update, AddrMgrEntry_t *entryNew,
 void InitBindingTable( void )
 {
   memset( BindingTable, 0xFF, gBIND_REC_SIZE * gNWK_MAX_BINDING_ENTRIES );
+  memset( bindNvDirty, 0, sizeof( bindNvDirty ) );
+  bindIdxStale = TRUE;
 
   pbindAddEntry = bindAddEntry;
   pbindNumOfEntries = bindNumOfEntries;
@@ -271,7 +322,6 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
                               byte numClusterIds, uint16_t *clusterIds )
 {
   uint8_t            index;
-  bindTableIndex_t bindIdx;
   BindingEntry_t*  entry;
   bindFields_t     fields;
 #if (BDB_FINDING_BINDING_CAPABILITY_ENABLED==1)
@@ -323,15 +373,13 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
 
   if ( fields.dstIndex != INVALID_NODE_ADDR  )
   {
-    for ( bindIdx = 0; bindIdx < gNWK_MAX_BINDING_ENTRIES; bindIdx++ )
+    uint16_t node = BIND_IDX_NONE;
+
+    while ( (entry = bindDstNext( fields.dstIndex, fields.dstAddrMode, &node )) != NULL )
     {
-      if ( ( fields.srcEP       == BindingTable[bindIdx].srcEP        ) &&
-           ( fields.dstAddrMode == BindingTable[bindIdx].dstGroupMode ) &&
-           ( fields.dstIndex    == BindingTable[bindIdx].dstIdx       ) &&
-           ( fields.dstEP       == BindingTable[bindIdx].dstEP        )    )
+      if ( ( fields.srcEP == entry->srcEP ) &&
+           ( fields.dstEP == entry->dstEP )    )
       {
-        entry = &BindingTable[bindIdx];
-
         // break from loop
         break;
       }
@@ -353,10 +401,6 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
           }
           else
           {
-            // Save the record to NV
-            osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, bindIdx,
-                           (uint16_t)NV_BIND_REC_SIZE, &BindingTable[bindIdx] );
-
 #if (BDB_FINDING_BINDING_CAPABILITY_ENABLED==1)
             // new bind added - notify application
             bindData.clusterId = clusterIds[index];
@@ -385,7 +429,7 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
     }
     else
     {
-      uint8_t  bindTableIndex;
+      bindTableIndex_t bindTableIndex;
       // Find an empty slot
       entry = bindFindEmpty(&bindTableIndex);
 
@@ -434,9 +478,10 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
                      clusterIds,
                      numClusterIds * sizeof(uint16_t) );
 
+        bindIdxAdd( bindTableIndex );
+
         // Save the record to NV
-        osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, bindTableIndex,
-                         (uint16_t)NV_BIND_REC_SIZE, &BindingTable[bindTableIndex] );
+        bindNvMarkDirty( bindTableIndex );
       }
     }
   }
@@ -460,7 +505,17 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
  */
 byte bindRemoveEntry( BindingEntry_t *pBind )
 {
+  bindTableIndex_t x = bindIdxSlot( pBind );
+
+  if ( x < gNWK_MAX_BINDING_ENTRIES )
+  {
+    bindIdxRemove( x );
+  }
   memset( pBind, 0xFF, gBIND_REC_SIZE );
+  if ( x < gNWK_MAX_BINDING_ENTRIES )
+  {
+    bindNvMarkDirty( x );
+  }
 #ifdef BDB_REPORTING
   bdb_RepUpdateMarkBindings();
 #endif
@@ -510,6 +565,7 @@ byte bindRemoveClusterIdFromList( BindingEntry_t *entry, uint16_t clusterId )
   byte x;
   uint16_t *listPtr;
   byte numIds;
+  bindTableIndex_t slot = bindIdxSlot( entry );
 
 #ifdef BDB_REPORTING
   uint8_t numRemoved = 0;
@@ -518,6 +574,12 @@ byte bindRemoveClusterIdFromList( BindingEntry_t *entry, uint16_t clusterId )
   {
     if ( entry->numClusterIds > 0 )
     {
+      // The cluster slots move, so the entry is indexed again afterwards
+      if ( slot < gNWK_MAX_BINDING_ENTRIES )
+      {
+        bindIdxRemove( slot );
+      }
+
       listPtr = entry->clusterIdList;
       numIds = entry->numClusterIds;
 
@@ -542,6 +604,11 @@ byte bindRemoveClusterIdFromList( BindingEntry_t *entry, uint16_t clusterId )
         }
       }
 
+      if ( slot < gNWK_MAX_BINDING_ENTRIES )
+      {
+        bindIdxAdd( slot );
+        bindNvMarkDirty( slot );
+      }
     }
   }
 
@@ -574,9 +641,22 @@ byte bindAddClusterIdToList( BindingEntry_t *entry, uint16_t clusterId )
 {
   if ( entry && entry->numClusterIds < gMAX_BINDING_CLUSTER_IDS )
   {
+    bindTableIndex_t slot = bindIdxSlot( entry );
+
+    if ( slot < gNWK_MAX_BINDING_ENTRIES )
+    {
+      bindIdxRemove( slot );
+    }
+
     // Add the new one
     entry->clusterIdList[entry->numClusterIds] = clusterId;
     entry->numClusterIds++;
+
+    if ( slot < gNWK_MAX_BINDING_ENTRIES )
+    {
+      bindIdxAdd( slot );
+      bindNvMarkDirty( slot );
+    }
     return ( TRUE );
   }
   return ( FALSE );
@@ -597,7 +677,8 @@ BindingEntry_t *bindFindExisting( byte srcEpInt,
                                   zAddrType_t *dstAddr, byte dstEpInt )
 {
   uint16_t dstIdx;
-  bindTableIndex_t x;
+  uint16_t node = BIND_IDX_NONE;
+  BindingEntry_t *pBind;
 
   // Find the records in the assoc list
   if ( dstAddr->addrMode == AddrGroup )
@@ -614,19 +695,23 @@ BindingEntry_t *bindFindExisting( byte srcEpInt,
     return ( (BindingEntry_t *)NULL );
   }
 
-  // Start at the beginning
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  if ( dstAddr->addrMode == AddrGroup )
   {
-    if ( BindingTable[x].srcEP == srcEpInt )
+    while ( (pBind = bindDstNext( dstIdx, DSTGROUPMODE_GROUP, &node )) != NULL )
     {
-      if ( ((dstAddr->addrMode == AddrGroup)
-              && (BindingTable[x].dstGroupMode == DSTGROUPMODE_GROUP)
-              && (dstIdx == BindingTable[x].dstIdx))
-         || ((dstAddr->addrMode != AddrGroup)
-             && (BindingTable[x].dstGroupMode == DSTGROUPMODE_ADDR)
-             && (dstIdx == BindingTable[x].dstIdx) && (BindingTable[x].dstEP == dstEpInt)) )
+      if ( pBind->srcEP == srcEpInt )
       {
-        return ( &BindingTable[x] );
+        return ( pBind );
+      }
+    }
+  }
+  else
+  {
+    while ( (pBind = bindDstNext( dstIdx, DSTGROUPMODE_ADDR, &node )) != NULL )
+    {
+      if ( (pBind->srcEP == srcEpInt) && (pBind->dstEP == dstEpInt) )
+      {
+        return ( pBind );
       }
     }
   }
@@ -649,7 +734,8 @@ BindingEntry_t *bindFindExisting( byte srcEpInt,
 void bindRemoveDev( zAddrType_t *Addr )
 {
   uint16_t idx;
-  bindTableIndex_t x;
+  uint16_t node = BIND_IDX_NONE;
+  BindingEntry_t *pBind;
 
   if ( Addr->addrMode == AddrGroup )
   {
@@ -665,16 +751,13 @@ void bindRemoveDev( zAddrType_t *Addr )
     return;
   }
 
-  // Removes all the entries that match the destination Address/Index
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  // Removes all the entries that match the destination Address/Index.
+  // A removed node keeps its link, so the walk goes on from it.
+  while ( (pBind = bindDstNext( idx, (Addr->addrMode == AddrGroup) ? DSTGROUPMODE_GROUP
+                                                                    : DSTGROUPMODE_ADDR,
+                                &node )) != NULL )
   {
-    if ( ( (Addr->addrMode == AddrGroup) && (BindingTable[x].dstGroupMode == DSTGROUPMODE_GROUP)
-                                         && (BindingTable[x].dstIdx == idx) ) ||
-         ( (Addr->addrMode != AddrGroup) && (BindingTable[x].dstGroupMode == DSTGROUPMODE_ADDR)
-                                         && (BindingTable[x].dstIdx == idx) ) )
-    {
-      bindRemoveEntry( &BindingTable[x] );
-    }
+    bindRemoveEntry( pBind );
   }
 
   // If this is the last Bind Entry for that idx then clear BINDING
@@ -746,22 +829,32 @@ byte bindNumBoundTo( zAddrType_t *devAddr, byte devEpInt, byte srcMode )
     idx = bindingAddrMgsHelperFind( devAddr );
   }
 
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  if ( srcMode )
   {
-    pBind = &BindingTable[x];
-    if ( srcMode )
+    for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
     {
-      if ( pBind->srcEP == devEpInt )
+      if ( BindingTable[x].srcEP == devEpInt )
       {
         num++;
       }
     }
-    else
+  }
+  else if ( devAddr->addrMode == AddrGroup )
+  {
+    uint16_t node = BIND_IDX_NONE;
+
+    while ( (pBind = bindDstNext( idx, DSTGROUPMODE_GROUP, &node )) != NULL )
     {
-      if ( ((devAddr->addrMode == AddrGroup)
-              && (pBind->dstGroupMode == DSTGROUPMODE_GROUP) && (pBind->dstIdx == idx))
-          || ((devAddr->addrMode != AddrGroup) && (pBind->dstGroupMode == DSTGROUPMODE_ADDR)
-                                && (pBind->dstIdx == idx) && (pBind->dstEP == devEpInt)) )
+      num++;
+    }
+  }
+  else if ( idx != INVALID_NODE_ADDR )
+  {
+    uint16_t node = BIND_IDX_NONE;
+
+    while ( (pBind = bindDstNext( idx, DSTGROUPMODE_ADDR, &node )) != NULL )
+    {
+      if ( pBind->dstEP == devEpInt )
       {
         num++;
       }
@@ -784,20 +877,15 @@ byte bindNumBoundTo( zAddrType_t *devAddr, byte devEpInt, byte srcMode )
  */
 uint16_t bindNumReflections( uint8_t ep, uint16_t clusterID )
 {
-  bindTableIndex_t x;
-  BindingEntry_t *pBind;
+  bindIter_t iter;
   uint16_t cnt = 0;
-  uint8_t bindEP;
 
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  if ( bindFindFirst( ep, clusterID, &iter ) != NULL )
   {
-    pBind = &BindingTable[x];
-    bindEP = pBind->srcEP;
-
-    if ( (bindEP == ep) && (bindIsClusterIDinList( pBind, clusterID )) )
+    do
     {
       cnt++;
-    }
+    } while ( bindFindNext( &iter ) != NULL );
   }
 
   return ( cnt );
@@ -808,6 +896,8 @@ uint16_t bindNumReflections( uint8_t ep, uint16_t clusterID )
  *
  * @brief       Finds the binding entry for the source address, endpoint
  *              and cluster ID passed in as a parameter.
+ *              To go through all the matches use bindFindFirst() and
+ *              bindFindNext() rather than increasing skipping.
  *
  * @param       ep - source endpoint
  * @param       clusterID - matching clusterID
@@ -817,30 +907,118 @@ uint16_t bindNumReflections( uint8_t ep, uint16_t clusterID )
  */
 BindingEntry_t *bindFind( uint8_t ep, uint16_t clusterID, uint8_t skipping )
 {
+  bindIter_t iter;
   BindingEntry_t *pBind;
-  byte skipped = 0;
-  bindTableIndex_t x;
 
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  pBind = bindFindFirst( ep, clusterID, &iter );
+
+  while ( (pBind != NULL) && (skipping-- > 0) )
   {
-    pBind = &BindingTable[x];
+    pBind = bindFindNext( &iter );
+  }
 
-    if ( ( pBind->srcEP == ep) && bindIsClusterIDinList( pBind, clusterID ))
+  return ( pBind );
+}
+
+/*********************************************************************
+ * @fn          bindFindFirst
+ *
+ * @brief       Finds the first binding entry, in binding table order, for
+ *              the source endpoint and cluster ID passed in as parameters
+ *              and sets up an iterator for the following ones.
+ *
+ * @param       ep - source endpoint
+ * @param       clusterID - matching clusterID
+ * @param       pIter - iterator to set up for bindFindNext()
+ *
+ * @return      pointer to the binding table entry, NULL if not found
+ */
+BindingEntry_t *bindFindFirst( uint8_t ep, uint16_t clusterID, bindIter_t *pIter )
+{
+  if ( bindIdxStale )
+  {
+    bindIdxRebuild();
+  }
+
+  pIter->ep = ep;
+  pIter->clusterID = clusterID;
+  pIter->node = BIND_IDX_NONE;
+
+  return ( bindFindNext( pIter ) );
+}
+
+/*********************************************************************
+ * @fn          bindFindNext
+ *
+ * @brief       Finds the next binding entry for the iterator set up by
+ *              bindFindFirst(). The binding table must not be changed
+ *              between the calls, except for removing the entry returned.
+ *
+ * @param       pIter - iterator
+ *
+ * @return      pointer to the binding table entry, NULL if no more
+ */
+BindingEntry_t *bindFindNext( bindIter_t *pIter )
+{
+  uint16_t node = pIter->node;
+
+  if ( node == BIND_IDX_NONE )
+  {
+    node = bindIdxClHead[BIND_IDX_CL_HASH( pIter->ep, pIter->clusterID )];
+  }
+  else
+  {
+    node = bindIdxClNext[node];
+  }
+
+  for ( ; node != BIND_IDX_NONE; node = bindIdxClNext[node] )
+  {
+    BindingEntry_t *pBind = &BindingTable[node / MAX_BINDING_CLUSTER_IDS];
+    uint8_t pos = node % MAX_BINDING_CLUSTER_IDS;
+
+    // The bucket is shared with other keys, and a cluster listed twice
+    // in an entry must only return the entry once
+    if ( (pBind->srcEP == pIter->ep) && (pos < pBind->numClusterIds) &&
+         (pBind->clusterIdList[pos] == pIter->clusterID) )
     {
-      if ( skipped < skipping )
+      uint8_t x;
+
+      for ( x = 0; x < pos; x++ )
       {
-        skipped++;
+        if ( pBind->clusterIdList[x] == pIter->clusterID )
+        {
+          break;
+        }
       }
-      else
+
+      if ( x == pos )
       {
+        pIter->node = node;
         return ( pBind );
       }
     }
   }
 
+  pIter->node = BIND_IDX_NONE;
   return ( (BindingEntry_t *)NULL );
 }
 
+/*********************************************************************
+ * @fn          bindIndexInvalidate
+ *
+ * @brief       Tells the binding table that BindingTable was changed
+ *              without going through the binding table functions, so
+ *              its lookup indexes are rebuilt before the next use.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+void bindIndexInvalidate( void )
+{
+  bindIdxStale = TRUE;
+}
+
 /*********************************************************************
  * @fn      bindAddressClear
  *
@@ -853,22 +1031,12 @@ BindingEntry_t *bindFind( uint8_t ep, uint16_t clusterID, uint8_t skipping )
  */
 void bindAddressClear( uint16_t dstIdx )
 {
-  bindTableIndex_t i;
+  uint16_t node = BIND_IDX_NONE;
 
   if ( dstIdx != INVALID_NODE_ADDR )
   {
     // Looks for a specific Idx
-    for ( i = 0; i < gNWK_MAX_BINDING_ENTRIES; i++ )
-    {
-      if ( ( BindingTable[i].dstGroupMode != AddrGroup ) &&
-           ( BindingTable[i].dstGroupMode == DSTGROUPMODE_ADDR ) &&
-           ( BindingTable[i].dstIdx == dstIdx ) )
-      {
-        break;  // found at least one
-      }
-    }
-
-    if ( i == gNWK_MAX_BINDING_ENTRIES )
+    if ( bindDstNext( dstIdx, DSTGROUPMODE_ADDR, &node ) == NULL )
     {
       // No binding entry is associated with dstIdx.
       // Remove user binding bit from the address manager entry corresponding to dstIdx.
@@ -913,6 +1081,8 @@ void bindUpdateAddr( uint16_t oldAddr, uint16_t newAddr )
     if ( pBind->dstIdx == oldIdx )
     {
       pBind->dstIdx = newIdx;
+      bindIdxStale = TRUE;
+      bindNvMarkDirty( x );
     }
   }
 }
@@ -1173,6 +1343,9 @@ void BindSetDefaultNV( void )
     // Over write each binding record with an "empty" record
     osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x, NV_BIND_REC_SIZE, &bind );
   }
+
+  // NV no longer holds what the changed records were changed from
+  memset( bindNvDirty, 0, sizeof( bindNvDirty ) );
 }
 
 /*********************************************************************
@@ -1189,6 +1362,9 @@ uint16_t BindRestoreFromNV( void )
   bindTableIndex_t x;
   uint16_t validRecsCount = 0;
 
+  bindIdxStale = TRUE;
+  memset( bindNvDirty, 0, sizeof( bindNvDirty ) );
+
   // Read in the device list
   for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
   {
@@ -1209,7 +1385,8 @@ uint16_t BindRestoreFromNV( void )
 /*********************************************************************
  * @fn          BindWriteNV
  *
- * @brief       Copy the Binding Table in NV
+ * @brief       Copy the Binding Table in NV. Only the records changed
+ *              since the last write are written.
  *
  * @param       none
  *
@@ -1219,13 +1396,303 @@ void BindWriteNV( void )
 {
   bindTableIndex_t x;
 
+  bindNvFlushPending = FALSE;
+
+  // Commit the changed records to Flash together
+  osal_nv_write_begin();
+
   for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
   {
-    // Save the record to NV
-    osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x,
-                     (uint16_t)NV_BIND_REC_SIZE, &BindingTable[x] );
+    if ( BIND_NV_IS_DIRTY( x ) )
+    {
+      bindNvDirty[x >> 3] &= ~(1 << (x & 7));
+
+      // Save the record to NV
+      osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x,
+                       (uint16_t)NV_BIND_REC_SIZE, &BindingTable[x] );
+
+      bindNvStats.recsWritten++;
+      bindNvStats.bytesWritten += NV_BIND_REC_SIZE;
+    }
+  }
+
+  osal_nv_write_commit();
+}
+
+/*********************************************************************
+ * @fn          bindMarkEntryChanged
+ *
+ * @brief       Tells the binding table that an entry was changed
+ *              without going through the binding table functions, so
+ *              that it is indexed and written to NV again.
+ *
+ * @param       pBind - binding table entry
+ *
+ * @return      none
+ */
+void bindMarkEntryChanged( BindingEntry_t *pBind )
+{
+  bindTableIndex_t x = bindIdxSlot( pBind );
+
+  if ( x < gNWK_MAX_BINDING_ENTRIES )
+  {
+    bindIdxStale = TRUE;
+    bindNvMarkDirty( x );
   }
 }
 
+/*********************************************************************
+ * @fn          bindGetNvStats
+ *
+ * @brief       Get the binding table NV write counters.
+ *
+ * @param       pStats - where to copy the counters
+ * @param       clear - TRUE to reset the counters
+ *
+ * @return      none
+ */
+void bindGetNvStats( bindNvStats_t *pStats, uint8_t clear )
+{
+  if ( pStats != NULL )
+  {
+    *pStats = bindNvStats;
+  }
+
+  if ( clear )
+  {
+    memset( &bindNvStats, 0, sizeof( bindNvStats ) );
+  }
+}
+
+/*********************************************************************
+ * @fn          bindNvMarkDirty
+ *
+ * @brief       Mark a binding record changed and arrange for it to be
+ *              written to NV after BIND_NV_FLUSH_DELAY.
+ *
+ * @param       x - binding table entry
+ *
+ * @return      none
+ */
+static void bindNvMarkDirty( bindTableIndex_t x )
+{
+  bindNvDirty[x >> 3] |= (1 << (x & 7));
+  bindNvStats.changes++;
+
+#if ( BIND_NV_FLUSH_DELAY == 0 )
+  BindWriteNV();
+#else
+  if ( bindNvFlushPending == FALSE )
+  {
+    if ( OsalPortTimers_startTimer( ZDAppTaskID, ZDO_BIND_UPDATE_NV, BIND_NV_FLUSH_DELAY ) == ZSuccess )
+    {
+      bindNvFlushPending = TRUE;
+    }
+    else
+    {
+      BindWriteNV();
+    }
+  }
+#endif
+}
+
+/*********************************************************************
+ * @fn          bindIdxLink
+ *
+ * @brief       Link a node into an index chain, which is kept in node
+ *              (and so binding table) order.
+ *
+ * @param       pHead - chain head
+ * @param       pNext - node links of the index
+ * @param       node - node to link
+ *
+ * @return      none
+ */
+static void bindIdxLink( uint16_t *pHead, uint16_t *pNext, uint16_t node )
+{
+  while ( (*pHead != BIND_IDX_NONE) && (*pHead < node) )
+  {
+    pHead = &pNext[*pHead];
+  }
+
+  pNext[node] = *pHead;
+  *pHead = node;
+}
+
+/*********************************************************************
+ * @fn          bindIdxUnlink
+ *
+ * @brief       Unlink a node from an index chain. The node keeps its own
+ *              link so that a walk that is on it can go on.
+ *
+ * @param       pHead - chain head
+ * @param       pNext - node links of the index
+ * @param       node - node to unlink
+ *
+ * @return      none
+ */
+static void bindIdxUnlink( uint16_t *pHead, uint16_t *pNext, uint16_t node )
+{
+  while ( (*pHead != BIND_IDX_NONE) && (*pHead != node) )
+  {
+    pHead = &pNext[*pHead];
+  }
+
+  if ( *pHead == node )
+  {
+    *pHead = pNext[node];
+  }
+  else
+  {
+    // The entry changed behind our back, start over from the table
+    bindIdxStale = TRUE;
+  }
+}
+
+/*********************************************************************
+ * @fn          bindIdxAdd
+ *
+ * @brief       Add a binding table entry to the indexes.
+ *
+ * @param       x - binding table entry
+ *
+ * @return      none
+ */
+static void bindIdxAdd( bindTableIndex_t x )
+{
+  BindingEntry_t *pBind = &BindingTable[x];
+  uint8_t pos;
+
+  if ( bindIdxStale || (pBind->srcEP == NV_BIND_EMPTY) )
+  {
+    return;
+  }
+
+  for ( pos = 0; (pos < pBind->numClusterIds) && (pos < MAX_BINDING_CLUSTER_IDS); pos++ )
+  {
+    bindIdxLink( &bindIdxClHead[BIND_IDX_CL_HASH( pBind->srcEP, pBind->clusterIdList[pos] )],
+                 bindIdxClNext, (uint16_t)x * MAX_BINDING_CLUSTER_IDS + pos );
+  }
+
+  bindIdxLink( &bindIdxDstHead[BIND_IDX_DST_HASH( pBind->dstIdx )], bindIdxDstNext, x );
+}
+
+/*********************************************************************
+ * @fn          bindIdxRemove
+ *
+ * @brief       Remove a binding table entry from the indexes.
+ *
+ * @param       x - binding table entry
+ *
+ * @return      none
+ */
+static void bindIdxRemove( bindTableIndex_t x )
+{
+  BindingEntry_t *pBind = &BindingTable[x];
+  uint8_t pos;
+
+  if ( bindIdxStale || (pBind->srcEP == NV_BIND_EMPTY) )
+  {
+    return;
+  }
+
+  for ( pos = 0; (pos < pBind->numClusterIds) && (pos < MAX_BINDING_CLUSTER_IDS); pos++ )
+  {
+    bindIdxUnlink( &bindIdxClHead[BIND_IDX_CL_HASH( pBind->srcEP, pBind->clusterIdList[pos] )],
+                   bindIdxClNext, (uint16_t)x * MAX_BINDING_CLUSTER_IDS + pos );
+  }
+
+  bindIdxUnlink( &bindIdxDstHead[BIND_IDX_DST_HASH( pBind->dstIdx )], bindIdxDstNext, x );
+}
+
+/*********************************************************************
+ * @fn          bindIdxRebuild
+ *
+ * @brief       Build the indexes from the binding table.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+static void bindIdxRebuild( void )
+{
+  bindTableIndex_t x;
+
+  memset( bindIdxClHead, 0xFF, sizeof( bindIdxClHead ) );
+  memset( bindIdxDstHead, 0xFF, sizeof( bindIdxDstHead ) );
+  bindIdxStale = FALSE;
+
+  // Going backwards, every node is linked at the head of its chain
+  for ( x = gNWK_MAX_BINDING_ENTRIES; x > 0; x-- )
+  {
+    bindIdxAdd( x - 1 );
+  }
+}
+
+/*********************************************************************
+ * @fn          bindIdxSlot
+ *
+ * @brief       Get the binding table index of an entry.
+ *
+ * @param       entry - binding table entry
+ *
+ * @return      index, or gNWK_MAX_BINDING_ENTRIES if the entry is
+ *              not in BindingTable
+ */
+static bindTableIndex_t bindIdxSlot( BindingEntry_t *entry )
+{
+  if ( (entry >= BindingTable) && (entry < &BindingTable[gNWK_MAX_BINDING_ENTRIES]) )
+  {
+    return ( (bindTableIndex_t)(entry - BindingTable) );
+  }
+
+  return ( gNWK_MAX_BINDING_ENTRIES );
+}
+
+/*********************************************************************
+ * @fn          bindDstNext
+ *
+ * @brief       Walk the binding table entries with a destination.
+ *
+ * @param       dstIdx - address manager index or group address
+ * @param       dstGroupMode - DSTGROUPMODE_ADDR or DSTGROUPMODE_GROUP
+ * @param       pNode - in: last node returned, BIND_IDX_NONE to start,
+ *                      out: node of the entry returned
+ *
+ * @return      pointer to the binding table entry, NULL if no more
+ */
+static BindingEntry_t *bindDstNext( uint16_t dstIdx, uint8_t dstGroupMode, uint16_t *pNode )
+{
+  uint16_t node = *pNode;
+
+  if ( node == BIND_IDX_NONE )
+  {
+    if ( bindIdxStale )
+    {
+      bindIdxRebuild();
+    }
+    node = bindIdxDstHead[BIND_IDX_DST_HASH( dstIdx )];
+  }
+  else
+  {
+    node = bindIdxDstNext[node];
+  }
+
+  for ( ; node != BIND_IDX_NONE; node = bindIdxDstNext[node] )
+  {
+    BindingEntry_t *pBind = &BindingTable[node];
+
+    if ( (pBind->srcEP != NV_BIND_EMPTY) && (pBind->dstIdx == dstIdx) &&
+         (pBind->dstGroupMode == dstGroupMode) )
+    {
+      *pNode = node;
+      return ( pBind );
+    }
+  }
+
+  *pNode = BIND_IDX_NONE;
+  return ( (BindingEntry_t *)NULL );
+}
+
 /*********************************************************************
 *********************************************************************/
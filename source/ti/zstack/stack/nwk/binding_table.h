@@ -97,6 +97,22 @@ typedef struct
                       // gMAX_BINDING_CLUSTER_IDS
 } BindingEntry_t;
 
+// Binding table NV write counters
+typedef struct
+{
+  uint32_t changes;       // Binding record changes
+  uint32_t recsWritten;   // Records written to NV
+  uint32_t bytesWritten;  // Bytes written to NV
+} bindNvStats_t;
+
+// Iterator over the binding table entries of a source endpoint and cluster
+typedef struct
+{
+  uint16_t node;
+  uint16_t clusterID;
+  uint8_t  ep;
+} bindIter_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -167,6 +183,32 @@ extern uint16_t bindNumReflections( uint8_t ep, uint16_t clusterID );
  */
 extern BindingEntry_t *bindFind( uint8_t ep, uint16_t clusterID, uint8_t skipping );
 
+/*
+ * Finds the first binding entry for the endpoint and clusterID and
+ * sets up the iterator for bindFindNext().
+ */
+extern BindingEntry_t *bindFindFirst( uint8_t ep, uint16_t clusterID, bindIter_t *pIter );
+
+/*
+ * Finds the next binding entry for the iterator.
+ */
+extern BindingEntry_t *bindFindNext( bindIter_t *pIter );
+
+/*
+ * Rebuild the lookup indexes after BindingTable was changed directly.
+ */
+extern void bindIndexInvalidate( void );
+
+/*
+ * Index and write to NV again an entry that was changed directly.
+ */
+extern void bindMarkEntryChanged( BindingEntry_t *pBind );
+
+/*
+ * Get the binding table NV write counters.
+ */
+extern void bindGetNvStats( bindNvStats_t *pStats, uint8_t clear );
+
 /*
  * Lookup a binding entry by specific Idx, if none is found
  * clears the BINDING user from Address Manager.
@@ -194,7 +236,7 @@ extern void BindSetDefaultNV( void );
 extern uint16_t BindRestoreFromNV( void );
 
 /*
- * Write Binding Table out to NV
+ * Write the changed Binding Table records out to NV
  */
 extern void BindWriteNV( void );
 
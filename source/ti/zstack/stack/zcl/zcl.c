@@ -115,6 +115,18 @@
 /*********************************************************************
  * CONSTANTS
  */
+// Number of slots in the endpoint dispatch table, must be a power of 2
+#ifndef ZCL_EP_DISPATCH_TABLE_SIZE
+  #define ZCL_EP_DISPATCH_TABLE_SIZE  8
+#endif
+
+// Number of slots in the cluster to plugin table, must be a power of 2
+#ifndef ZCL_PLUGIN_TABLE_SIZE
+  #define ZCL_PLUGIN_TABLE_SIZE       16
+#endif
+
+#define ZCL_EP_DISPATCH_IDX( ep )     ( (ep) & ( ZCL_EP_DISPATCH_TABLE_SIZE - 1 ) )
+#define ZCL_PLUGIN_IDX( clusterID )   ( ( (clusterID) ^ ( (clusterID) >> 8 ) ) & ( ZCL_PLUGIN_TABLE_SIZE - 1 ) )
 
 /*********************************************************************
  * TYPEDEFS
@@ -164,6 +176,27 @@ typedef struct zclExternalFoundationHandlerList
     uint8_t zcl_ExternalEndPoint;
 } zclExternalFoundationHandlerList;
 
+// Per-endpoint dispatch descriptor, resolved once from the registration lists
+typedef struct
+{
+  uint8_t                 valid;
+  uint8_t                 endpoint;
+  uint8_t                 externalTaskID; // task for unhandled foundation commands
+  zclAttrRecsList        *pAttrRecs;      // attribute records and RW/authorize callbacks
+#if defined ( ZCL_DISCOVER )
+  zclCmdRecsList_t       *pCmdRecs;       // command records
+#endif
+  zclClusterOptionList   *pOptions;       // first cluster option list of the endpoint
+} zclEpDispatch_t;
+
+// Cluster ID to plugin table slot
+typedef struct
+{
+  uint8_t                 valid;
+  uint16_t                clusterID;
+  zclLibPlugin_t         *pPlugin;        // NULL if no plugin handles the cluster
+} zclPluginSlot_t;
+
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -213,6 +246,11 @@ static zclIncoming_t *rawZCLCommand = (zclIncoming_t *)NULL; //fixed by luoyimin
 static zclExternalFoundationHandlerList *externalEndPointHandlerList = (zclExternalFoundationHandlerList *)NULL;
 #endif
 
+// Dispatch tables, cleared whenever a registration list changes
+static zclEpDispatch_t zclEpDispatchTable[ZCL_EP_DISPATCH_TABLE_SIZE];
+static zclPluginSlot_t zclPluginTable[ZCL_PLUGIN_TABLE_SIZE];
+static zclDispatchStats_t zclDispatchStats;
+
 //add by luoyiming, fix at 2019-3-15
 struct zclSendExtParam
 {
@@ -227,7 +265,13 @@ struct zclSendExtParam
  */
 static uint8_t *zclBuildHdr( zclFrameHdr_t *hdr, uint8_t *pData );
 static uint8_t zclCalcHdrSize( zclFrameHdr_t *hdr );
+static ZStatus_t zclSendCommand( uint8_t srcEP, afAddrType_t *destAddr,
+                                 uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                                 uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                                 uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t inPlace, uint8_t isReqFromApp );
 static zclLibPlugin_t *zclFindPlugin( uint16_t clusterID, uint16_t profileID );
+static zclEpDispatch_t *zclGetEpDispatch( uint8_t endpoint );
+static void zclInvalidateEpDispatch( void );
 
 #if !defined ( ZCL_STANDALONE )
 static uint8_t zcl_addExternalFoundationHandler( uint8_t taskId, uint8_t endPointId );
@@ -239,6 +283,7 @@ static uint8_t zcl_getExternalFoundationHandler( uint8_t endPointId );
 #endif
 
 zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint );
+static void zclBuildAttrRecsIdx( uint8_t numAttr, CONST zclAttrRec_t attrs[], uint8_t *pIdx );
 static zclOptionRec_t *zclFindClusterOption( uint8_t endpoint, uint16_t clusterID );
 static uint8_t zclGetClusterOption( uint8_t endpoint, uint16_t clusterID );
 static void zclSetSecurityOption( uint8_t endpoint, uint16_t clusterID, uint8_t enable );
@@ -620,6 +665,8 @@ uint8_t zcl_addExternalFoundationHandler( uint8_t taskId, uint8_t endPointId  )
     }
   }
 
+  zclInvalidateEpDispatch();
+
   return ( true );
 
 }
@@ -638,23 +685,7 @@ uint8_t zcl_addExternalFoundationHandler( uint8_t taskId, uint8_t endPointId  )
  *********************************************************************/
 static uint8_t zcl_getExternalFoundationHandler( uint8_t endPoint )
 {
-  zclExternalFoundationHandlerList *pLoop;
-  uint8_t addressedEndPointId = endPoint;
-
-  // make sure no one else tried to register for this endpoint
-  pLoop = externalEndPointHandlerList;
-
-  while ( pLoop != NULL )
-  {
-    if ( ( ( pLoop->zcl_ExternalEndPoint ) == addressedEndPointId ) ||
-         ( ( pLoop->zcl_ExternalEndPoint ) == AF_BROADCAST_ENDPOINT ) )
-    {
-      return ( pLoop->zcl_ExternalTaskID );
-    }
-    pLoop = pLoop->next;
-  }
-
-  return ( OsalPort_TASK_NO_TASK );
+  return ( zclGetEpDispatch( endPoint )->externalTaskID );
 }
 #endif
 
@@ -755,6 +786,23 @@ zclIncoming_t *zcl_getRawZCLCommand( void )
   return rawZCLCommand;
 }
 
+/*********************************************************************
+ * @fn          zcl_getDispatchStats
+ *
+ * @brief       Get the dispatch statistics. numLookups / numFrames gives
+ *              the average number of dispatch lookups per incoming frame,
+ *              numListWalks the number of lookups that had to walk the
+ *              registration lists.
+ *
+ * @param       pStats - where to copy the statistics
+ *
+ * @return      none
+ */
+void zcl_getDispatchStats( zclDispatchStats_t *pStats )
+{
+  *pStats = zclDispatchStats;
+}
+
 /*********************************************************************
  * @fn          zcl_registerPlugin
  *
@@ -803,6 +851,9 @@ ZStatus_t zcl_registerPlugin( uint16_t startClusterID,
     pLoop->next = pNewItem;
   }
 
+  // cached cluster lookups may now resolve to the new plugin
+  zcl_memset( zclPluginTable, 0, sizeof( zclPluginTable ) );
+
   return ( ZSuccess );
 }
 
@@ -852,6 +903,8 @@ ZStatus_t zcl_registerCmdList( uint8_t endpoint, CONST uint8_t cmdListSize, CONS
     pLoop->pNext = pNewItem;
   }
 
+  zclInvalidateEpDispatch();
+
   return ( ZSuccess );
 }
 #endif  // ZCL_DISCOVER
@@ -874,6 +927,7 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
 {
   zclAttrRecsList *pNewItem;
   zclAttrRecsList *pLoop;
+  uint8_t *pIdx;
 
   // Fill in the new profile list
   pNewItem = zcl_mem_alloc( sizeof( zclAttrRecsList ) );
@@ -882,12 +936,22 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
     return (ZMemError);
   }
 
+  // Sorted index of the attribute records, used for binary search lookups
+  pIdx = zcl_mem_alloc( numAttr ? numAttr : 1 );
+  if ( pIdx == NULL )
+  {
+    zcl_mem_free( pNewItem );
+    return (ZMemError);
+  }
+  zclBuildAttrRecsIdx( numAttr, newAttrList, pIdx );
+
   pNewItem->next = (zclAttrRecsList *)NULL;
   pNewItem->endpoint = endpoint;
   pNewItem->pfnReadWriteCB = NULL;
   pNewItem->pfnAuthorizeCB = NULL;
   pNewItem->numAttributes = numAttr;
   pNewItem->attrs = newAttrList;
+  pNewItem->attrIdx = pIdx;
 
   // Find spot in list
   if ( attrList == NULL )
@@ -907,6 +971,8 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
     pLoop->next = pNewItem;
   }
 
+  zclInvalidateEpDispatch();
+
   return ( ZSuccess );
 }
 
@@ -963,6 +1029,8 @@ ZStatus_t zcl_registerClusterOptionList( uint8_t endpoint, uint8_t numOption, zc
     pLoop->next = pNewItem;
   }
 
+  zclInvalidateEpDispatch();
+
   return ( ZSuccess );
 }
 
@@ -1223,6 +1291,84 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
                            uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
                            uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
                            uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t isReqFromApp )
+{
+  return zclSendCommand( srcEP, destAddr, clusterID, cmd, specific, direction, disableDefaultRsp,
+                         manuCode, seqNum, cmdFormatLen, cmdFormat, FALSE, isReqFromApp );
+}
+
+/*********************************************************************
+ * @fn      zcl_SendCommandInPlaceEx
+ *
+ * @brief   Same as zcl_SendCommandEx, but the ZCL header is built in the
+ *          ZCL_FRAME_HDR_MAX_LEN bytes the caller reserved in front of
+ *          cmdFormat, so the payload is sent without being copied.
+ *
+ * @param   srcEp - source endpoint
+ * @param   destAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNumber - identification number for the transaction
+ * @param   cmdFormatLen - length of the command to be sent
+ * @param   cmdFormat - command to be sent, preceded by ZCL_FRAME_HDR_MAX_LEN free bytes
+ * @param   isReqFromApp - Indicates where it comes from application thread or stack thread
+ *
+ * @return  ZSuccess if OK
+ */
+ZStatus_t zcl_SendCommandInPlaceEx( uint8_t srcEP, afAddrType_t *destAddr,
+                                    uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                                    uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                                    uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t isReqFromApp )
+{
+  return zclSendCommand( srcEP, destAddr, clusterID, cmd, specific, direction, disableDefaultRsp,
+                         manuCode, seqNum, cmdFormatLen, cmdFormat, TRUE, isReqFromApp );
+}
+
+/*********************************************************************
+ * @fn      zcl_GetCmdPayloadMTU
+ *
+ * @brief   Get the largest ZCL command payload that fits in a single
+ *          (unfragmented) data request.
+ *
+ * @param   srcEP - source endpoint
+ * @param   clusterID - cluster ID
+ * @param   addrMode - destination address mode
+ * @param   manuCode - manufacturer code, non zero adds it to the header
+ *
+ * @return  max payload length in bytes
+ */
+uint8_t zcl_GetCmdPayloadMTU( uint8_t srcEP, uint16_t clusterID, afAddrMode_t addrMode, uint16_t manuCode )
+{
+  afDataReqMTU_t mtu;
+  uint8_t hdrLen = ( manuCode != 0 ) ? ZCL_FRAME_HDR_MAX_LEN : ( ZCL_FRAME_HDR_MAX_LEN - 2 );
+  uint8_t len;
+
+  mtu.kvp = FALSE;
+  mtu.aps.addressingMode = addrMode;
+  mtu.aps.secure = ( zclGetClusterOption( srcEP, clusterID ) & AF_EN_SECURITY ) ? TRUE : FALSE;
+  len = afDataReqMTU( &mtu );
+
+  return ( ( len > hdrLen ) ? ( len - hdrLen ) : 0 );
+}
+
+/*********************************************************************
+ * @fn      zclSendCommand
+ *
+ * @brief   Build the ZCL header and send a command, common part of
+ *          zcl_SendCommandEx and zcl_SendCommandInPlaceEx.
+ *
+ * @param   inPlace - TRUE if cmdFormat is preceded by ZCL_FRAME_HDR_MAX_LEN
+ *                    free bytes for the header, FALSE to copy it
+ *
+ * @return  ZSuccess if OK
+ */
+static ZStatus_t zclSendCommand( uint8_t srcEP, afAddrType_t *destAddr,
+                                 uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                                 uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                                 uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t inPlace, uint8_t isReqFromApp )
 {
   endPointDesc_t *epDesc;
   zclFrameHdr_t hdr;
@@ -1330,10 +1476,18 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
 
   // calculate the needed buffer size
   msgLen = zclCalcHdrSize( &hdr );
+
+  // Allocate the buffer needed, or use the space in front of the payload
+  if ( inPlace )
+  {
+    msgBuf = cmdFormat - msgLen;
+  }
+  else
+  {
+    msgBuf = zcl_mem_alloc( msgLen + cmdFormatLen );
+  }
   msgLen += cmdFormatLen;
 
-  // Allocate the buffer needed
-  msgBuf = zcl_mem_alloc( msgLen );
   if ( msgBuf != NULL )
   {
     //1-junp radius for no-routing,add by luoyiming
@@ -1347,7 +1501,10 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
     pBuf = zclBuildHdr( &hdr, msgBuf );
 
     // Fill in the command frame
-    zcl_memcpy( pBuf, cmdFormat, cmdFormatLen );
+    if ( !inPlace )
+    {
+      zcl_memcpy( pBuf, cmdFormat, cmdFormatLen );
+    }
 
     if(isReqFromApp)
     {
@@ -1359,7 +1516,10 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
       status = AF_DataRequestExt( destAddr, epDesc, clusterID, msgLen, msgBuf,
                                  &zcl_TransID, options, radius, cnfCB, cnfParam );
     }
-    zcl_mem_free ( msgBuf );
+    if ( !inPlace )
+    {
+      zcl_mem_free ( msgBuf );
+    }
   }
   else
   {
@@ -2443,6 +2603,8 @@ zclProcMsgStatus_t zcl_ProcessMessageMSG( afIncomingMSGPacket_t *pkt )
     return ( ZCL_PROC_INVALID );   // Error, ignore the message
   }
 
+  zclDispatchStats.numFrames++;
+
   // Initialize
   rawAFMsg = (afIncomingMSGPacket_t *)pkt;
   inMsg.msg = pkt;
@@ -2780,48 +2942,141 @@ static uint8_t zclCalcHdrSize( zclFrameHdr_t *hdr )
  */
 static zclLibPlugin_t *zclFindPlugin( uint16_t clusterID, uint16_t profileID )
 {
-  zclLibPlugin_t *pLoop = plugins;
+  zclPluginSlot_t *pSlot = &zclPluginTable[ZCL_PLUGIN_IDX( clusterID )];
+  zclLibPlugin_t *pLoop;
 
   (void)profileID;  // Intentionally unreferenced parameter
 
+  zclDispatchStats.numLookups++;
+  if ( pSlot->valid && ( pSlot->clusterID == clusterID ) )
+  {
+    return ( pSlot->pPlugin );
+  }
+
+  // Not resolved yet, walk the plugin list and keep the result
+  zclDispatchStats.numListWalks++;
+  pLoop = plugins;
   while ( pLoop != NULL )
   {
     if ( ( clusterID >= pLoop->startClusterID ) && ( clusterID <= pLoop->endClusterID ) )
     {
-      return ( pLoop );
+      break;
     }
 
     pLoop = pLoop->next;
   }
 
-  return ( (zclLibPlugin_t *)NULL );
+  pSlot->valid = TRUE;
+  pSlot->clusterID = clusterID;
+  pSlot->pPlugin = pLoop;
+
+  return ( pLoop );
 }
 
-#ifdef ZCL_DISCOVER
 /*********************************************************************
- * @fn      zclFindCmdRecsList
+ * @fn      zclGetEpDispatch
  *
- * @brief   Find the right command record list for an endpoint
+ * @brief   Get the dispatch descriptor of an endpoint. The descriptor is
+ *          resolved from the registration lists on the first lookup and
+ *          kept in a direct-mapped table until a registration changes.
  *
  * @param   endpoint - endpoint to look for
  *
- * @return  pointer to record list, NULL if not found
+ * @return  pointer to the dispatch descriptor
  */
-static zclCmdRecsList_t *zclFindCmdRecsList( uint8_t endpoint )
+static zclEpDispatch_t *zclGetEpDispatch( uint8_t endpoint )
 {
-  zclCmdRecsList_t *pLoop = gpCmdList;
+  zclEpDispatch_t *pDesc = &zclEpDispatchTable[ZCL_EP_DISPATCH_IDX( endpoint )];
+  zclAttrRecsList *pAttrLoop;
+#if defined ( ZCL_DISCOVER )
+  zclCmdRecsList_t *pCmdLoop;
+#endif
+  zclClusterOptionList *pOptionLoop;
+#if !defined ( ZCL_STANDALONE )
+  zclExternalFoundationHandlerList *pHdlrLoop;
+#endif
 
-  while ( pLoop != NULL )
+  zclDispatchStats.numLookups++;
+  if ( pDesc->valid && ( pDesc->endpoint == endpoint ) )
   {
-    if ( pLoop->endpoint == endpoint )
+    return ( pDesc );
+  }
+
+  zclDispatchStats.numListWalks++;
+  pDesc->endpoint = endpoint;
+
+  pAttrLoop = attrList;
+  while ( ( pAttrLoop != NULL ) && ( pAttrLoop->endpoint != endpoint ) )
+  {
+    pAttrLoop = pAttrLoop->next;
+  }
+  pDesc->pAttrRecs = pAttrLoop;
+
+#if defined ( ZCL_DISCOVER )
+  pCmdLoop = gpCmdList;
+  while ( ( pCmdLoop != NULL ) && ( pCmdLoop->endpoint != endpoint ) )
+  {
+    pCmdLoop = pCmdLoop->pNext;
+  }
+  pDesc->pCmdRecs = pCmdLoop;
+#endif
+
+  pOptionLoop = clusterOptionList;
+  while ( ( pOptionLoop != NULL ) && ( pOptionLoop->endpoint != endpoint ) )
+  {
+    pOptionLoop = pOptionLoop->next;
+  }
+  pDesc->pOptions = pOptionLoop;
+
+#if !defined ( ZCL_STANDALONE )
+  // Task registered for this endpoint, or for all endpoints
+  pHdlrLoop = externalEndPointHandlerList;
+  pDesc->externalTaskID = OsalPort_TASK_NO_TASK;
+  while ( pHdlrLoop != NULL )
+  {
+    if ( ( pHdlrLoop->zcl_ExternalEndPoint == endpoint ) ||
+         ( pHdlrLoop->zcl_ExternalEndPoint == AF_BROADCAST_ENDPOINT ) )
     {
-      return ( pLoop );
+      pDesc->externalTaskID = pHdlrLoop->zcl_ExternalTaskID;
+      break;
     }
-
-    pLoop = pLoop->pNext;
+    pHdlrLoop = pHdlrLoop->next;
   }
+#endif
 
-  return ( NULL );
+  pDesc->valid = TRUE;
+
+  return ( pDesc );
+}
+
+/*********************************************************************
+ * @fn      zclInvalidateEpDispatch
+ *
+ * @brief   Drop all resolved endpoint dispatch descriptors, called when
+ *          one of the per-endpoint registration lists changes.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void zclInvalidateEpDispatch( void )
+{
+  zcl_memset( zclEpDispatchTable, 0, sizeof( zclEpDispatchTable ) );
+}
+
+#ifdef ZCL_DISCOVER
+/*********************************************************************
+ * @fn      zclFindCmdRecsList
+ *
+ * @brief   Find the right command record list for an endpoint
+ *
+ * @param   endpoint - endpoint to look for
+ *
+ * @return  pointer to record list, NULL if not found
+ */
+static zclCmdRecsList_t *zclFindCmdRecsList( uint8_t endpoint )
+{
+  return ( zclGetEpDispatch( endpoint )->pCmdRecs );
 }
 
 /*********************************************************************
@@ -2882,19 +3137,84 @@ uint8_t zclFindCmdRecEx( uint8_t endpoint, uint16_t clusterID, uint16_t manuCode
  */
 zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint )
 {
-  zclAttrRecsList *pLoop = attrList;
+  return ( zclGetEpDispatch( endpoint )->pAttrRecs );
+}
 
-  while ( pLoop != NULL )
+/*********************************************************************
+ * @fn      zclBuildAttrRecsIdx
+ *
+ * @brief   Build the index of an attribute record array, sorted by
+ *          (clusterID, attrId). Records with the same key keep their
+ *          order in the array, so lookups return the same record as a
+ *          linear scan would. Insertion sort is used since the records
+ *          are normally already grouped by cluster in ascending order.
+ *
+ * @param   numAttr - number of attribute records
+ * @param   attrs - array of attribute records
+ * @param   pIdx - index to be filled, numAttr entries
+ *
+ * @return  none
+ */
+static void zclBuildAttrRecsIdx( uint8_t numAttr, CONST zclAttrRec_t attrs[], uint8_t *pIdx )
+{
+  uint16_t i;
+  uint16_t j;
+  uint8_t cur;
+
+  for ( i = 0; i < numAttr; i++ )
   {
-    if ( pLoop->endpoint == endpoint )
+    cur = (uint8_t)i;
+    j = i;
+
+    while ( ( j > 0 ) &&
+            ( ( attrs[pIdx[j - 1]].clusterID > attrs[cur].clusterID ) ||
+              ( ( attrs[pIdx[j - 1]].clusterID == attrs[cur].clusterID ) &&
+                ( attrs[pIdx[j - 1]].attr.attrId > attrs[cur].attr.attrId ) ) ) )
     {
-      return ( pLoop );
+      pIdx[j] = pIdx[j - 1];
+      j--;
     }
 
-    pLoop = pLoop->next;
+    pIdx[j] = cur;
   }
+}
 
-  return ( NULL );
+/*********************************************************************
+ * @fn      zclFindAttrRecsIdx
+ *
+ * @brief   Binary search the sorted attribute index of a record list
+ *
+ * @param   pRec - attribute record list of the endpoint
+ * @param   clusterID - cluster ID looking for
+ * @param   attrId - attribute ID looking for
+ *
+ * @return  position of the first indexed record whose (clusterID, attrId)
+ *          is not less than the requested one, pRec->numAttributes if none
+ */
+uint8_t zclFindAttrRecsIdx( zclAttrRecsList *pRec, uint16_t clusterID, uint16_t attrId )
+{
+  uint16_t lo = 0;
+  uint16_t hi = pRec->numAttributes;
+  uint16_t mid;
+  CONST zclAttrRec_t *pAttr;
+
+  while ( lo < hi )
+  {
+    mid = ( lo + hi ) / 2;
+    pAttr = zclAttrRecsIdxRec( pRec, mid );
+
+    if ( ( pAttr->clusterID < clusterID ) ||
+         ( ( pAttr->clusterID == clusterID ) && ( pAttr->attr.attrId < attrId ) ) )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return ( (uint8_t)lo );
 }
 
 /*********************************************************************
@@ -2914,8 +3234,9 @@ zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint )
  */
 uint8_t zclFindAttrRecEx( uint8_t endpoint, uint16_t clusterID, uint16_t manuCode, uint8_t direction, uint16_t attrId, zclAttrRec_t *pAttr )
 {
-  uint8_t x;
+  uint16_t x;
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
+  CONST zclAttrRec_t *pCur;
   uint8_t matchManuCode = FALSE;
 
   // match manufacturer-cluster, fixed by luoyiming 2020-01-08
@@ -2927,23 +3248,26 @@ uint8_t zclFindAttrRecEx( uint8_t endpoint, uint16_t clusterID, uint16_t manuCod
 
   if ( pRec != NULL )
   {
-    for ( x = 0; x < pRec->numAttributes; x++ )
+    // only the records with the same (clusterID, attrId) need to be checked
+    for ( x = zclFindAttrRecsIdx( pRec, clusterID, attrId ); x < pRec->numAttributes; x++ )
     {
+      pCur = zclAttrRecsIdxRec( pRec, x );
+      if ( pCur->clusterID != clusterID || pCur->attr.attrId != attrId )
+      {
+        break;
+      }
       // match manufacturer attribute at first, luoyiming 2020-01-08
-      if ( ( pRec->attrs[x].attr.accessControl & ACCESS_MANU_ATTR ) && matchManuCode == FALSE )
+      if ( ( pCur->attr.accessControl & ACCESS_MANU_ATTR ) && matchManuCode == FALSE )
       {
         continue;
       }
-      if ( pRec->attrs[x].clusterID == clusterID && pRec->attrs[x].attr.attrId == attrId )
+      //match direction, fixed by luoyiming 2019-11-16
+      if ( (pCur->attr.accessControl & ACCESS_GLOBAL) ||
+           ( GET_BIT( &(pCur->attr.accessControl), ACCESS_CONTROL_MASK ) == direction ) )
       {
-        //match direction, fixed by luoyiming 2019-11-16
-        if ( (pRec->attrs[x].attr.accessControl & ACCESS_GLOBAL) ||
-             ( GET_BIT( &(pRec->attrs[x].attr.accessControl), ACCESS_CONTROL_MASK ) == direction ) )
-        {
-          *pAttr = pRec->attrs[x];
+        *pAttr = *pCur;
 
-          return ( TRUE ); // EMBEDDED RETURN
-        }
+        return ( TRUE ); // EMBEDDED RETURN
       }
     }
   }
@@ -2970,9 +3294,19 @@ uint8_t zclFindAttrRecEx( uint8_t endpoint, uint16_t clusterID, uint16_t manuCod
 uint8_t zclSetAttrRecList( uint8_t endpoint, uint8_t numAttr, CONST zclAttrRec_t attrList[] )
 {
   zclAttrRecsList *pRecsList = zclFindAttrRecsList( endpoint );
+  uint8_t *pIdx;
 
   if ( pRecsList != NULL )
   {
+    pIdx = zcl_mem_alloc( numAttr ? numAttr : 1 );
+    if ( pIdx == NULL )
+    {
+      return ( FALSE );
+    }
+    zclBuildAttrRecsIdx( numAttr, attrList, pIdx );
+
+    zcl_mem_free( pRecsList->attrIdx );
+    pRecsList->attrIdx = pIdx;
     pRecsList->numAttributes = numAttr;
     pRecsList->attrs = attrList;
     return ( TRUE );
@@ -3042,7 +3376,8 @@ static zclOptionRec_t *zclFindClusterOption( uint8_t endpoint, uint16_t clusterI
 {
   zclClusterOptionList *pLoop;
 
-  pLoop = clusterOptionList;
+  // start from the first option list of the endpoint
+  pLoop = zclGetEpDispatch( endpoint )->pOptions;
   while ( pLoop != NULL )
   {
     if ( pLoop->endpoint == endpoint )
@@ -3232,7 +3567,8 @@ static uint8_t zclFindNextCmdRec( uint8_t endpoint, uint16_t clusterID, uint16_t
  * @param   clusterID - cluster ID
  * @param   manuCode - manufacturer code, added by luoyiming
  * @param   attr - attribute looking for
- * @param   startIdx - startIdx of zclAttrRecsList, luoyiming fix at 2020-07-11
+ * @param   startIdx - position in the sorted attribute index to start from,
+ *                     updated with the position of the found record
  *
  * @return  pointer to attribute record, NULL if not found
  */
@@ -3240,6 +3576,7 @@ static uint8_t zclFindNextAttrRec( uint8_t endpoint, uint16_t clusterID, uint16_
                                    uint16_t *attrId, zclAttrRec_t *pAttr, uint8_t *startIdx )
 {
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
+  CONST zclAttrRec_t *pCur;
   uint8_t attrDir;
   uint8_t matchManuCode = FALSE;
 
@@ -3253,26 +3590,35 @@ static uint8_t zclFindNextAttrRec( uint8_t endpoint, uint16_t clusterID, uint16_
   {
     uint16_t x;
 
-    for ( x = *startIdx; x < pRec->numAttributes; x++ )
+    // skip directly to the first record of the cluster with ID >= *attrId
+    x = zclFindAttrRecsIdx( pRec, clusterID, *attrId );
+    if ( x < *startIdx )
     {
+      x = *startIdx;
+    }
+
+    for ( ; x < pRec->numAttributes; x++ )
+    {
+      pCur = zclAttrRecsIdxRec( pRec, x );
+      if ( pCur->clusterID != clusterID )
+      {
+        break; // no more records of this cluster
+      }
       // match manufacturer attribute at first, luoyiming 2020-01-08
-      if ( ( pRec->attrs[x].attr.accessControl & ACCESS_MANU_ATTR ) && matchManuCode == FALSE )
+      if ( ( pCur->attr.accessControl & ACCESS_MANU_ATTR ) && matchManuCode == FALSE )
       {
         continue;
       }
-      if ( ( pRec->attrs[x].clusterID == clusterID ) && ( pRec->attrs[x].attr.attrId >= *attrId ) )
+      // also make sure direction is right
+      attrDir = (pCur->attr.accessControl & ACCESS_CLIENT) ? 1 : 0;
+      if ( (attrDir == direction) || (pCur->attr.accessControl & ACCESS_GLOBAL) )
       {
-        // also make sure direction is right
-        attrDir = (pRec->attrs[x].attr.accessControl & ACCESS_CLIENT) ? 1 : 0;
-        if ( (attrDir == direction) || (pRec->attrs[x].attr.accessControl & ACCESS_GLOBAL) )
-        {
-          // return attribute and found attribute ID
-          *pAttr = pRec->attrs[x];
-          *attrId = pAttr->attr.attrId;
-          *startIdx = x; // Update startIdx for next loop, luoyiming 2020-07-11
+        // return attribute and found attribute ID
+        *pAttr = *pCur;
+        *attrId = pAttr->attr.attrId;
+        *startIdx = (uint8_t)x; // Update startIdx for next loop, luoyiming 2020-07-11
 
-          return ( TRUE ); // EMBEDDED RETURN
-        }
+        return ( TRUE ); // EMBEDDED RETURN
       }
     }
   }
@@ -3716,6 +4062,40 @@ ZStatus_t zcl_ReadAttrDataEx( uint8_t endpoint, uint16_t clusterId, uint16_t man
   }
 }
 
+/*********************************************************************
+ * @fn      zcl_GetAttrDataLengthEx
+ *
+ * @brief   Get the length of the attribute's current value.
+ *          Use application's callback function if assigned to this attribute.
+ *
+ * @param   endpoint - application's endpoint
+ * @param   clusterId - cluster that attribute belongs to
+ * @param   manuCode - manufacturer code
+ * @param   direction - the direction of attribute
+ * @param   attrId - attribute id
+ *
+ * @return  attribute length, 0 if the attribute was not found
+ */
+uint16_t zcl_GetAttrDataLengthEx( uint8_t endpoint, uint16_t clusterId, uint16_t manuCode,
+                                  uint8_t direction, uint16_t attrId )
+{
+  zclAttrRec_t attrRec;
+
+  if ( zclFindAttrRecEx( endpoint, clusterId, manuCode, direction, attrId, &attrRec ) == FALSE )
+  {
+    return ( 0 );
+  }
+
+  if ( attrRec.attr.dataPtr != NULL )
+  {
+    return zclGetAttrDataLength( attrRec.attr.dataType, attrRec.attr.dataPtr );
+  }
+  else
+  {
+    return zclGetAttrDataLengthUsingCB( endpoint, &attrRec );
+  }
+}
+
 /*********************************************************************
  * @fn      zclGetAttrDataLengthUsingCB
  *
@@ -491,6 +491,9 @@ extern "C"
 #define ZCL_FRAME_CONTROL_DIRECTION                     0x08
 #define ZCL_FRAME_CONTROL_DISABLE_DEFAULT_RSP           0x10
 
+// frame control + manufacturer code + transaction seq num + command ID
+#define ZCL_FRAME_HDR_MAX_LEN                           5
+
 /*** Frame Types ***/
 #define ZCL_FRAME_TYPE_PROFILE_CMD                      0x00
 #define ZCL_FRAME_TYPE_SPECIFIC_CMD                     0x01
@@ -1201,8 +1204,12 @@ typedef struct zclAttrRecsList
   zclAuthorizeCB_t       pfnAuthorizeCB;//!< Authorize Read or Write operation
   uint8_t                  numAttributes; //!< Number of the following records
   CONST zclAttrRec_t     *attrs;        //!< attribute records
+  uint8_t                 *attrIdx;      //!< attrs[] positions sorted by (clusterID, attrId)
 } zclAttrRecsList;
 
+/// Attribute record at position 'pos' of the sorted attribute index
+#define zclAttrRecsIdxRec( pRec, pos )  ( &((pRec)->attrs[(pRec)->attrIdx[(pos)]]) )
+
 /*!
  *
  * @brief  Callback function to get sub-manufacturer-code, added by luoyiming 2020-01-11.
@@ -1215,6 +1222,14 @@ typedef struct zclAttrRecsList
  */
 typedef uint16_t (*zclSubManuCodeCB_t)( uint16_t clusterID );
 
+/// ZCL dispatch statistics
+typedef struct
+{
+  uint32_t numFrames;      //!< Incoming frames processed by zcl_ProcessMessageMSG()
+  uint32_t numLookups;     //!< Endpoint and plugin dispatch table lookups
+  uint32_t numListWalks;   //!< Lookups that missed the tables and walked the registration lists
+} zclDispatchStats_t;
+
 /** @} End ZCL_TYPEDEFS */
 
 /*********************************************************************
@@ -1539,6 +1554,20 @@ extern uint16_t zcl_GetManuCode( uint16_t clusterID );
  */
 extern uint8_t zcl_MatchClusterManuCode( uint16_t clusterID, uint16_t manuCode );
 
+/*********************************************************************
+ * @fn          zclFindAttrRecsIdx
+ *
+ * @brief       Binary search the sorted attribute index of a record list
+ *
+ * @param       pRec - attribute record list of the endpoint
+ * @param       clusterID - cluster ID looking for
+ * @param       attrId - attribute ID looking for
+ *
+ * @return      position of the first indexed record whose (clusterID, attrId)
+ *              is not less than the requested one, pRec->numAttributes if none
+ */
+extern uint8_t zclFindAttrRecsIdx( zclAttrRecsList *pRec, uint16_t clusterID, uint16_t attrId );
+
 /*********************************************************************
  * @fn          zcl_ValidAttrManuCode
  *
@@ -1594,6 +1623,42 @@ extern ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *dstAddr,
                                   uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
                                   uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t isReqFromApp  );
 
+/**
+ * @brief   Send a command whose payload is preceded by ZCL_FRAME_HDR_MAX_LEN
+ *          bytes reserved for the ZCL header, the payload is not copied.
+ *
+ * @param   srcEP - source endpoint
+ * @param   dstAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNum - identification number for the transaction
+ * @param   cmdFormatLen - length of the command to be sent
+ * @param   cmdFormat - command to be sent
+ * @param   isReqFromApp - Indicates where it comes from application thread or stack thread
+ *
+ * @return  ZSuccess if OK
+ */
+extern ZStatus_t zcl_SendCommandInPlaceEx( uint8_t srcEP, afAddrType_t *dstAddr,
+                                           uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                                           uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                                           uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t isReqFromApp );
+
+/**
+ * @brief   Get the largest ZCL command payload that fits in a single data request
+ *
+ * @param   srcEP - source endpoint
+ * @param   clusterID - cluster ID
+ * @param   addrMode - destination address mode
+ * @param   manuCode - manufacturer code, non zero adds it to the header
+ *
+ * @return  max payload length in bytes
+ */
+extern uint8_t zcl_GetCmdPayloadMTU( uint8_t srcEP, uint16_t clusterID, afAddrMode_t addrMode, uint16_t manuCode );
+
 extern uint8_t zcl_SetSendExtParam( pfnAfCnfCB cnfCB, void* cnfParam, uint8_t options );
 
 extern void zcl_ClearSendExtParam( void );
@@ -1649,6 +1714,19 @@ extern ZStatus_t zcl_SendReadRsp( uint8_t srcEP, afAddrType_t *dstAddr, uint16_t
 extern ZStatus_t zcl_ReadAttrDataEx( uint8_t endpoint, uint16_t clusterId, uint16_t manuCode,
                                      uint8_t direction, uint16_t attrId, uint8_t *pAttrData, uint16_t *pDataLen );
 
+/*!
+ *
+ * @param   endpoint - application's endpoint
+ * @param   clusterId - cluster that attribute belongs to
+ * @param   manuCode - manufacturer code
+ * @param   direction - the direction of attribute
+ * @param   attrId - attribute id
+ *
+ * @return  attribute length, 0 if the attribute was not found
+ */
+extern uint16_t zcl_GetAttrDataLengthEx( uint8_t endpoint, uint16_t clusterId, uint16_t manuCode,
+                                         uint8_t direction, uint16_t attrId );
+
 #endif // ZCL_READ
 
 #ifdef ZCL_WRITE
@@ -2112,6 +2190,14 @@ extern afIncomingMSGPacket_t *zcl_getRawAFMsg( void );
  */
 extern zclIncoming_t *zcl_getRawZCLCommand( void );
 
+/*!
+ *
+ * @param       pStats - where to copy the dispatch statistics
+ *
+ * @return      none
+ */
+extern void zcl_getDispatchStats( zclDispatchStats_t *pStats );
+
 
 /*!
  *
@@ -1230,45 +1230,18 @@ static uint8_t gp_addPairedSinksToMsgQueue( gpdID_t* pGpdID, gpCmdPayloadMsg_t*
 {
   uint8_t freeSinkEntry[LSINK_ADDR_LEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
   uint8_t status;
-  uint8_t i;
+  uint16_t nvIndex;
   uint8_t currEntry[PROXY_TBL_LEN];
   afAddrType_t dstAddr = {0};
   gpNotificationMsg_t *pNotificationMsgCurr = NULL;
 
-  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+  // Only the matching slot is read, found through the proxy table index
+  if(gp_getProxyTableByGpId(pGpdID, currEntry, &nvIndex) != ZSuccess)
   {
-    status = gp_getProxyTableByIndex(i, currEntry);
-    if(status == NV_OPER_FAILED)
-    {
-      break;
-    }
-
-    // if the entry is empty
-    if(status == NV_INVALID_DATA)
-    {
-      continue;
-    }
-
-    if(GP_TBL_COMP_APPLICATION_ID( pGpdID->appID, currEntry[PROXY_TBL_OPT]))
-    {
-      if(zcl_memcmp(&pGpdID->id.srcID, &currEntry[PROXY_TBL_GPD_ID + 4], sizeof(uint32_t)))
-      {
-        // Entry found
-        break;
-      }
-      else if(zcl_memcmp(pGpdID->id.gpdExtAddr, &currEntry[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN))
-      {
-        // Entry found
-        break;
-      }
-    }
-  }
-  // proxy table entry not found
-  if(status == NV_INVALID_DATA &&
-     i >= GPP_MAX_PROXY_TABLE_ENTRIES)
-  {
-    return status;
+    // proxy table entry not found
+    return NV_INVALID_DATA;
   }
+  status = SUCCESS;
 
   dstAddr.endPoint = GREEN_POWER_INTERNAL_ENDPOINT;
   dstAddr.panId = _NIB.nwkPanId;
@@ -174,6 +174,12 @@ static uint8_t* buffer_uint32( uint8_t *buf, uint32_t val );
 #endif
 
 #if (defined OTA_CLIENT_STANDALONE) || (defined OTA_CLIENT_INTEGRATED)
+static uint8_t zclOTA_ProcessElementData ( uint8_t *pData, uint8_t len );
+#if defined OTA_MMO_SIGN
+static void zclOTA_HashData ( uint8_t *pData, uint8_t len );
+#endif
+static uint8_t oadStartImage(void);
+static uint8_t oadWriteImage(uint8_t *pData, uint8_t len);
 static uint8_t oadEraseExtFlashPages(uint8_t imgStartPage, uint8_t imgPageLen);
 static uint8_t oadCheckDL(uint8_t imagePage);
 #endif
@@ -769,9 +775,11 @@ ZStatus_t zclOTA_SendUpgradeEndReq (uint8_t srcEp, afAddrType_t *dstAddr,
  */
 uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 {
-  int8_t i;
+  uint8_t status;
+  uint8_t i;
+  uint8_t run;
 #if defined OTA_MMO_SIGN
-  uint8_t skipHash = FALSE;
+  uint8_t hashLen;
 #endif
 
   if ( *zclOTA_ImageUpgradeStatus != OTA_STATUS_IN_PROGRESS )
@@ -779,8 +787,13 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
     return ZCL_STATUS_ABORT;
   }
 
-  for ( i=0; i<len; i++ )
+  for ( i = 0; i < len; i += run )
   {
+    run = 1;
+#if defined OTA_MMO_SIGN
+    hashLen = 1;
+#endif
+
     switch ( zclOTA_ClientPdState )
     {
         // verify header magic number
@@ -871,7 +884,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 
       case ZCL_OTA_PD_ELEM_LEN4_STATE:
         zclOTA_ElementLen |= ( ( uint32_t ) pData[i] << 24 ) & 0xFF000000;
-        zclOTA_ClientPdState = ZCL_OTA_PD_ELEMENT_STATE;
+        zclOTA_ClientPdState = ( zclOTA_ElementLen != 0 ) ? ZCL_OTA_PD_ELEMENT_STATE : ZCL_OTA_PD_ELEM_TAG1_STATE;
 
         // Make sure the length of the element isn't bigger than the image
         if ( zclOTA_ElementLen > ( zclOTA_DownloadedImageSize - *zclOTA_FileOffset ) )
@@ -905,234 +918,45 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
         break;
 
       case ZCL_OTA_PD_ELEMENT_STATE:
+        // Element data is consumed in runs, up to the end of the element
+        if ( ( zclOTA_ElementLen - zclOTA_ElementPos ) < (uint32_t)( len - i ) )
+        {
+          run = (uint8_t)( zclOTA_ElementLen - zclOTA_ElementPos );
+        }
+        else
+        {
+          run = len - i;
+        }
+
 #if defined OTA_MMO_SIGN
+        // The hash covers the signer IEEE but not the signature itself
+        hashLen = run;
         if ( zclOTA_ElementTag == OTA_ECDSA_SIGNATURE_TAG_ID )
         {
-          if ( zclOTA_ElementPos < Z_EXTADDR_LEN )
-            zclOTA_SignerIEEE[zclOTA_ElementPos] = pData[i];
-          else
+          if ( zclOTA_ElementPos >= Z_EXTADDR_LEN )
           {
-            zclOTA_SignatureData[zclOTA_ElementPos - Z_EXTADDR_LEN] = pData[i];
-
-            skipHash = TRUE;
+            hashLen = 0;
+          }
+          else if ( ( zclOTA_ElementPos + run ) > Z_EXTADDR_LEN )
+          {
+            hashLen = (uint8_t)( Z_EXTADDR_LEN - zclOTA_ElementPos );
           }
-        }
-        else if ( zclOTA_ElementTag == OTA_ECDSA_CERT_TAG_ID )
-        {
-          zclOTA_Certificate[zclOTA_ElementPos] = pData[i];
         }
 #endif
 
-        if(zclOTA_ElementTag == OTA_UPGRADE_IMAGE_TAG_ID)
+        status = zclOTA_ProcessElementData ( &pData[i], run );
+        if ( status != ZSuccess )
         {
-            // Get the header from the OTA frame
-
-            switch (oadPdState)
-            {
-                case OAD_GET_IMAGE_HDR_STATE:
-                {
-                    uint8_t oad_imageID[] = OAD_IMG_ID_VAL;
-                    uint8_t oad_externalFLashID[] = OAD_EXTFL_ID_VAL;
-
-                    if(oad_imgHdr_pos < sizeof(oad_imgHdr))
-                    {
-                        ((uint8_t*)&oad_imgHdr)[oad_imgHdr_pos] = pData[i];
-                        oad_imgHdr_pos++;
-
-                        //Keep track of OTA element bytes received
-                        zclOTA_ElementPos++;
-                        break;
-                    }
-
-                    //Header complete, validate the image header
-                    //BIM version must be compatible, OTA image received must be Zigbee (for this release), OTA image received must be App+StackLib
-                    if( (memcmp(oad_imgHdr.fixedHdr.imgID, oad_imageID, 8) != 0)     ||
-                           (oad_imgHdr.fixedHdr.bimVer != BIM_VER )                    ||
-                           (oad_imgHdr.fixedHdr.techType != OAD_WIRELESS_TECH_ZIGBEE ) ||
-                           (oad_imgHdr.fixedHdr.imgType != OAD_IMG_TYPE_APPSTACKLIB  )  )
-                    {
-                       //Initialize OAD state
-                       oadPdState = OAD_GET_IMAGE_HDR_STATE;
-                       oad_imgHdr_pos = 0;
-
-                       memset(&oad_imgHdr,0,sizeof(oad_imgHdr));
-
-                       return ZCL_STATUS_INVALID_IMAGE;
-                    }
-
-                    /* Zigbee OAD assumptions:
-                     * Factory New Metadata and binary image exist in external flash.
-                     * Zigbee OAD will always take the next slot available after FN header and binary
-                     */
-
-                    if(flash_open() != 0)
-                    {
-                        //Search for a metadata header to fit the Zigbee image
-                        ExtImageInfo_t oad_imgHdrFactoryNew;
-
-                        //OAD binary pages required to store the binary
-                        uint8_t   binaryPagesLen   = 0;
-
-                        // Read the factory new metadata page
-                        readFlash(EFL_ADDR_META_FACT_IMG, (uint8_t *)&oad_imgHdrFactoryNew, EFL_METADATA_LEN);
-
-                        //is a valid header
-                        if(memcmp(&oad_imgHdrFactoryNew.fixedHdr.imgID, oad_externalFLashID, sizeof(oad_externalFLashID)) != 0)
-                        {
-                            flash_close();
-                            //This release does not support not having the Factory New image
-                            return ZCL_STATUS_ABORT;
-                        }
-
-                        /* FROM BLE STACK:
-                           Note currently we have problem in erasing last flash page,
-                           workaround to leave last page */
-                        //Where Factory New image is stored
-                        binaryAddrOffset = EFL_FLASH_SIZE - EFL_PAGE_SIZE;
-
-                        //Offset the Factory New image size (as binaries are store from top to bottom of the external flash, by append we mean substract the address)
-                        binaryAddrOffset -= EXT_FLASH_ADDRESS(EXT_FLASH_PAGE(oad_imgHdrFactoryNew.fixedHdr.len) + 1 , 0);
-
-                        //Offset the Zigbee image size (as binaries are store from top to bottom of the external flash, by append we mean substract the address)
-                        binaryAddrOffset -= EXT_FLASH_ADDRESS(EXT_FLASH_PAGE(oad_imgHdr.fixedHdr.len) + 1 , 0);
-                        //Address at which the Zigbee binary starts
-                        binaryAddrStart = binaryAddrOffset;
-
-                        binaryPagesLen = EXT_FLASH_PAGE(oad_imgHdr.fixedHdr.len) + 1;
-
-                        //Erase the image space for the incoming binary
-                        if(oadEraseExtFlashPages(EXT_FLASH_PAGE(binaryAddrOffset) , binaryPagesLen))
-                        {
-                            flash_close();
-                            //Something went wrong...
-                            return ZCL_STATUS_ABORT;
-                        }
-
-                        //Erase the header file after the Factory New metadata header
-                        if(eraseFlashPg(EXT_FLASH_PAGE((EFL_ADDR_META_FACT_IMG + EFL_PAGE_SIZE)) != FLASH_SUCCESS))
-                        {
-                            flash_close();
-                            //Something went wrong...
-                            return ZCL_STATUS_ABORT;
-                        }
-
-                        //We have the Zigbee OAD header, so lets write it.
-                        //Populate the right metadata header for the table
-
-                            ExtImageInfo_t  ExtImageInfo;
-
-                            OsalPort_memcpy(&ExtImageInfo.fixedHdr,&oad_imgHdr.fixedHdr,OAD_IMG_HDR_LEN);
-
-                            OsalPort_memcpy(&ExtImageInfo.fixedHdr.imgID, oad_externalFLashID,sizeof(oad_externalFLashID));
-
-                            ExtImageInfo.extFlAddr = binaryAddrStart;
-                            ExtImageInfo.counter = 0;
-
-                            if(writeFlashPg(EXT_FLASH_PAGE((EFL_ADDR_META + EFL_PAGE_SIZE)),0, (uint8_t *)&ExtImageInfo, sizeof(ExtImageInfo_t)) != FLASH_SUCCESS)
-                            {
-                                flash_close();
-                                //Something went wrong...
-                                return ZCL_STATUS_ABORT;
-                            }
-
-                        //Also write the OAD header into the external flash binary section
-                        if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), 0,  (uint8_t *)&oad_imgHdr, sizeof (imgHdr_t)) != FLASH_SUCCESS)
-                        {
-                            flash_close();
-                            //Something went wrong...
-                            return ZCL_STATUS_ABORT;
-                        }
-
-                        binaryAddrOffset += sizeof (imgHdr_t);
-
-                        //add the remaining payload image into the image section
-                        if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i], len - i ) != FLASH_SUCCESS)
-                        {
-                            flash_close();
-                            //Something went wrong...
-                            return ZCL_STATUS_ABORT;
-                        }
-
-                        //Update the address offset in external flash
-                        binaryAddrOffset += len - i;
-
-                        //Keep track of OTA element bytes received
-                        zclOTA_ElementPos += len - i;
-
-                        *zclOTA_FileOffset += len - i - 1;  //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
-
-                        //Had copied the whole packet already, so skip this frame.
-                        i = len;
-
-                        oadPdState = OAD_GET_IMAGE_PAYLOAD_STATE;
-                    }
-                    else
-                    {
-                        //Could not open the external flash
-                        return ZCL_STATUS_ABORT;
-                    }
-
-                }
-                break;
-
-                case OAD_GET_IMAGE_PAYLOAD_STATE:
-
-                    //Keep track of OTA element bytes received
-                    zclOTA_ElementPos += len;
-
-                    if(flash_open() != 0)
-                    {
-                        //If for some reason the OTA Upgrade file is larger than what OAD header indicates, only copy what OAD header indicates
-                        if(binaryAddrOffset + len < binaryAddrStart + oad_imgHdr.fixedHdr.len)
-                        {
-                            //add the image payload into the image section
-                            if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i], len ) != FLASH_SUCCESS)
-                            {
-                                flash_close();
-                                //Something went wrong...
-                                return ZCL_STATUS_ABORT;
-                            }
-                            binaryAddrOffset += len;
-                            *zclOTA_FileOffset += len - 1; //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
-                        }
-                        else
-                        {
-                            //Calculate the remaining bytes to be copied
-                            uint32_t remaining;
-                            remaining = oad_imgHdr.fixedHdr.len - (binaryAddrOffset - binaryAddrStart);
-
-                            //add the image payload into the image section
-                            if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i],  remaining ) != FLASH_SUCCESS)
-                            {
-                                flash_close();
-                                //Something went wrong...
-                                return ZCL_STATUS_ABORT;
-                            }
-                            binaryAddrOffset += remaining;
-                            *zclOTA_FileOffset += remaining - 1; //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
-
-                            //check the binary copied CRC
-                            if(oadCheckDL(EXT_FLASH_PAGE(binaryAddrStart)) == ZSuccess)
-                            {
-                                oadPdState = OAD_IMAGE_COMPLETED_STATE;
-                            }
-                            else
-                            {
-                                flash_close();
-                                return ZCL_STATUS_ABORT;
-                            }
-                        }
-                    }
-
-                    //As we copy the whole buffer, force the index to be the last byte
-                    i = len;
-
-                break;
-            }
+          return status;
         }
 
+        zclOTA_ElementPos += run;
 
-
+        // Parse the next element header
+        if ( zclOTA_ElementPos >= zclOTA_ElementLen )
+        {
+          zclOTA_ClientPdState = ZCL_OTA_PD_ELEM_TAG1_STATE;
+        }
         break;
 
       default:
@@ -1140,22 +964,12 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
     }
 
 #if defined OTA_MMO_SIGN
-    if ( !skipHash )
-    {
-      // Maintain a buffer of data to hash
-      zclOTA_DataToHash[zclOTA_HashPos++] = pData[i];
-
-      // When the buffer reaches OTA_MMO_HASH_SIZE, update the Hash
-      if ( zclOTA_HashPos == OTA_MMO_HASH_SIZE )
-      {
-        OTA_CalculateMmoR3 ( &zclOTA_MmoHash, zclOTA_DataToHash, OTA_MMO_HASH_SIZE, FALSE );
-        zclOTA_HashPos = 0;
-      }
-    }
+    zclOTA_HashData ( &pData[i], hashLen );
 #endif
 
     // Check if the download is complete
-    if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
+    *zclOTA_FileOffset += run;
+    if ( *zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
     {
       *zclOTA_ImageUpgradeStatus = OTA_STATUS_COMPLETE;
 
@@ -1177,6 +991,316 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
   return ZSuccess;
 }
 
+/*********************************************************************
+ * @fn      zclOTA_ProcessElementData
+ *
+ * @brief   Process a run of data that belongs to the current element.
+ *
+ * @param   pData - pointer to the data
+ * @param   len - length of the data, up to the end of the element
+ *
+ * @return  status of the operation
+ */
+static uint8_t zclOTA_ProcessElementData ( uint8_t *pData, uint8_t len )
+{
+  uint8_t status;
+  uint8_t n;
+
+#if defined OTA_MMO_SIGN
+  if ( zclOTA_ElementTag == OTA_ECDSA_SIGNATURE_TAG_ID )
+  {
+    if ( zclOTA_ElementPos < Z_EXTADDR_LEN )
+    {
+      n = Z_EXTADDR_LEN - (uint8_t)zclOTA_ElementPos;
+      if ( n > len )
+      {
+        n = len;
+      }
+
+      OsalPort_memcpy ( &zclOTA_SignerIEEE[zclOTA_ElementPos], pData, n );
+      OsalPort_memcpy ( zclOTA_SignatureData, pData + n, len - n );
+    }
+    else
+    {
+      OsalPort_memcpy ( &zclOTA_SignatureData[zclOTA_ElementPos - Z_EXTADDR_LEN], pData, len );
+    }
+  }
+  else if ( zclOTA_ElementTag == OTA_ECDSA_CERT_TAG_ID )
+  {
+    OsalPort_memcpy ( &zclOTA_Certificate[zclOTA_ElementPos], pData, len );
+  }
+#endif
+
+  if ( zclOTA_ElementTag == OTA_UPGRADE_IMAGE_TAG_ID )
+  {
+    if ( oadPdState == OAD_GET_IMAGE_HDR_STATE )
+    {
+      // Get the header from the OTA frame
+      n = sizeof ( oad_imgHdr ) - oad_imgHdr_pos;
+      if ( n > len )
+      {
+        n = len;
+      }
+
+      OsalPort_memcpy ( ( (uint8_t *)&oad_imgHdr ) + oad_imgHdr_pos, pData, n );
+      oad_imgHdr_pos += n;
+      pData += n;
+      len -= n;
+
+      if ( oad_imgHdr_pos < sizeof ( oad_imgHdr ) )
+      {
+        return ZSuccess;
+      }
+
+      status = oadStartImage();
+      if ( status != ZSuccess )
+      {
+        return status;
+      }
+    }
+
+    if ( ( oadPdState == OAD_GET_IMAGE_PAYLOAD_STATE ) && ( len != 0 ) )
+    {
+      return oadWriteImage ( pData, len );
+    }
+  }
+
+  return ZSuccess;
+}
+
+#if defined OTA_MMO_SIGN
+/*********************************************************************
+ * @fn      zclOTA_HashData
+ *
+ * @brief   Add data to the image hash. Whole blocks are hashed straight
+ *          from the data, only a partial block is buffered.
+ *
+ * @param   pData - pointer to the data
+ * @param   len - length of the data
+ *
+ * @return  none
+ */
+static void zclOTA_HashData ( uint8_t *pData, uint8_t len )
+{
+  uint8_t n;
+
+  // Complete the buffered block first
+  if ( zclOTA_HashPos != 0 )
+  {
+    n = OTA_MMO_HASH_SIZE - zclOTA_HashPos;
+    if ( n > len )
+    {
+      n = len;
+    }
+
+    OsalPort_memcpy ( &zclOTA_DataToHash[zclOTA_HashPos], pData, n );
+    zclOTA_HashPos += n;
+    pData += n;
+    len -= n;
+
+    if ( zclOTA_HashPos < OTA_MMO_HASH_SIZE )
+    {
+      return;
+    }
+
+    OTA_CalculateMmoR3 ( &zclOTA_MmoHash, zclOTA_DataToHash, OTA_MMO_HASH_SIZE, FALSE );
+    zclOTA_HashPos = 0;
+  }
+
+  n = len - ( len % OTA_MMO_HASH_SIZE );
+  if ( n != 0 )
+  {
+    OTA_CalculateMmoR3 ( &zclOTA_MmoHash, pData, n, FALSE );
+    pData += n;
+    len -= n;
+  }
+
+  // Keep the rest for the next block
+  OsalPort_memcpy ( zclOTA_DataToHash, pData, len );
+  zclOTA_HashPos = len;
+}
+#endif // OTA_MMO_SIGN
+
+/*********************************************************************
+ * @fn      oadStartImage
+ *
+ * @brief   Validate the OAD image header and prepare the external flash
+ *          for the binary that follows it.
+ *
+ * @param   none
+ *
+ * @return  ZSuccess, ZCL_STATUS_INVALID_IMAGE or ZCL_STATUS_ABORT
+ */
+static uint8_t oadStartImage(void)
+{
+    uint8_t oad_imageID[] = OAD_IMG_ID_VAL;
+    uint8_t oad_externalFLashID[] = OAD_EXTFL_ID_VAL;
+
+    //Header complete, validate the image header
+    //BIM version must be compatible, OTA image received must be Zigbee (for this release), OTA image received must be App+StackLib
+    if( (memcmp(oad_imgHdr.fixedHdr.imgID, oad_imageID, 8) != 0)     ||
+           (oad_imgHdr.fixedHdr.bimVer != BIM_VER )                    ||
+           (oad_imgHdr.fixedHdr.techType != OAD_WIRELESS_TECH_ZIGBEE ) ||
+           (oad_imgHdr.fixedHdr.imgType != OAD_IMG_TYPE_APPSTACKLIB  )  )
+    {
+       //Initialize OAD state
+       oadPdState = OAD_GET_IMAGE_HDR_STATE;
+       oad_imgHdr_pos = 0;
+
+       memset(&oad_imgHdr,0,sizeof(oad_imgHdr));
+
+       return ZCL_STATUS_INVALID_IMAGE;
+    }
+
+    /* Zigbee OAD assumptions:
+     * Factory New Metadata and binary image exist in external flash.
+     * Zigbee OAD will always take the next slot available after FN header and binary
+     */
+
+    if(flash_open() != 0)
+    {
+        //Search for a metadata header to fit the Zigbee image
+        ExtImageInfo_t oad_imgHdrFactoryNew;
+
+        //OAD binary pages required to store the binary
+        uint8_t   binaryPagesLen   = 0;
+
+        // Read the factory new metadata page
+        readFlash(EFL_ADDR_META_FACT_IMG, (uint8_t *)&oad_imgHdrFactoryNew, EFL_METADATA_LEN);
+
+        //is a valid header
+        if(memcmp(&oad_imgHdrFactoryNew.fixedHdr.imgID, oad_externalFLashID, sizeof(oad_externalFLashID)) != 0)
+        {
+            flash_close();
+            //This release does not support not having the Factory New image
+            return ZCL_STATUS_ABORT;
+        }
+
+        /* FROM BLE STACK:
+           Note currently we have problem in erasing last flash page,
+           workaround to leave last page */
+        //Where Factory New image is stored
+        binaryAddrOffset = EFL_FLASH_SIZE - EFL_PAGE_SIZE;
+
+        //Offset the Factory New image size (as binaries are store from top to bottom of the external flash, by append we mean substract the address)
+        binaryAddrOffset -= EXT_FLASH_ADDRESS(EXT_FLASH_PAGE(oad_imgHdrFactoryNew.fixedHdr.len) + 1 , 0);
+
+        //Offset the Zigbee image size (as binaries are store from top to bottom of the external flash, by append we mean substract the address)
+        binaryAddrOffset -= EXT_FLASH_ADDRESS(EXT_FLASH_PAGE(oad_imgHdr.fixedHdr.len) + 1 , 0);
+        //Address at which the Zigbee binary starts
+        binaryAddrStart = binaryAddrOffset;
+
+        binaryPagesLen = EXT_FLASH_PAGE(oad_imgHdr.fixedHdr.len) + 1;
+
+        //Erase the image space for the incoming binary
+        if(oadEraseExtFlashPages(EXT_FLASH_PAGE(binaryAddrOffset) , binaryPagesLen))
+        {
+            flash_close();
+            //Something went wrong...
+            return ZCL_STATUS_ABORT;
+        }
+
+        //Erase the header file after the Factory New metadata header
+        if(eraseFlashPg(EXT_FLASH_PAGE((EFL_ADDR_META_FACT_IMG + EFL_PAGE_SIZE)) != FLASH_SUCCESS))
+        {
+            flash_close();
+            //Something went wrong...
+            return ZCL_STATUS_ABORT;
+        }
+
+        //We have the Zigbee OAD header, so lets write it.
+        //Populate the right metadata header for the table
+
+            ExtImageInfo_t  ExtImageInfo;
+
+            OsalPort_memcpy(&ExtImageInfo.fixedHdr,&oad_imgHdr.fixedHdr,OAD_IMG_HDR_LEN);
+
+            OsalPort_memcpy(&ExtImageInfo.fixedHdr.imgID, oad_externalFLashID,sizeof(oad_externalFLashID));
+
+            ExtImageInfo.extFlAddr = binaryAddrStart;
+            ExtImageInfo.counter = 0;
+
+            if(writeFlashPg(EXT_FLASH_PAGE((EFL_ADDR_META + EFL_PAGE_SIZE)),0, (uint8_t *)&ExtImageInfo, sizeof(ExtImageInfo_t)) != FLASH_SUCCESS)
+            {
+                flash_close();
+                //Something went wrong...
+                return ZCL_STATUS_ABORT;
+            }
+
+        //Also write the OAD header into the external flash binary section
+        if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), 0,  (uint8_t *)&oad_imgHdr, sizeof (imgHdr_t)) != FLASH_SUCCESS)
+        {
+            flash_close();
+            //Something went wrong...
+            return ZCL_STATUS_ABORT;
+        }
+
+        binaryAddrOffset += sizeof (imgHdr_t);
+
+        oadPdState = OAD_GET_IMAGE_PAYLOAD_STATE;
+    }
+    else
+    {
+        //Could not open the external flash
+        return ZCL_STATUS_ABORT;
+    }
+
+    return ZSuccess;
+}
+
+/*********************************************************************
+ * @fn      oadWriteImage
+ *
+ * @brief   Write a run of the OAD binary to the external flash with a
+ *          single write, and check the image once it is complete.
+ *
+ * @param   pData - pointer to the data
+ * @param   len - length of the data
+ *
+ * @return  ZSuccess or ZCL_STATUS_ABORT
+ */
+static uint8_t oadWriteImage(uint8_t *pData, uint8_t len)
+{
+    uint32_t remaining;
+
+    if(flash_open() == 0)
+    {
+        return ZSuccess;
+    }
+
+    //If for some reason the OTA Upgrade file is larger than what OAD header indicates, only copy what OAD header indicates
+    remaining = oad_imgHdr.fixedHdr.len - (binaryAddrOffset - binaryAddrStart);
+    if(len < remaining)
+    {
+        remaining = len;
+    }
+
+    //add the image payload into the image section
+    if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), pData, remaining) != FLASH_SUCCESS)
+    {
+        flash_close();
+        //Something went wrong...
+        return ZCL_STATUS_ABORT;
+    }
+    binaryAddrOffset += remaining;
+
+    if(binaryAddrOffset >= binaryAddrStart + oad_imgHdr.fixedHdr.len)
+    {
+        //check the binary copied CRC
+        if(oadCheckDL(EXT_FLASH_PAGE(binaryAddrStart)) == ZSuccess)
+        {
+            oadPdState = OAD_IMAGE_COMPLETED_STATE;
+        }
+        else
+        {
+            flash_close();
+            return ZCL_STATUS_ABORT;
+        }
+    }
+
+    return ZSuccess;
+}
+
 /*********************************************************************
  * @fn      oadEraseExtFlashPages
  *
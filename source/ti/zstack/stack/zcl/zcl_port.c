@@ -98,6 +98,15 @@ typedef struct zclGenSceneNVItem
     uint8_t endpoint;
     zclGeneral_Scene_t scene;
 }zclGenSceneNVItem_t;
+
+// RAM index of the scene NV table, one entry per NV slot
+typedef struct
+{
+    bool inUse;         // false if the slot is unused, any endpoint may be stored
+    uint8_t endpoint;
+    uint8_t sceneID;
+    uint16_t groupID;
+} zclPortSceneIdx_t;
 #endif
 
 typedef struct
@@ -149,6 +158,10 @@ static zstack_sysNwkInfoReadRsp_t nwkInfo =
 
 #if defined (ZCL_SCENES)
 static uint8_t lastFindSceneEndpoint = 0xFF;
+
+// Mirror of the (endpoint, groupID, sceneID) keys stored in each NV slot
+static zclPortSceneIdx_t sceneIdx[ZCL_GENERAL_MAX_SCENES];
+static bool sceneIdxLoaded = false;
 #endif
 
 // Function pointer for applications to ZCL Handle External
@@ -160,6 +173,12 @@ static zclHandleExternalList_t *zclHandleExternalList = NULL;
 static void convertTxOptions(zstack_TransOptions_t *pOptions, uint8_t options);
 endPointDesc_t *zcl_afFindEndPointDesc(uint8_t EndPoint);
 uint8_t zclPortFindEntity(uint8_t EndPoint);
+#if defined (ZCL_SCENES)
+static void sceneIdxLoad(void);
+static uint16_t sceneIdxFind(uint8_t endpoint, uint16_t groupID,
+                             uint8_t sceneID);
+static void sceneIdxSet(uint16_t slot, zclGenSceneNVItem_t *pNvItem);
+#endif
 /*********************************************************************
 * PUBLIC FUNCTIONS
 *********************************************************************/
@@ -226,6 +245,9 @@ void zclport_registerNV(NVINTF_nvFuncts_t *pfnNV, uint16_t sceneNVID)
     pfnZclPortNV = pfnNV;
 #if defined (ZCL_SCENES)
     zclSceneNVID = sceneNVID;
+
+    // Different NV driver or item ID, reload the index on next use
+    sceneIdxLoaded = false;
 #endif
 }
 
@@ -1099,6 +1121,94 @@ static bool sceneRecEmpty(zclGenSceneNVItem_t *pNvItem)
     return(true);
 }
 
+/*********************************************************************
+ * @fn      sceneIdxSet
+ *
+ * @brief   Update the RAM index entry of a scene NV slot
+ *
+ * @param   slot - NV slot (sub ID) of the scene record
+ * @param   pNvItem - record now stored in the slot, NULL if it is empty
+ */
+static void sceneIdxSet(uint16_t slot, zclGenSceneNVItem_t *pNvItem)
+{
+    if( (pNvItem == NULL) || sceneRecEmpty(pNvItem) )
+    {
+        sceneIdx[slot].inUse = false;
+        sceneIdx[slot].endpoint = 0xFF;
+        sceneIdx[slot].groupID = 0xFFFF;
+        sceneIdx[slot].sceneID = 0xFF;
+    }
+    else
+    {
+        sceneIdx[slot].inUse = true;
+        sceneIdx[slot].endpoint = pNvItem->endpoint;
+        sceneIdx[slot].groupID = pNvItem->scene.groupID;
+        sceneIdx[slot].sceneID = pNvItem->scene.ID;
+    }
+}
+
+/*********************************************************************
+ * @fn      sceneIdxLoad
+ *
+ * @brief   Build the RAM index by reading every scene NV slot once.
+ *          Slots that can't be read are indexed as empty.
+ */
+static void sceneIdxLoad(void)
+{
+    uint16_t x;
+    zclGenSceneNVItem_t nvItem;
+
+    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    {
+        if(zclport_readNV(zclSceneNVID, x, 0,
+                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        {
+            sceneIdxSet(x, &nvItem);
+        }
+        else
+        {
+            sceneIdxSet(x, NULL);
+        }
+    }
+
+    sceneIdxLoaded = true;
+}
+
+/*********************************************************************
+ * @fn      sceneIdxFind
+ *
+ * @brief   Find the NV slot holding a scene
+ *
+ * @param   endpoint - endpoint to filter with, 0xFF for any endpoint
+ * @param   groupID - group ID looking for
+ * @param   sceneID - scene ID
+ *
+ * @return  NV slot, ZCL_GENERAL_MAX_SCENES if not found
+ */
+static uint16_t sceneIdxFind(uint8_t endpoint, uint16_t groupID,
+                             uint8_t sceneID)
+{
+    uint16_t x;
+
+    if(sceneIdxLoaded == false)
+    {
+        sceneIdxLoad();
+    }
+
+    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    {
+        if( sceneIdx[x].inUse
+            && ( (sceneIdx[x].endpoint == endpoint) || (endpoint == 0xFF) )
+            && (sceneIdx[x].groupID == groupID)
+            && (sceneIdx[x].sceneID == sceneID) )
+        {
+            break;
+        }
+    }
+
+    return(x);
+}
+
 /*********************************************************************
  * @fn      zclGeneral_ScenesInit
  *
@@ -1115,6 +1225,9 @@ void zclGeneral_ScenesInit(void)
         zclport_initializeNVItem(zclSceneNVID, x,
                                  sizeof(zclGenSceneNVItem_t), &temp);
     }
+
+    // Load the scene keys once, lookups after this don't touch NV
+    sceneIdxLoad();
 }
 
 /*********************************************************************
@@ -1130,19 +1243,24 @@ void zclGeneral_RemoveAllScenes(uint8_t endpoint, uint16_t groupID)
     uint16_t x;
     zclGenSceneNVItem_t nvItem;
 
+    if(sceneIdxLoaded == false)
+    {
+        sceneIdxLoad();
+    }
+
+    // Remove the item by setting it all to 0xFF
+    memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
+
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if( sceneIdx[x].inUse
+            && ( (sceneIdx[x].endpoint == endpoint) || (endpoint == 0xFF) )
+            && (sceneIdx[x].groupID == groupID) )
         {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                && (nvItem.scene.groupID == groupID) )
+            if(zclport_writeNV(zclSceneNVID, x,
+                               sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
             {
-                // Remove the item by setting it all to 0xFF
-                memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
-                zclport_writeNV(zclSceneNVID, x,
-                                sizeof(zclGenSceneNVItem_t), &nvItem);
+                sceneIdxSet(x, NULL);
             }
         }
     }
@@ -1164,32 +1282,24 @@ uint8_t zclGeneral_RemoveScene(uint8_t endpoint, uint16_t groupID, uint8_t scene
     uint16_t x;
     zclGenSceneNVItem_t nvItem;
 
-    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    x = sceneIdxFind(endpoint, groupID, sceneID);
+    if(x == ZCL_GENERAL_MAX_SCENES)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
-        {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                && (nvItem.scene.groupID == groupID)
-                && (nvItem.scene.ID == sceneID) )
-            {
-                // Remove the item by setting it all to 0xFF
-                memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
-                if(zclport_writeNV(zclSceneNVID, x,
-                                   sizeof(zclGenSceneNVItem_t),
-                                   &nvItem) == SUCCESS)
-                {
-                    return(TRUE);
-                }
-                else
-                {
-                    return(FALSE);
-                }
-            }
-        }
+        return(FALSE);
+    }
+
+    // Remove the item by setting it all to 0xFF
+    memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
+    if(zclport_writeNV(zclSceneNVID, x,
+                       sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+    {
+        sceneIdxSet(x, NULL);
+        return(TRUE);
+    }
+    else
+    {
+        return(FALSE);
     }
-    return(FALSE);
 }
 
 /*********************************************************************
@@ -1212,26 +1322,21 @@ zclGeneral_Scene_t *zclGeneral_FindScene(uint8_t endpoint, uint16_t groupID,
 
     if(pEPDesc != NULL)
     {
-        for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+        x = sceneIdxFind(endpoint, groupID, sceneID);
+
+        // Only the matching slot is read from NV
+        if( (x < ZCL_GENERAL_MAX_SCENES)
+            && (zclport_readNV(zclSceneNVID, x, 0,
+                               sizeof(zclGenSceneNVItem_t),
+                               &nvItem) == SUCCESS) )
         {
-            if(zclport_readNV(zclSceneNVID, x, 0,
-                              sizeof(zclGenSceneNVItem_t),
-                              &nvItem) == SUCCESS)
-            {
-                if( (sceneRecEmpty(&nvItem) == false)
-                    && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                    && (nvItem.scene.groupID == groupID)
-                    && (nvItem.scene.ID == sceneID) )
-                {
-                    lastFindSceneEndpoint = endpoint;
-
-                    // Copy to a temp area
-                    OsalPort_memcpy( &(pEPDesc->scene), &(nvItem.scene),
-                            sizeof(zclGeneral_Scene_t) );
-
-                    return( &(pEPDesc->scene) );
-                }
-            }
+            lastFindSceneEndpoint = endpoint;
+
+            // Copy to a temp area
+            OsalPort_memcpy( &(pEPDesc->scene), &(nvItem.scene),
+                    sizeof(zclGeneral_Scene_t) );
+
+            return( &(pEPDesc->scene) );
         }
     }
 
@@ -1253,19 +1358,21 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     uint16_t x;
     zclGenSceneNVItem_t nvItem;
 
-    // See if the item exists already
+    if(sceneIdxLoaded == false)
+    {
+        sceneIdxLoad();
+    }
+
+    // See if the item exists already, the endpoint must match exactly
+    // (0xFF is not a wildcard here)
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if( sceneIdx[x].inUse
+            && (sceneIdx[x].endpoint == endpoint)
+            && (sceneIdx[x].groupID == scene->groupID)
+            && (sceneIdx[x].sceneID == scene->ID) )
         {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && (nvItem.endpoint == endpoint)
-                && (nvItem.scene.groupID == scene->groupID)
-                && (nvItem.scene.ID == scene->ID) )
-            {
-                break;
-            }
+            break;
         }
     }
 
@@ -1274,14 +1381,9 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     {
         for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
         {
-            if(zclport_readNV(zclSceneNVID, x, 0,
-                              sizeof(zclGenSceneNVItem_t),
-                              &nvItem) == SUCCESS)
+            if(sceneIdx[x].inUse == false)
             {
-                if( sceneRecEmpty(&nvItem) )
-                {
-                    break;
-                }
+                break;
             }
         }
     }
@@ -1298,6 +1400,7 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     if(zclport_writeNV(zclSceneNVID, x,
                        sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
     {
+        sceneIdxSet(x, &nvItem);
         return(ZSuccess);
     }
     else
@@ -1316,18 +1419,18 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
 uint8_t zclGeneral_CountAllScenes(void)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
     uint8_t cnt = 0;
 
+    if(sceneIdxLoaded == false)
+    {
+        sceneIdxLoad();
+    }
+
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if(sceneIdx[x].inUse)
         {
-            if(sceneRecEmpty(&nvItem) == false)
-            {
-                cnt++;
-            }
+            cnt++;
         }
     }
 
@@ -1348,20 +1451,20 @@ uint8_t zclGeneral_FindAllScenesForGroup(uint8_t endpoint, uint16_t groupID,
                                        uint8_t *sceneList)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
     uint8_t cnt = 0;
 
+    if(sceneIdxLoaded == false)
+    {
+        sceneIdxLoad();
+    }
+
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if( sceneIdx[x].inUse
+            && (sceneIdx[x].endpoint == endpoint) &&
+            (sceneIdx[x].groupID == groupID) )
         {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && (nvItem.endpoint == endpoint) &&
-                (nvItem.scene.groupID == groupID) )
-            {
-                sceneList[cnt++] = nvItem.scene.ID;
-            }
+            sceneList[cnt++] = sceneIdx[x].sceneID;
         }
     }
     return(cnt);
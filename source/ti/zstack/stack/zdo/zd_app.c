@@ -480,6 +480,15 @@ uint32_t ZDApp_event_loop( uint8_t task_id, uint32_t events )
     return (events ^ ZDO_NWK_UPDATE_NV);
   }
 
+  if ( events & ZDO_BIND_UPDATE_NV )
+  {
+    // Write the binding records changed since the last write
+    BindWriteNV();
+
+    // Return unprocessed events
+    return (events ^ ZDO_BIND_UPDATE_NV);
+  }
+
   if ( events & ZDO_DEVICE_RESET )
   {
 #ifdef ZBA_FALLBACK_NWKKEY
@@ -972,6 +981,9 @@ void ZDApp_SaveNetworkStateEvt( void )
   ZMacSetReq( ZMacRxOnIdle, &x );
  #endif
 
+  // Commit the whole network state to Flash together
+  osal_nv_write_begin();
+
   // Update the Network State in NV
   NLME_UpdateNV( NWK_NV_NIB_ENABLE        |
                  NWK_NV_DEVICELIST_ENABLE |
@@ -982,6 +994,8 @@ void ZDApp_SaveNetworkStateEvt( void )
   // clearing the "New" join option.
   zgWriteStartupOptions( FALSE, ZCD_STARTOPT_DEFAULT_NETWORK_STATE );
 
+  osal_nv_write_commit();
+
  #if defined ( NV_TURN_OFF_RADIO )
   ZMacSetReq( ZMacRxOnIdle, &RxOnIdle );
  #endif
@@ -1641,6 +1655,9 @@ void ZDApp_SaveNwkKey( void )
 
   SSP_ReadNwkActiveKey( &keyItems );
 
+  // Commit the key and its frame counter to Flash together
+  osal_nv_write_begin();
+
   osal_nv_write( ZCD_NV_NWKKEY, sizeof( nwkActiveKeyItems ),
                 (void *)&keyItems );
 
@@ -1675,6 +1692,8 @@ void ZDApp_SaveNwkKey( void )
                      &nwkSecMaterialDesc);
   }
 
+  osal_nv_write_commit();
+
   nwkFrameCounterChanges = 0;
 
   // Clear copy in RAM before return.
@@ -2140,7 +2159,7 @@ void ZDApp_LeaveUpdate( uint16_t nwkAddr, uint8_t* extAddr,
         uint8_t found;
         APSME_GetRequest( apsTrustCenterAddress,0, TC_ExtAddr );
 
-        APSME_SearchTCLinkKeyEntry(extAddr,&found,NULL);
+        ZDSecMgrTCLinkKeySearch(extAddr,&found,NULL);
 
         // For ZG_GLOBAL_LINK_KEY the message has to be sent twice one
         // un-encrypted and one APS encrypted, to make sure that it can interoperate
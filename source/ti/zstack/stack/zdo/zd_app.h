@@ -84,6 +84,7 @@ extern "C"
 #if defined ( ZDP_BIND_VALIDATION )
 #define ZDO_PENDING_BIND_REQ_EVT      0x1000
 #endif
+#define ZDO_BIND_UPDATE_NV        0x2000
 #define ZDO_PARENT_ANNCE_EVT      0x4000
 
 // Incoming to ZDO
@@ -160,6 +160,12 @@ APSME_TCLinkKeyNVEntry_t TrustCenterLinkKey;
 APSME_ApsLinkKeyRAMEntry_t ApsLinkKeyRAMEntry[ZDSECMGR_ENTRY_MAX];
 APSME_TCLinkKeyRAMEntry_t TCLinkKeyRAMEntry[ZDSECMGR_TC_DEVICE_MAX];
 
+// RAM index of the TCLK NV table: one extended address hash per slot so a
+// lookup costs a single NV read instead of a scan of the whole table.
+#define ZDSECMGR_TCLK_IDX_EMPTY  0x0000
+static uint16_t TCLinkKeyIdx[ZDSECMGR_TC_DEVICE_MAX];
+static uint8_t  TCLinkKeyIdxValid = FALSE;
+
 CONST uint16_t gZDSECMGR_ENTRY_MAX = ZDSECMGR_ENTRY_MAX;
 CONST uint16_t gZDSECMGR_TC_DEVICE_MAX = ZDSECMGR_TC_DEVICE_MAX;
 CONST uint16_t gZDSECMGR_TC_DEVICE_IC_MAX = ZDSECMGR_TC_DEVICE_IC_MAX;
@@ -192,6 +198,8 @@ uint8_t  gZDSECMGR_TC_ATTEMPT_DEFAULT_KEY = ZDSECMGR_TC_ATTEMPT_DEFAULT_KEY;
  *   ZDSecMgrAuthNwkKey
  *   APSME_TCLinkKeyInit
  *   APSME_IsDefaultTCLK
+ *   ZDSecMgrTCLinkKeyIdxHash
+ *   ZDSecMgrTCLinkKeyIdxLoad
  */
 
 //-----------------------------------------------------------------------------
@@ -268,6 +276,8 @@ void APSME_TCLinkKeyInit( uint8_t setDefault );
 uint8_t APSME_IsDefaultTCLK( uint8_t *extAddr );
 void ZDSecMgrGenerateSeed(uint8_t setDefault );
 void ZDSecMgrGenerateKeyFromSeed(uint8_t *extAddr, uint8_t shift, uint8_t *key);
+static uint16_t ZDSecMgrTCLinkKeyIdxHash( uint8_t *extAddr );
+static void ZDSecMgrTCLinkKeyIdxLoad( void );
 /******************************************************************************
  * @fn          ZDSecMgrAddrStore
  *
@@ -849,7 +859,7 @@ void ZDSecMgrTclkReq( ZDO_RequestKeyInd_t* ind )
     req.key = key;
 
     //Search for the entry
-    APSME_SearchTCLinkKeyEntry(initExtAddr,&found, &TCLKDevEntry);
+    ZDSecMgrTCLinkKeySearch(initExtAddr,&found, &TCLKDevEntry);
 
     //If found, generate the key accordingly to the key attribute
     if(found)
@@ -1051,7 +1061,7 @@ void ZDSecMgrDeviceRemove( ZDSecMgrDevice_t* device )
 
     APSME_GetRequest( apsTrustCenterAddress,0, TC_ExtAddr );
 
-    APSME_SearchTCLinkKeyEntry(TC_ExtAddr,&found,NULL);
+    ZDSecMgrTCLinkKeySearch(TC_ExtAddr,&found,NULL);
 
     // For ZG_GLOBAL_LINK_KEY the message has to be sent twice, one
     // APS un-encrypted and one APS encrypted, to make sure that it can interoperate
@@ -1100,7 +1110,7 @@ ZStatus_t ZDSecMgrDeviceValidate( ZDSecMgrDevice_t* device )
     // check if joiner has install code, fixed by luoyiming 2019-12-24
     uint8_t  found = 0;
     APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
-    APSME_SearchTCLinkKeyEntry(device->extAddr, &found, &TCLKDevEntry);
+    ZDSecMgrTCLinkKeySearch(device->extAddr, &found, &TCLKDevEntry);
     if( !( found && (TCLKDevEntry.keyAttributes == ZG_PROVISIONAL_KEY) ) )
     {
       if( pZDSecMgrDeviceValidateCallback ) // Match valid join in application, fixed by luoyiming 2019-07-19
@@ -1162,7 +1172,7 @@ ZStatus_t ZDSecMgrDeviceJoin( ZDSecMgrDevice_t* device )
           {
             uint8_t found = 0;
             APSME_TCLinkKeyNVEntry_t TCLKDevEntry = {0};
-            APSME_SearchTCLinkKeyEntry(device->extAddr, &found, &TCLKDevEntry);
+            ZDSecMgrTCLinkKeySearch(device->extAddr, &found, &TCLKDevEntry);
 
             // if we found the device and its key is in the
             // ZG_VERIFIED_KEY state, that means we have established a
@@ -1250,7 +1260,7 @@ ZStatus_t ZDSecMgrDeviceJoinDirect( ZDSecMgrDevice_t* device )
     uint16_t keyNvIndex;
     APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
 
-    keyNvIndex = APSME_SearchTCLinkKeyEntry(device->extAddr,&found, &TCLKDevEntry);
+    keyNvIndex = ZDSecMgrTCLinkKeySearch(device->extAddr,&found, &TCLKDevEntry);
 
     //If not doing a TC rejoin...
     if(!(device->devStatus & DEV_SEC_AUTH_TC_REJOIN_STATUS))
@@ -1369,7 +1379,7 @@ ZStatus_t ZDSecMgrDeviceJoinFwd( ZDSecMgrDevice_t* device )
 
   APSME_GetRequest( apsTrustCenterAddress,0, TC_ExtAddr );
 
-  APSME_SearchTCLinkKeyEntry(TC_ExtAddr,&found,NULL);
+  ZDSecMgrTCLinkKeySearch(TC_ExtAddr,&found,NULL);
 
   // For ZG_GLOBAL_LINK_KEY the message has to be sent twice one
   // un-encrypted and one APS encrypted, to make sure that it can interoperate
@@ -1761,12 +1771,13 @@ void ZDSecMgrTransportKeyInd( ZDO_TransportKeyInd_t* ind )
         osal_nv_write_ex(ZCD_NV_EX_TCLK_TABLE, entryIndex,
                          sizeof(APSME_TCLinkKeyNVEntry_t),
                          &TCLKDevEntryCpy);
+        ZDSecMgrTCLinkKeyIdxSet(entryIndex, TCLKDevEntryCpy.extAddr);
     }
     else
     {
         // Find TCLK entry with TC extAddr or first unused entry
         uint8_t entryFound;
-        entryIndex = APSME_SearchTCLinkKeyEntry(AIB_apsTrustCenterAddress,&entryFound,&TCLKDevEntryCpy);
+        entryIndex = ZDSecMgrTCLinkKeySearch(AIB_apsTrustCenterAddress,&entryFound,&TCLKDevEntryCpy);
 
         if(entryIndex < gZDSECMGR_TC_DEVICE_MAX)
         {
@@ -1776,6 +1787,7 @@ void ZDSecMgrTransportKeyInd( ZDO_TransportKeyInd_t* ind )
           osal_nv_write_ex(ZCD_NV_EX_TCLK_TABLE, entryIndex,
                           sizeof(APSME_TCLinkKeyNVEntry_t),
                           &TCLKDevEntryCpy);
+          ZDSecMgrTCLinkKeyIdxSet(entryIndex, TCLKDevEntryCpy.extAddr);
         }
     }
 
@@ -1834,7 +1846,7 @@ void ZDSecMgrTransportKeyInd( ZDO_TransportKeyInd_t* ind )
     APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
 
     //Search the entry, which should exist at this point
-    entryIndex = APSME_SearchTCLinkKeyEntry(ind->srcExtAddr, &found, &TCLKDevEntry);
+    entryIndex = ZDSecMgrTCLinkKeySearch(ind->srcExtAddr, &found, &TCLKDevEntry);
 
     if(found)
     {
@@ -1946,7 +1958,7 @@ void ZDSecMgrUpdateDeviceInd( ZDO_UpdateDeviceInd_t* ind )
       uint16_t keyNvIndex, index;
       APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
 
-      keyNvIndex = APSME_SearchTCLinkKeyEntry(device.extAddr,&found, &TCLKDevEntry);
+      keyNvIndex = ZDSecMgrTCLinkKeySearch(device.extAddr,&found, &TCLKDevEntry);
 
       //If found and it was verified, then allow it to join in a fresh state by erasing the key entry
       if((found == TRUE) && (TCLKDevEntry.keyAttributes == ZG_VERIFIED_KEY))
@@ -1993,7 +2005,7 @@ void ZDSecMgrUpdateDeviceInd( ZDO_UpdateDeviceInd_t* ind )
       uint16_t keyNvIndex, index;
       APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
 
-      keyNvIndex = APSME_SearchTCLinkKeyEntry(device.extAddr,&found, &TCLKDevEntry);
+      keyNvIndex = ZDSecMgrTCLinkKeySearch(device.extAddr,&found, &TCLKDevEntry);
 
       //If found and it was verified, erase the key entry
       if((found == TRUE) && (TCLKDevEntry.keyAttributes == ZG_VERIFIED_KEY))
@@ -2010,6 +2022,7 @@ void ZDSecMgrUpdateDeviceInd( ZDO_UpdateDeviceInd_t* ind )
         osal_nv_write_ex(ZCD_NV_EX_TCLK_TABLE, keyNvIndex,
                          sizeof(APSME_TCLinkKeyNVEntry_t),
                          &TCLKDevEntry);
+        ZDSecMgrTCLinkKeyIdxSet(keyNvIndex, TCLKDevEntry.extAddr);
       }
 #endif
     // execute devie leave notify callback, add by luoyiming
@@ -3072,6 +3085,9 @@ void APSME_TCLinkKeyInit(uint8_t setDefault)
   memset( &TCLKDevEntry, 0x00, sizeof(APSME_TCLinkKeyNVEntry_t) );
   TCLKDevEntry.keyAttributes = ZG_DEFAULT_KEY;
 
+  // The index is rebuilt below while every slot is visited anyway
+  TCLinkKeyIdxValid = TRUE;
+
   // Initialize all NV items
   for( i = 0; i < gZDSECMGR_TC_DEVICE_MAX; i++ )
   {
@@ -3081,6 +3097,13 @@ void APSME_TCLinkKeyInit(uint8_t setDefault)
                                  sizeof(APSME_TCLinkKeyNVEntry_t),
                                  &TCLKDevEntry);
 
+    TCLinkKeyIdx[i] = ZDSECMGR_TCLK_IDX_EMPTY;
+
+    if ( (rtrn != SUCCESS) && (rtrn != NV_ITEM_UNINIT) )
+    {
+      TCLinkKeyIdxValid = FALSE;
+    }
+
     if (rtrn == SUCCESS)
     {
       if(setDefault)
@@ -3113,6 +3136,8 @@ void APSME_TCLinkKeyInit(uint8_t setDefault)
           TCLinkKeyRAMEntry[i].entryUsed = TRUE;
         }
 
+        TCLinkKeyIdx[i] = ZDSecMgrTCLinkKeyIdxHash( TCLKDevEntry.extAddr );
+
         osal_nv_write_ex( ZCD_NV_EX_TCLK_TABLE, i,
                           sizeof(APSME_TCLinkKeyNVEntry_t),
                           &TCLKDevEntry );
@@ -3131,6 +3156,200 @@ void APSME_TCLinkKeyInit(uint8_t setDefault)
   }
 }
 
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxHash
+ *
+ * @brief       Fold an extended address into its TCLK index value.
+ *
+ * @param       extAddr - [in] extended address
+ *
+ * @return      ZDSECMGR_TCLK_IDX_EMPTY for the all-zero address, else a
+ *              non-zero hash
+ */
+static uint16_t ZDSecMgrTCLinkKeyIdxHash( uint8_t *extAddr )
+{
+  uint16_t hash = 0;
+  uint8_t  i;
+
+  if ( OsalPort_isBufSet( extAddr, 0x00, Z_EXTADDR_LEN ) )
+  {
+    return ZDSECMGR_TCLK_IDX_EMPTY;
+  }
+
+  for ( i = 0; i < Z_EXTADDR_LEN; i++ )
+  {
+    hash = (uint16_t)((hash << 5) + hash) ^ extAddr[i];
+  }
+
+  if ( hash == ZDSECMGR_TCLK_IDX_EMPTY )
+  {
+    hash = 1;
+  }
+
+  return hash;
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxLoad
+ *
+ * @brief       Rebuild the TCLK RAM index from NV.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+static void ZDSecMgrTCLinkKeyIdxLoad( void )
+{
+  APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
+  uint16_t i;
+
+  TCLinkKeyIdxValid = TRUE;
+
+  for ( i = 0; i < gZDSECMGR_TC_DEVICE_MAX; i++ )
+  {
+    if ( osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, i, 0,
+                          sizeof(APSME_TCLinkKeyNVEntry_t),
+                          &TCLKDevEntry ) == SUCCESS )
+    {
+      TCLinkKeyIdx[i] = ZDSecMgrTCLinkKeyIdxHash( TCLKDevEntry.extAddr );
+    }
+    else
+    {
+      // Never offer an unreadable slot as free
+      TCLinkKeyIdx[i] = 1;
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeySearch
+ *
+ * @brief       Search the TCLK table for an extended address using the RAM
+ *              index. Same contract as APSME_SearchTCLinkKeyEntry(): the
+ *              candidate slot is read back from NV, and a stale index is
+ *              rebuilt once before giving up.
+ *
+ * @param       extAddr - [in] extended address to look for
+ * @param       found   - [out] TRUE if the entry exists
+ * @param       pEntry  - [out] NV entry read from the returned slot (may be NULL)
+ *
+ * @return      slot of the entry, first free slot if not found, or 0xFFFF
+ */
+uint16_t ZDSecMgrTCLinkKeySearch( uint8_t *extAddr, uint8_t *found,
+                                  APSME_TCLinkKeyNVEntry_t *pEntry )
+{
+  APSME_TCLinkKeyNVEntry_t TCLKDevEntry;
+  uint16_t hash;
+  uint16_t freeIdx;
+  uint16_t i;
+  uint8_t  pass;
+
+  *found = FALSE;
+
+  if ( pEntry == NULL )
+  {
+    pEntry = &TCLKDevEntry;
+  }
+
+  hash = ZDSecMgrTCLinkKeyIdxHash( extAddr );
+
+  for ( pass = 0; pass < 2; pass++ )
+  {
+    if ( TCLinkKeyIdxValid == FALSE )
+    {
+      ZDSecMgrTCLinkKeyIdxLoad();
+    }
+
+    freeIdx = 0xFFFF;
+
+    for ( i = 0; i < gZDSECMGR_TC_DEVICE_MAX; i++ )
+    {
+      if ( TCLinkKeyIdx[i] == ZDSECMGR_TCLK_IDX_EMPTY )
+      {
+        if ( freeIdx == 0xFFFF )
+        {
+          freeIdx = i;
+        }
+      }
+      else if ( TCLinkKeyIdx[i] == hash )
+      {
+        if ( osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, i, 0,
+                              sizeof(APSME_TCLinkKeyNVEntry_t),
+                              pEntry ) == SUCCESS )
+        {
+          if ( OsalPort_memcmp( pEntry->extAddr, extAddr, Z_EXTADDR_LEN ) )
+          {
+            *found = TRUE;
+            return ( i );
+          }
+
+          if ( ZDSecMgrTCLinkKeyIdxHash( pEntry->extAddr ) != hash )
+          {
+            // Slot changed behind the index
+            TCLinkKeyIdxValid = FALSE;
+            break;
+          }
+        }
+      }
+    }
+
+    if ( TCLinkKeyIdxValid == TRUE )
+    {
+      if ( freeIdx == 0xFFFF )
+      {
+        return ( 0xFFFF );
+      }
+
+      // Confirm the free slot has not been claimed behind the index
+      if ( ( osal_nv_read_ex( ZCD_NV_EX_TCLK_TABLE, freeIdx, 0,
+                              sizeof(APSME_TCLinkKeyNVEntry_t),
+                              pEntry ) == SUCCESS )
+        && OsalPort_isBufSet( pEntry->extAddr, 0x00, Z_EXTADDR_LEN ) )
+      {
+        return ( freeIdx );
+      }
+
+      TCLinkKeyIdxValid = FALSE;
+    }
+  }
+
+  return ( 0xFFFF );
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxSet
+ *
+ * @brief       Update the RAM index after the extended address of a TCLK
+ *              table slot has been written to NV.
+ *
+ * @param       index   - [in] TCLK table slot
+ * @param       extAddr - [in] extended address now stored in the slot
+ *
+ * @return      none
+ */
+void ZDSecMgrTCLinkKeyIdxSet( uint16_t index, uint8_t *extAddr )
+{
+  if ( index < gZDSECMGR_TC_DEVICE_MAX )
+  {
+    TCLinkKeyIdx[index] = ZDSecMgrTCLinkKeyIdxHash( extAddr );
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxReset
+ *
+ * @brief       Mark the TCLK RAM index stale so it is rebuilt from NV on the
+ *              next search.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+void ZDSecMgrTCLinkKeyIdxReset( void )
+{
+  TCLinkKeyIdxValid = FALSE;
+}
+
 
 /******************************************************************************
  * @fn          APSME_TCLinkKeySync
@@ -3157,16 +3376,16 @@ ZStatus_t APSME_TCLinkKeySync( uint16_t srcAddr, SSP_Info_t* si )
     APSME_LookupExtAddr( srcAddr, si->extAddr );
   }
 
-  entryIndex = APSME_SearchTCLinkKeyEntry(si->extAddr,&entryFound,&TCLKDevEntry);
+  entryIndex = ZDSecMgrTCLinkKeySearch(si->extAddr,&entryFound,&TCLKDevEntry);
 
 #if ZG_BUILD_JOINING_TYPE
   if(ZG_DEVICE_JOINING_TYPE && !entryFound)
   {
     uint8_t defaultEntry[Z_EXTADDR_LEN];
     memset(defaultEntry, 0, Z_EXTADDR_LEN);
-    entryIndex = APSME_SearchTCLinkKeyEntry(defaultEntry,&entryFound,&TCLKDevEntry);
+    entryIndex = ZDSecMgrTCLinkKeySearch(defaultEntry,&entryFound,&TCLKDevEntry);
 
-    // if previous call to APSME_SearchTCLinkKeyEntry() returned valid
+    // if previous call to ZDSecMgrTCLinkKeySearch() returned valid
     // entryIndex, we have an empty table entry index
     if(entryIndex != 0xFFFF)
     {
@@ -3293,7 +3512,7 @@ ZStatus_t APSME_TCLinkKeyLoad( uint16_t dstAddr, SSP_Info_t* si )
 
   if(extAddrFound)
   {
-    entryIndex = APSME_SearchTCLinkKeyEntry(si->extAddr,&found,&TCLKDevEntry);
+    entryIndex = ZDSecMgrTCLinkKeySearch(si->extAddr,&found,&TCLKDevEntry);
 
     if(entryIndex != 0xFFFF)
     {
@@ -3364,6 +3583,7 @@ ZStatus_t APSME_TCLinkKeyLoad( uint16_t dstAddr, SSP_Info_t* si )
         osal_nv_write_ex(ZCD_NV_EX_TCLK_TABLE, entryIndex,
                          sizeof(APSME_TCLinkKeyNVEntry_t),
                          &TCLKDevEntry);
+        ZDSecMgrTCLinkKeyIdxSet(entryIndex, TCLKDevEntry.extAddr);
 
         //Initialize framecounter
         memset(&TCLinkKeyRAMEntry[i],0,sizeof(APSME_TCLinkKeyRAMEntry_t));
@@ -3868,6 +4088,9 @@ void ZDSecMgrClearNVKeyValues(void)
 
   memset(&keyItems, 0x00, sizeof(nwkActiveKeyItems));
 
+  // Commit the cleared keys to Flash together
+  osal_nv_write_begin();
+
   osal_nv_write(ZCD_NV_NWKKEY, sizeof(nwkActiveKeyItems), &keyItems);
 
   // Initialize NV items for NWK Active and Alternate keys.
@@ -3877,6 +4100,8 @@ void ZDSecMgrClearNVKeyValues(void)
 
   osal_nv_write(ZCD_NV_NWK_ALTERN_KEY_INFO, sizeof(nwkKeyDesc), &nwkKey);
 
+  osal_nv_write_commit();
+
   _NIB.nwkKeyLoaded = FALSE;
 }
 #endif // defined ( NV_RESTORE )
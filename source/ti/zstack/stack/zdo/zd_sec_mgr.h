@@ -530,6 +530,46 @@ extern void ZDSecMgrFallbackNwkKey( void );
  */
 extern void ZDSecMgrUpdateTCAddress( uint8_t *extAddr );
 
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeySearch
+ *
+ * @brief       Search the TCLK table for an extended address using the RAM
+ *              index. Same contract as APSME_SearchTCLinkKeyEntry().
+ *
+ * @param       extAddr - [in] extended address to look for
+ * @param       found   - [out] TRUE if the entry exists
+ * @param       pEntry  - [out] NV entry read from the returned slot (may be NULL)
+ *
+ * @return      slot of the entry, first free slot if not found, or 0xFFFF
+ */
+extern uint16_t ZDSecMgrTCLinkKeySearch( uint8_t *extAddr, uint8_t *found,
+                                         APSME_TCLinkKeyNVEntry_t *pEntry );
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxSet
+ *
+ * @brief       Update the RAM index after the extended address of a TCLK
+ *              table slot has been written to NV.
+ *
+ * @param       index   - [in] TCLK table slot
+ * @param       extAddr - [in] extended address now stored in the slot
+ *
+ * @return      none
+ */
+extern void ZDSecMgrTCLinkKeyIdxSet( uint16_t index, uint8_t *extAddr );
+
+/******************************************************************************
+ * @fn          ZDSecMgrTCLinkKeyIdxReset
+ *
+ * @brief       Mark the TCLK RAM index stale so it is rebuilt from NV on the
+ *              next search. Used after library calls that write the table.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+extern void ZDSecMgrTCLinkKeyIdxReset( void );
+
 
 /******************************************************************************
 ******************************************************************************/